@@ -2,6 +2,7 @@ import protocol.native_protocol as proto
 import socket, json, argparse, selectors, sys, os
 import CursesUI
 import ProjectDescription
+import FileHasher
 
 def _receiveServerData(data, decoder_creator):
     decoder = decoder_creator(data)
@@ -14,6 +15,7 @@ def _make_argument_parser():
     parser.add_argument("executable_to_debug", type=str, help="The executable file that will be debugged remotely.")
     parser.add_argument("-s", "--server", type=str, help="Remote host of DebuggerBootstrap instance.")
     parser.add_argument("-p", "--port", type=int, help="Port of the remote DebuggerBootstrap instance.")
+    parser.add_argument("--hash-algorithm", default=FileHasher.DEFAULT_HASH_ALGORITHM, choices=FileHasher.available_hash_algorithms(), help="The algorithm used to hash the project files. Anything other than sha1 needs a server that supports it.")
     parser.add_argument("--no-interactive", default=False, action="store_true", help="The user will not be prompted to enter missing data. When data is missing the program will exit with a failure status.")
     return parser
 
@@ -134,7 +136,7 @@ if __name__ == "__main__":
         print("Given executable to debug: '{}' does not exist. Exiting...".format(args.executable_to_debug), file=sys.stderr)
         exit(1)
 
-    project_description = ProjectDescription.gather_recursively_from_current_dir(args.executable_to_debug)
+    project_description = ProjectDescription.gather_recursively_from_current_dir(args.executable_to_debug, file_hasher=ProjectDescription.DefaultProjectDescriptionFileHasher(args.hash_algorithm))
 
     if project_description is None:
         print("Unknown error gathering project description", file=sys.stderr)
@@ -1,12 +1,30 @@
 import hashlib
 import os
 
-def calculate_file_hash(file):
+try:
+    import xxhash
+except ImportError:
+    xxhash = None
+
+DEFAULT_HASH_ALGORITHM = "sha1"
+
+def available_hash_algorithms():
+    """The names of the algorithms that can be put in a project description's "hash_algorithm" """
+    if xxhash is None:
+        return ["sha1"]
+    return ["sha1", "xxh64"]
+
+def _new_hash(hash_algorithm):
+    if hash_algorithm == "xxh64":
+        return xxhash.xxh64()
+    return hashlib.sha1()
+
+def calculate_file_hash(file, hash_algorithm=DEFAULT_HASH_ALGORITHM):
     if not os.path.exists(file):
         return ""
 
-    read_amount = 512
-    hash = hashlib.sha1()
+    read_amount = 128 * 1024
+    hash = _new_hash(hash_algorithm)
     with open(file, 'rb') as file_handle:
         
         while True:
@@ -14,4 +32,4 @@ def calculate_file_hash(file):
             if(len(data)<=0):
                 break
             hash.update(data)
-    return hash.hexdigest()
\ No newline at end of file
+    return hash.hexdigest()
@@ -11,6 +11,10 @@ class ProjectDescriptionFileHasher(ABC):
         """Returns a string representing the hash for the file. None when there was an error."""
         pass
 
+    def hash_algorithm(self):
+        """The name of the algorithm used by calculate_hash_for_file, as it is put in the project description"""
+        return FileHasher.DEFAULT_HASH_ALGORITHM
+
 class ProjectDescriptionFileWalker(ABC):
     @abstractmethod
     def get_files_recursively_from_dir(self, predicate):
@@ -24,9 +28,19 @@ class ProjectDescriptionFileWalker(ABC):
     def file_exists(self, file):
         pass
 
+    def file_size(self, file):
+        """Returns the size of the file in bytes, None when it is unknown. The sizes are put in the project description."""
+        return None
+
 class DefaultProjectDescriptionFileHasher(ProjectDescriptionFileHasher):
+    def __init__(self, hash_algorithm=FileHasher.DEFAULT_HASH_ALGORITHM):
+        self._hash_algorithm = hash_algorithm
+
     def calculate_hash_for_file(self, file_path):
-        return FileHasher.calculate_file_hash(file_path)
+        return FileHasher.calculate_file_hash(file_path, self._hash_algorithm)
+
+    def hash_algorithm(self):
+        return self._hash_algorithm
 
 class DefaultProjectDescriptionFileWalker(ProjectDescriptionFileWalker):
     def get_files_recursively_from_dir(self, predicate):
@@ -40,6 +54,12 @@ class DefaultProjectDescriptionFileWalker(ProjectDescriptionFileWalker):
     def file_exists(self, file):
         return os.path.isfile(file)
 
+    def file_size(self, file):
+        try:
+            return os.path.getsize(file)
+        except OSError:
+            return None
+
 def _file_extension_matches(file_name, extensions):
     for extension in extensions:
         if fnmatch.fnmatch(file_name, extension):
@@ -75,9 +95,20 @@ def gather_recursively_from_current_dir(executable_file, shared_library_extensio
 
     project_description = {"executable_name": "/".join(executable_file_norm.split()), "executable_hash": executable_file_hash}
 
+    # Left out for SHA-1, that way older servers still understand the description
+    if file_hasher.hash_algorithm() != FileHasher.DEFAULT_HASH_ALGORITHM:
+        project_description["hash_algorithm"] = file_hasher.hash_algorithm()
+
     link_dependencies_for_executable_and_hashes = _find_link_dependencies_for_executable(shared_library_extensions, file_hasher, directory_walker)
 
     project_description["link_dependencies_for_executable"] = [file_and_hash[0] for file_and_hash in link_dependencies_for_executable_and_hashes]
     project_description["link_dependencies_for_executable_hashes"] = [file_and_hash[1] for file_and_hash in link_dependencies_for_executable_and_hashes]
 
+    # Lets the server skip hashing files whose size already differs, -1 is a size that is unknown
+    executable_file_size = directory_walker.file_size(executable_file_norm)
+    if executable_file_size is not None:
+        project_description["executable_size"] = executable_file_size
+        link_dependency_sizes = [directory_walker.file_size(file) for file in project_description["link_dependencies_for_executable"]]
+        project_description["link_dependencies_for_executable_sizes"] = [-1 if size is None else size for size in link_dependency_sizes]
+
     return project_description
\ No newline at end of file
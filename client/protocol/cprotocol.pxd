@@ -1,4 +1,4 @@
-from libc.stdint cimport uint8_t
+from libc.stdint cimport uint8_t, uint16_t
 from libc.stddef cimport size_t
 
 cdef extern from "Protocol.h":
@@ -11,11 +11,25 @@ cdef extern from "Protocol.h":
         DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE,
         DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_START,
         DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_STOP,
+        DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_BINARY_PROJECT_DESCRIPTION,
+        DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UPSERT_PROJECT_ENTRIES,
+        DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_REMOVE_PROJECT_ENTRIES,
+        DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SET_PROJECT_EXECUTABLE,
+        DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_RESYNC_REQUEST,
         DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE,
         DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN
 
     cdef size_t PACKET_HEADER_SIZE
+    cdef size_t PACKET_HEADER_SIZE_V1
 
+    ctypedef struct PacketFrame:
+        uint8_t version
+        uint16_t flags
+        size_t payload_offset
+        size_t payload_size
+        size_t packet_size
+
+    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacketFrame(const uint8_t* packet, size_t packet_size, PacketFrame* frame)
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacket(const uint8_t* packet, size_t packet_size, size_t* json_part_offset)
     void MakeRequestSubscriptionPacket(uint8_t** packet, size_t* packet_size)
     void MakeProjectDescriptionPacket(const char* proejct_description_json_string, uint8_t** packet, size_t* packet_size)
@@ -32,19 +32,14 @@ def make_force_stop_debugger_packet():
 
 def decode_packet(packet_data, message_decoder):
     cdef bytes c_packet_data = packet_data
-    cdef size_t json_offset
-    cdef cprotocol.DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE packet_type = cprotocol.DecodePacket(c_packet_data, len(packet_data), &json_offset)
-    cdef size_t null_terminator_position
-    
+    cdef cprotocol.PacketFrame frame
+    cdef cprotocol.DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE packet_type = cprotocol.DecodePacketFrame(c_packet_data, len(packet_data), &frame)
+
     if packet_type == cprotocol.DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE:
-        message_json_bytes = c_packet_data[json_offset:]
-        if cprotocol.FindNullTerminator(message_json_bytes, len(message_json_bytes), &null_terminator_position):
-            message_decoder.receive_subscription_response(null_terminator_position + 1 + cprotocol.PACKET_HEADER_SIZE, message_json_bytes[:null_terminator_position])
-        else:
-            message_decoder.receive_incomplete_response(packet_data[cprotocol.PACKET_HEADER_SIZE:])
+        # The payload ends with a '\0', which is not part of the message
+        message_json_bytes = c_packet_data[frame.payload_offset:frame.payload_offset + frame.payload_size - 1]
+        message_decoder.receive_subscription_response(frame.packet_size, message_json_bytes)
     elif packet_type == cprotocol.DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE:
         message_decoder.receive_incomplete_response(packet_data[cprotocol.PACKET_HEADER_SIZE:])
-    elif packet_type == cprotocol.DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN:
-        message_decoder.receive_unknown_response(packet_data[cprotocol.PACKET_HEADER_SIZE:])
     else:
         message_decoder.receive_unknown_response(packet_data[cprotocol.PACKET_HEADER_SIZE:])
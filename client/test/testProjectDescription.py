@@ -33,3 +33,20 @@ class TestProjectDescription(unittest.TestCase):
 
         created_description = ProjectDescription.gather_recursively_from_current_dir(os.path.join("release", "runme"), ProjectDescription.SHARED_LIBRARY_EXTENSIONS, given_hasher, given_file_walker)
         self.assertEqual({"executable_name": "release/runme", "executable_hash": "jkl", "link_dependencies_for_executable": ["lib.so", "deps/dep.so.4"], "link_dependencies_for_executable_hashes": ["abc", "ghi"]}, created_description)
+
+    def test_gather_with_hash_algorithm(self):
+        given_hasher = FakeProjectDescriptionFileHasher({"runme": "jkl"})
+        given_hasher.hash_algorithm = lambda: "xxh64"
+        given_file_walker = FakeProjectDescriptionFileWalker(["runme"])
+
+        created_description = ProjectDescription.gather_recursively_from_current_dir("runme", ProjectDescription.SHARED_LIBRARY_EXTENSIONS, given_hasher, given_file_walker)
+        self.assertEqual("xxh64", created_description["hash_algorithm"])
+
+    def test_gather_with_sizes(self):
+        given_hasher = FakeProjectDescriptionFileHasher({"runme": "jkl", "lib.so": "abc", "other.so": "def"})
+        given_file_walker = FakeProjectDescriptionFileWalker(["runme", "lib.so", "other.so"])
+        given_file_walker.file_size = lambda file: {"runme": 100, "lib.so": 20}.get(file)
+
+        created_description = ProjectDescription.gather_recursively_from_current_dir("runme", ProjectDescription.SHARED_LIBRARY_EXTENSIONS, given_hasher, given_file_walker)
+        self.assertEqual(100, created_description["executable_size"])
+        self.assertEqual([20, -1], created_description["link_dependencies_for_executable_sizes"])
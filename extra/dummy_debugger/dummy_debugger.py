@@ -2,8 +2,15 @@
 
 import sys, os, time
 
+# With --lines N, N lines are printed as fast as possible, each in its own write like a line buffered debugger,
+# after which the dummy debugger exits. This is used to measure how fast debugger output is broadcasted
+lines = None
+if len(sys.argv) > 2 and sys.argv[1] == "--lines":
+    lines = int(sys.argv[2])
+    del sys.argv[1:3]
+
 if len(sys.argv) < 2:
-    print("Usage: {} PROGRAM [ARGS...]".format(sys.argv[0]), file=sys.stderr)
+    print("Usage: {} [--lines N] PROGRAM [ARGS...]".format(sys.argv[0]), file=sys.stderr)
     exit(1)
 
 program = sys.argv[1]
@@ -14,6 +21,11 @@ if not os.path.isfile(program):
 
 print("Starting program {}...".format(program))
 
+if lines is not None:
+    for line in range(lines):
+        print("Program is running... line {}".format(line), flush=True)
+    exit(0)
+
 while True:
     time.sleep(1)
     print("Program is running...", end="", flush=True)
\ No newline at end of file
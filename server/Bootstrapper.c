@@ -4,23 +4,66 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "Digest.h"
 #include "DynamicStringArray.h"
+#include "PathIndex.h"
 #include "ProjectDescription.h"
 
+#define PROJECT_FILE_TABLE_INITIAL_CAPACITY 16
+
+// A file of the project description together with what is known about it on disk
+typedef struct {
+    const char* file;        // Owned by the project description
+    const char* wanted_hash; // As given in the project description, owned by the project description
+    Digest wanted_digest;    // Empty when the wanted hash is not hexadecimal, the file then never matches
+    long long wanted_size;   // -1 when the project description doesn't tell
+    Digest actual_digest;    // Empty while the file is missing, could not be hashed, or its hash is not known yet
+    int exists;
+    // The file has to be hashed, this is postponed while the start decision is known without its hash
+    int needs_hash;
+    // The hash was requested through requestHash but not received yet
+    int hash_pending;
+    // The file changed again after its hash was requested, the received hash is stale
+    int hash_outdated;
+    // The PROJECT_FILE_* flags the file is counted under in ProjectFileCounts
+    unsigned counted_as;
+} ProjectFile;
+
+#define PROJECT_FILE_MISSING 1u
+#define PROJECT_FILE_MISMATCHING 2u // Exists, and its known digest is not the wanted one
+#define PROJECT_FILE_UNDECIDED 4u   // Exists, but its digest is not known yet
+#define PROJECT_FILE_DEFERRED 8u
+#define PROJECT_FILE_PENDING 16u
+
+// Kept up to date whenever a file changes state, so that deciding whether to start doesn't visit every file
+typedef struct {
+    size_t missing, mismatching, undecided, deferred, pending;
+} ProjectFileCounts;
+
 typedef struct {
     int gdbIsRunning;
     ProjectDescription projectDescription;
 
-    DynamicStringArray existing, missing, hashesForExisting;
+    // One entry per distinct file of the project description, in the order of the project description
+    ProjectFile* files;
+    size_t files_size, files_capacity;
+    PathIndex files_index;
+    ProjectFileCounts counts;
+    size_t deferred_cursor; // Where HashDeferredFile continues looking
+    int recheck_skipped_files; // Set when RecheckProjectFiles only checked the known mismatches
 } BootstrapperInternal;
 
 void BootstrapperInit(Bootstrapper* bootstrapper) {
     BootstrapperInternal* internal = (BootstrapperInternal*)malloc(sizeof(BootstrapperInternal));
     internal->gdbIsRunning = 0;
+    internal->recheck_skipped_files = 0;
     ProjectDescriptionInit(&internal->projectDescription, "", "");
-    DynamicStringArrayInit(&internal->existing);
-    DynamicStringArrayInit(&internal->missing);
-    DynamicStringArrayInit(&internal->hashesForExisting);
+    internal->files_size = 0;
+    internal->files_capacity = PROJECT_FILE_TABLE_INITIAL_CAPACITY;
+    internal->files = (ProjectFile*)malloc(internal->files_capacity * sizeof(ProjectFile));
+    PathIndexInit(&internal->files_index);
+    memset(&internal->counts, 0, sizeof(internal->counts));
+    internal->deferred_cursor = 0;
     bootstrapper->_internal = internal;
 }
 
@@ -28,9 +71,8 @@ void BootstrapperDeinit(Bootstrapper* bootstrapper) {
     BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
     if (internal) {
         ProjectDescriptionDeinit(&internal->projectDescription);
-        DynamicStringArrayDeinit(&internal->existing);
-        DynamicStringArrayDeinit(&internal->missing);
-        DynamicStringArrayDeinit(&internal->hashesForExisting);
+        free(internal->files);
+        PathIndexDeinit(&internal->files_index);
 
         free(bootstrapper->_internal);
     }
@@ -44,72 +86,225 @@ ProjectDescription* GetProjectDescription(const Bootstrapper* bootstrapper) {
     return NULL;
 }
 
-static void FindFiles(Bootstrapper* bootstrapper, BootstrapperInternal* internal, DynamicStringArray* existing,
-                      DynamicStringArray* missing) {
-    DynamicStringArrayClear(existing);
-    DynamicStringArrayClear(missing);
-    if (bootstrapper->fileExists(internal->projectDescription.executable_name, bootstrapper->userdata))
-        DynamicStringArrayAppend(existing, internal->projectDescription.executable_name);
-    else
-        DynamicStringArrayAppend(missing, internal->projectDescription.executable_name);
-    for (size_t i = 0; i < internal->projectDescription.link_dependencies_for_executable.size; ++i) {
-        const char* link_dependency = internal->projectDescription.link_dependencies_for_executable.data[i];
-        if (bootstrapper->fileExists(link_dependency, bootstrapper->userdata))
-            DynamicStringArrayAppend(existing, link_dependency);
-        else
-            DynamicStringArrayAppend(missing, link_dependency);
-    }
+// Returns NULL when the file is not part of the project description
+static ProjectFile* FindProjectFile(const BootstrapperInternal* internal, const char* file) {
+    const size_t position = PathIndexFind(&internal->files_index, file);
+    return position == PATH_INDEX_NOT_FOUND ? NULL : &internal->files[position];
 }
 
-static void CalculateHashForHashArray(Bootstrapper* bootstrapper, const char* file, DynamicStringArray* hashes) {
-    char* hash;
-    size_t hash_size = 0;
-    bootstrapper->calculateHash(file, &hash, &hash_size, bootstrapper->userdata);
-    if (hash_size > 0) {
-        DynamicStringArrayAppend(hashes, hash);
-        free(hash);
-    }
+static unsigned ProjectFileFlags(const ProjectFile* project_file) {
+    unsigned flags = project_file->hash_pending ? PROJECT_FILE_PENDING : 0;
+    if (!project_file->exists)
+        return flags | PROJECT_FILE_MISSING;
+    if (project_file->needs_hash)
+        flags |= PROJECT_FILE_DEFERRED;
+    if (project_file->needs_hash || project_file->hash_pending)
+        return flags | PROJECT_FILE_UNDECIDED;
+    if (!DigestEqual(&project_file->actual_digest, &project_file->wanted_digest))
+        flags |= PROJECT_FILE_MISMATCHING;
+    return flags;
 }
 
-static void CalculateHashes(Bootstrapper* bootstrapper, BootstrapperInternal* internal, DynamicStringArray* hashes) {
-    DynamicStringArrayClear(hashes);
-    for (int i = 0; i < internal->existing.size; ++i) {
-        CalculateHashForHashArray(bootstrapper, internal->existing.data[i], hashes);
+// 'direction' is 1 or -1
+static void AddToCounts(ProjectFileCounts* counts, unsigned flags, int direction) {
+    if (flags & PROJECT_FILE_MISSING)
+        counts->missing += direction;
+    if (flags & PROJECT_FILE_MISMATCHING)
+        counts->mismatching += direction;
+    if (flags & PROJECT_FILE_UNDECIDED)
+        counts->undecided += direction;
+    if (flags & PROJECT_FILE_DEFERRED)
+        counts->deferred += direction;
+    if (flags & PROJECT_FILE_PENDING)
+        counts->pending += direction;
+}
+
+// Has to be called after every change to the state of a file
+static void Recount(BootstrapperInternal* internal, ProjectFile* project_file) {
+    AddToCounts(&internal->counts, project_file->counted_as, -1);
+    project_file->counted_as = ProjectFileFlags(project_file);
+    AddToCounts(&internal->counts, project_file->counted_as, 1);
+}
+
+// Compares the counts against a full recount, which visits every file on every start decision
+// Enabled by the tests through BOOTSTRAPPER_CHECK_COUNTS, independent of NDEBUG
+#ifdef BOOTSTRAPPER_CHECK_COUNTS
+static void CheckCounts(const BootstrapperInternal* internal) {
+    ProjectFileCounts counts;
+    memset(&counts, 0, sizeof(counts));
+    for (size_t i = 0; i < internal->files_size; ++i) {
+        if (internal->files[i].counted_as != ProjectFileFlags(&internal->files[i])) {
+            fprintf(stderr, "Bootstrapper: '%s' is counted in the wrong state\n", internal->files[i].file);
+            abort();
+        }
+        AddToCounts(&counts, ProjectFileFlags(&internal->files[i]), 1);
+    }
+    if (memcmp(&counts, &internal->counts, sizeof(counts)) != 0) {
+        fprintf(stderr, "Bootstrapper: the file counts don't match a recount\n");
+        abort();
     }
 }
+#else
+static void CheckCounts(const BootstrapperInternal* internal) {}
+#endif
+
+// A file that is listed more than once keeps the hash of its first listing
+static void AddProjectFile(BootstrapperInternal* internal, const char* file, const char* wanted_hash,
+                           long long wanted_size) {
+    if (FindProjectFile(internal, file))
+        return;
 
-static int FindExistingFile(const char* existing_file, const ProjectDescription* description, char** hash) {
-    if (strcmp(existing_file, description->executable_name) == 0) {
-        *hash = description->executable_hash;
-        return 1;
+    if (internal->files_size == internal->files_capacity) {
+        internal->files_capacity *= 2;
+        internal->files = (ProjectFile*)realloc(internal->files, internal->files_capacity * sizeof(ProjectFile));
     }
-    for (int i = 0; i < description->link_dependencies_for_executable.size; ++i) {
-        if (strcmp(existing_file, description->link_dependencies_for_executable.data[i]) == 0) {
-            *hash = description->link_dependencies_for_executable_hashes.data[i];
-            return 1;
-        }
+    PathIndexInsert(&internal->files_index, file, internal->files_size);
+    ProjectFile* project_file = &internal->files[internal->files_size++];
+    project_file->file = file;
+    project_file->wanted_hash = wanted_hash;
+    DigestFromHex(wanted_hash, &project_file->wanted_digest);
+    project_file->wanted_size = wanted_size;
+    DigestClear(&project_file->actual_digest);
+    project_file->exists = 0;
+    project_file->needs_hash = 0;
+    project_file->hash_pending = 0;
+    project_file->hash_outdated = 0;
+    project_file->counted_as = 0;
+    Recount(internal, project_file);
+}
+
+static void BuildProjectFiles(BootstrapperInternal* internal) {
+    internal->files_size = 0;
+    PathIndexClear(&internal->files_index);
+    memset(&internal->counts, 0, sizeof(internal->counts));
+    internal->deferred_cursor = 0;
+    const ProjectDescription* description = &internal->projectDescription;
+    const DynamicFileSizeArray* sizes = &description->link_dependencies_for_executable_sizes;
+    AddProjectFile(internal, description->executable_name, description->executable_hash,
+                   description->executable_size);
+    for (size_t i = 0; i < description->link_dependencies_for_executable.size; ++i)
+        AddProjectFile(internal, description->link_dependencies_for_executable.data[i],
+                       description->link_dependencies_for_executable_hashes.data[i],
+                       i < sizes->size ? sizes->data[i] : -1);
+}
+
+// Returns -1 when the size is unknown
+static long long ActualSize(Bootstrapper* bootstrapper, const ProjectFile* project_file) {
+    if (!bootstrapper->fileSize)
+        return -1;
+    return bootstrapper->fileSize(project_file->file, bootstrapper->userdata);
+}
+
+// Returns TRUE when the size shows that the file doesn't match, the file then doesn't need to be hashed anymore
+static int MarkSizeMismatch(BootstrapperInternal* internal, ProjectFile* project_file, long long actual_size) {
+    if (project_file->wanted_size < 0 || actual_size < 0 || actual_size == project_file->wanted_size)
+        return 0;
+    project_file->needs_hash = 0;
+    DigestClear(&project_file->actual_digest);
+    // A hash that is still being calculated is of content that is gone by now
+    if (project_file->hash_pending)
+        project_file->hash_outdated = 1;
+    Recount(internal, project_file);
+    return 1;
+}
+
+// Fills the actual digest of the file, it stays empty when the file could not be hashed, or when its hash will arrive
+// through ReceiveFileHash
+static void ObtainDigest(Bootstrapper* bootstrapper, BootstrapperInternal* internal, ProjectFile* project_file) {
+    project_file->needs_hash = 0;
+    DigestClear(&project_file->actual_digest);
+    if (!bootstrapper->requestHash) {
+        bootstrapper->calculateHash(project_file->file, &project_file->actual_digest, bootstrapper->userdata);
+    } else if (project_file->hash_pending) {
+        // The running calculation might have seen the old content, so the file is requested again once it completes
+        project_file->hash_outdated = 1;
+    } else if (!bootstrapper->requestHash(project_file->file, &project_file->actual_digest, bootstrapper->userdata)) {
+        project_file->hash_pending = 1;
     }
-    return 0;
+    Recount(internal, project_file);
+}
+
+// The file is hashed by HashUntilStartDecisionIsKnown
+static void MarkForHashing(Bootstrapper* bootstrapper, BootstrapperInternal* internal, ProjectFile* project_file) {
+    if (!bootstrapper->fileExists(project_file->file, bootstrapper->userdata))
+        return;
+    project_file->exists = 1;
+    project_file->needs_hash = 1;
+    DigestClear(&project_file->actual_digest);
+    Recount(internal, project_file);
 }
 
 static int ShouldStartGDBServer(BootstrapperInternal* internal) {
-    if (internal->missing.size > 0)
-        return 0;
+    CheckCounts(internal);
+    return internal->counts.missing == 0 && internal->counts.mismatching == 0 && internal->counts.undecided == 0;
+}
+
+// Returns TRUE when the file is known to keep the debugger from starting
+static int IsKnownMismatch(const ProjectFile* project_file) {
+    return (project_file->counted_as & (PROJECT_FILE_MISSING | PROJECT_FILE_MISMATCHING)) != 0;
+}
 
-    if (internal->existing.size > internal->hashesForExisting.size)
+static int StartIsRuledOut(const BootstrapperInternal* internal) {
+    return internal->counts.missing > 0 || internal->counts.mismatching > 0;
+}
+
+typedef struct {
+    ProjectFile* project_file;
+    long long size; // -1 when unknown
+} ScheduledFile;
+
+// Smallest first, files of unknown size last
+static int CompareScheduledFiles(const void* first, const void* second) {
+    const long long first_size = ((const ScheduledFile*)first)->size;
+    const long long second_size = ((const ScheduledFile*)second)->size;
+    if (first_size == second_size)
         return 0;
+    if (first_size < 0)
+        return 1;
+    if (second_size < 0)
+        return -1;
+    return first_size < second_size ? -1 : 1;
+}
 
-    for (int existingIndex = 0; existingIndex < internal->existing.size; ++existingIndex) {
-        const char* actual_hash = internal->hashesForExisting.data[existingIndex];
-        char* wanted_hash;
-        if (FindExistingFile(internal->existing.data[existingIndex], &internal->projectDescription, &wanted_hash)) {
-            if (strcmp(actual_hash, wanted_hash) != 0)
-                return 0;
-        } else {
-            return 0; // An existing file that doesn't exist in the project description, very strange
+// Hashes the files that need it, cheapest first, until it is known whether the debugger can start
+// Missing files and size mismatches decide without hashing anything, after that small files are hashed before large
+// ones. The files that are left stay marked, see HashDeferredFile. Once the start is ruled out, nothing is looked at.
+static void HashUntilStartDecisionIsKnown(Bootstrapper* bootstrapper, BootstrapperInternal* internal) {
+    if (internal->counts.deferred == 0 || StartIsRuledOut(internal))
+        return;
+    ScheduledFile* schedule = (ScheduledFile*)malloc(sizeof(ScheduledFile) * (internal->files_size + 1));
+    size_t schedule_size = 0;
+    for (size_t i = 0; i < internal->files_size; ++i) {
+        ProjectFile* project_file = &internal->files[i];
+        if (!project_file->exists || !project_file->needs_hash)
+            continue;
+        const long long size = ActualSize(bootstrapper, project_file);
+        if (!MarkSizeMismatch(internal, project_file, size)) {
+            schedule[schedule_size].project_file = project_file;
+            schedule[schedule_size].size = size;
+            ++schedule_size;
         }
     }
-    return 1;
+
+    if (!StartIsRuledOut(internal)) {
+        qsort(schedule, schedule_size, sizeof(ScheduledFile), &CompareScheduledFiles);
+        for (size_t i = 0; i < schedule_size; ++i) {
+            ObtainDigest(bootstrapper, internal, schedule[i].project_file);
+            if (IsKnownMismatch(schedule[i].project_file))
+                break;
+        }
+    }
+    free(schedule);
+}
+
+// The files that RecheckProjectFiles skipped might have changed unnoticed, they are checked before the debugger starts
+static void RecheckSkippedFilesBeforeStart(Bootstrapper* bootstrapper, BootstrapperInternal* internal) {
+    if (!internal->recheck_skipped_files || !ShouldStartGDBServer(internal))
+        return;
+    internal->recheck_skipped_files = 0;
+    for (size_t i = 0; i < internal->files_size; ++i)
+        MarkForHashing(bootstrapper, internal, &internal->files[i]);
+    HashUntilStartDecisionIsKnown(bootstrapper, internal);
 }
 
 static int ProjectIsLoaded(BootstrapperInternal* internal) {
@@ -137,20 +332,74 @@ static int Stop(Bootstrapper* bootstrapper, BootstrapperInternal* internal) {
     return 0;
 }
 
+// Takes over what is known about the files that were already part of the previous description, their state is kept
+// up to date by the file change notifications so they don't have to be checked again
+// Digests of another hash algorithm are useless, only the hashes that are still being calculated are remembered then
+static void CarryOverProjectFiles(Bootstrapper* bootstrapper, BootstrapperInternal* internal,
+                                  const ProjectFile* old_files, const PathIndex* old_files_index,
+                                  int digests_are_reusable) {
+    for (size_t i = 0; i < internal->files_size; ++i) {
+        ProjectFile* project_file = &internal->files[i];
+        const size_t old_position = PathIndexFind(old_files_index, project_file->file);
+        if (old_position != PATH_INDEX_NOT_FOUND && digests_are_reusable) {
+            const ProjectFile* old_file = &old_files[old_position];
+            project_file->actual_digest = old_file->actual_digest;
+            project_file->exists = old_file->exists;
+            project_file->needs_hash = old_file->needs_hash;
+            project_file->hash_pending = old_file->hash_pending;
+            project_file->hash_outdated = old_file->hash_outdated;
+            // A size mismatch of the previous description says nothing about the wanted size of this one
+            if (project_file->exists && !project_file->hash_pending && DigestIsEmpty(&project_file->actual_digest))
+                project_file->needs_hash = 1;
+        } else {
+            // Hashes that are still being calculated refer to files of the previous description
+            if (old_position != PATH_INDEX_NOT_FOUND)
+                project_file->hash_pending = old_files[old_position].hash_pending;
+            project_file->exists = bootstrapper->fileExists(project_file->file, bootstrapper->userdata);
+            project_file->needs_hash = project_file->exists;
+        }
+        Recount(internal, project_file);
+    }
+}
+
+static int SameDebuggee(const ProjectDescription* first, const ProjectDescription* second) {
+    return strcmp(first->executable_name, second->executable_name) == 0 &&
+           DynamicStringArrayEqual(&first->executable_arguments, &second->executable_arguments);
+}
+
 void ReceiveNewProjectDescription(Bootstrapper* bootstrapper, ProjectDescription* description) {
     BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
     if (!internal)
         return;
 
-    ProjectDescriptionDeinit(&internal->projectDescription);
-    ProjectDescriptionCopy(description, &internal->projectDescription);
-
-    Stop(bootstrapper, internal);
+    // Clients send the same description again every time they reconnect
+    if (!ProjectDescriptionEqual(description, &internal->projectDescription)) {
+        ProjectDescription old_description = internal->projectDescription;
+        ProjectFile* old_files = internal->files;
+        PathIndex old_files_index = internal->files_index;
+
+        ProjectDescriptionCopy(description, &internal->projectDescription);
+        internal->files = (ProjectFile*)malloc(internal->files_capacity * sizeof(ProjectFile));
+        PathIndexInit(&internal->files_index);
+        BuildProjectFiles(internal);
+        CarryOverProjectFiles(bootstrapper, internal, old_files, &old_files_index,
+                              old_description.hash_algorithm == description->hash_algorithm);
+
+        if (!SameDebuggee(&old_description, description))
+            Stop(bootstrapper, internal);
+        ProjectDescriptionDeinit(&old_description);
+        free(old_files);
+        PathIndexDeinit(&old_files_index);
+
+        HashUntilStartDecisionIsKnown(bootstrapper, internal);
+    }
 
-    FindFiles(bootstrapper, internal, &internal->existing, &internal->missing);
-    CalculateHashes(bootstrapper, internal, &internal->hashesForExisting);
+    RecheckSkippedFilesBeforeStart(bootstrapper, internal);
+    // A running debugger is left alone when it would be started again right away
     if (ShouldStartGDBServer(internal))
         Start(bootstrapper, internal);
+    else
+        Stop(bootstrapper, internal);
 }
 
 int IsProjectLoaded(const Bootstrapper* bootstrapper) {
@@ -174,8 +423,11 @@ void ReportMissingFiles(const Bootstrapper* bootstrapper, DynamicStringArray* mi
     if (!internal || !ProjectIsLoaded(internal))
         return;
 
-    DynamicStringArrayDeinit(missing_files);
-    DynamicStringArrayCopy(&internal->missing, missing_files);
+    DynamicStringArrayClear(missing_files);
+    for (size_t i = 0; i < internal->files_size; ++i) {
+        if (!internal->files[i].exists)
+            DynamicStringArrayAppend(missing_files, internal->files[i].file);
+    }
 }
 
 void ReportExistingFiles(const Bootstrapper* bootstrapper, DynamicStringArray* existing_files) {
@@ -190,16 +442,6 @@ void ReportExistingFiles(const Bootstrapper* bootstrapper, DynamicStringArray* e
     }
 }
 
-static int FindFile(const char* file, const DynamicStringArray* files, size_t* position) {
-    for (int i = 0; i < files->size; ++i) {
-        if (strcmp(file, files->data[i]) == 0) {
-            *position = i;
-            return 1;
-        }
-    }
-    return 0;
-}
-
 void ReportWantedVsActualHashes(const Bootstrapper* bootstrapper, DynamicStringArray* files,
                                 DynamicStringArray* actual_hashes, DynamicStringArray* wanted_hashes) {
 
@@ -211,52 +453,28 @@ void ReportWantedVsActualHashes(const Bootstrapper* bootstrapper, DynamicStringA
     if (!internal || !ProjectIsLoaded(internal))
         return;
 
-    DynamicStringArrayDeinit(files);
-    DynamicStringArrayCopy(&internal->existing, files);
-
-    for (int i = 0; i < files->size; ++i) {
-        size_t position;
-
-        if (strcmp(internal->projectDescription.executable_name, files->data[i]) == 0) {
-            DynamicStringArrayAppend(wanted_hashes, internal->projectDescription.executable_hash);
-            DynamicStringArrayAppend(actual_hashes, internal->projectDescription.executable_name);
-        }
-
-        if (FindFile(files->data[i], &internal->projectDescription.link_dependencies_for_executable, &position)) {
-            DynamicStringArrayAppend(
-                wanted_hashes, internal->projectDescription.link_dependencies_for_executable_hashes.data[position]);
-            DynamicStringArrayAppend(actual_hashes, internal->hashesForExisting.data[i]);
+    char actual_hash[DIGEST_HEX_BUFFER_SIZE], wanted_hash[DIGEST_HEX_BUFFER_SIZE];
+    for (size_t i = 0; i < internal->files_size; ++i) {
+        const ProjectFile* project_file = &internal->files[i];
+        if (!project_file->exists)
+            continue;
+        DigestToHex(&project_file->actual_digest, actual_hash);
+        DynamicStringArrayAppend(files, project_file->file);
+        DynamicStringArrayAppend(actual_hashes, actual_hash);
+        // Reported in the same lowercase form as the actual hash, unless it was not hexadecimal to begin with
+        if (DigestIsEmpty(&project_file->wanted_digest)) {
+            DynamicStringArrayAppend(wanted_hashes, project_file->wanted_hash);
+        } else {
+            DigestToHex(&project_file->wanted_digest, wanted_hash);
+            DynamicStringArrayAppend(wanted_hashes, wanted_hash);
         }
     }
-
-    DynamicStringArrayDeinit(actual_hashes);
-    DynamicStringArrayCopy(&internal->hashesForExisting, actual_hashes);
-
-    if (files->size != wanted_hashes->size || files->size != actual_hashes->size)
-        fprintf(stderr, "FIXME: %s:%d -- The three arrays should have the same size\n", __FILE__, __LINE__);
 }
 
-static void UpdateFileActualHashWithoutGDBStartCheck(Bootstrapper* bootstrapper, BootstrapperInternal* internal,
-                                                     const char* file_name) {
-    if (!bootstrapper->fileExists(file_name, bootstrapper->userdata))
-        return;
-
-    size_t find_index;
-    if (FindFile(file_name, &internal->missing, &find_index)) {
-        DynamicStringArrayErase(&internal->missing, find_index);
-        DynamicStringArrayAppend(&internal->existing, file_name);
-
-        char* hash;
-        size_t hash_size;
-        bootstrapper->calculateHash(file_name, &hash, &hash_size, bootstrapper->userdata);
-        DynamicStringArrayAppend(&internal->hashesForExisting, hash);
-        free(hash);
-    } else if (FindFile(file_name, &internal->existing, &find_index)) {
-        free(internal->hashesForExisting.data[find_index]);
-        size_t hash_size;
-        bootstrapper->calculateHash(file_name, &internal->hashesForExisting.data[find_index], &hash_size,
-                                    bootstrapper->userdata);
-    }
+static void MarkFileForHashing(Bootstrapper* bootstrapper, BootstrapperInternal* internal, const char* file_name) {
+    ProjectFile* project_file = FindProjectFile(internal, file_name);
+    if (project_file)
+        MarkForHashing(bootstrapper, internal, project_file);
 }
 
 void UpdateFileActualHash(Bootstrapper* bootstrapper, const char* file_name) {
@@ -264,7 +482,9 @@ void UpdateFileActualHash(Bootstrapper* bootstrapper, const char* file_name) {
     if (!internal || !ProjectIsLoaded(internal))
         return;
 
-    UpdateFileActualHashWithoutGDBStartCheck(bootstrapper, internal, file_name);
+    MarkFileForHashing(bootstrapper, internal, file_name);
+    HashUntilStartDecisionIsKnown(bootstrapper, internal);
+    RecheckSkippedFilesBeforeStart(bootstrapper, internal);
 
     if (ShouldStartGDBServer(internal))
         Start(bootstrapper, internal);
@@ -278,7 +498,33 @@ void UpdateFileActualHashes(Bootstrapper* bootstrapper, const DynamicStringArray
         return;
 
     for (int i = 0; i < file_names->size; ++i)
-        UpdateFileActualHashWithoutGDBStartCheck(bootstrapper, internal, file_names->data[i]);
+        MarkFileForHashing(bootstrapper, internal, file_names->data[i]);
+    HashUntilStartDecisionIsKnown(bootstrapper, internal);
+    RecheckSkippedFilesBeforeStart(bootstrapper, internal);
+
+    if (ShouldStartGDBServer(internal))
+        Start(bootstrapper, internal);
+    else
+        Stop(bootstrapper, internal);
+}
+
+void RecheckProjectFiles(Bootstrapper* bootstrapper) {
+    BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
+    if (!internal || !ProjectIsLoaded(internal))
+        return;
+
+    // Whatever changed in the other files, the debugger can't start before the missing and mismatching files match
+    const int only_known_mismatches = StartIsRuledOut(internal);
+    for (size_t i = 0; i < internal->files_size; ++i) {
+        ProjectFile* project_file = &internal->files[i];
+        if (only_known_mismatches && !IsKnownMismatch(project_file))
+            continue;
+        MarkForHashing(bootstrapper, internal, project_file);
+    }
+    if (only_known_mismatches)
+        internal->recheck_skipped_files = 1;
+    HashUntilStartDecisionIsKnown(bootstrapper, internal);
+    RecheckSkippedFilesBeforeStart(bootstrapper, internal);
 
     if (ShouldStartGDBServer(internal))
         Start(bootstrapper, internal);
@@ -294,15 +540,77 @@ void IndicateRemovedFile(Bootstrapper* bootstrapper, const char* file_name) {
     if (bootstrapper->fileExists(file_name, bootstrapper->userdata))
         return;
 
-    size_t find_index;
-    if (FindFile(file_name, &internal->missing, &find_index)) {
+    ProjectFile* project_file = FindProjectFile(internal, file_name);
+    if (!project_file || !project_file->exists)
+        return;
+    project_file->exists = 0;
+    project_file->needs_hash = 0;
+    DigestClear(&project_file->actual_digest);
+    Recount(internal, project_file);
+    Stop(bootstrapper, internal);
+}
+
+void ReceiveFileHash(Bootstrapper* bootstrapper, const char* file_name, const Digest* digest) {
+    BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
+    if (!internal)
         return;
-    } else if (FindFile(file_name, &internal->existing, &find_index)) {
-        DynamicStringArrayErase(&internal->existing, find_index);
 
-        DynamicStringArrayAppend(&internal->missing, file_name);
+    ProjectFile* project_file = FindProjectFile(internal, file_name);
+    if (!project_file || !project_file->hash_pending)
+        return;
+    project_file->hash_pending = 0;
+
+    // The file changed after its hash was requested, it is requested again
+    if (project_file->hash_outdated || project_file->needs_hash) {
+        project_file->hash_outdated = 0;
+        Recount(internal, project_file);
+        MarkFileForHashing(bootstrapper, internal, file_name);
+        HashUntilStartDecisionIsKnown(bootstrapper, internal);
+    } else {
+        if (project_file->exists)
+            project_file->actual_digest = *digest;
+        Recount(internal, project_file);
+    }
+
+    if (!ProjectIsLoaded(internal))
+        return;
+    RecheckSkippedFilesBeforeStart(bootstrapper, internal);
+    if (ShouldStartGDBServer(internal))
+        Start(bootstrapper, internal);
+    else
         Stop(bootstrapper, internal);
+}
+
+int HasPendingHashes(const Bootstrapper* bootstrapper) {
+    BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
+    if (!internal)
+        return 0;
+    return internal->counts.pending > 0;
+}
+
+int HasDeferredHashes(const Bootstrapper* bootstrapper) {
+    BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
+    if (!internal)
+        return 0;
+    return internal->counts.deferred > 0;
+}
+
+int HashDeferredFile(Bootstrapper* bootstrapper) {
+    BootstrapperInternal* internal = (BootstrapperInternal*)bootstrapper->_internal;
+    if (!internal || internal->counts.deferred == 0)
+        return 0;
+    // Continues after the previous deferred file, so that draining them all visits every file about once
+    for (size_t visited = 0; visited < internal->files_size; ++visited) {
+        const size_t i = (internal->deferred_cursor + visited) % internal->files_size;
+        ProjectFile* project_file = &internal->files[i];
+        if (!project_file->exists || !project_file->needs_hash)
+            continue;
+        internal->deferred_cursor = i + 1;
+        if (!MarkSizeMismatch(internal, project_file, ActualSize(bootstrapper, project_file)))
+            ObtainDigest(bootstrapper, internal, project_file);
+        return 1;
     }
+    return 0;
 }
 
 void IndicateDebuggerHasStopped(Bootstrapper* bootstrapper) {
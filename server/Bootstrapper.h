@@ -4,13 +4,22 @@
 
 typedef struct ProjectDescription ProjectDescription;
 typedef struct DynamicStringArray DynamicStringArray;
+typedef struct Digest Digest;
 
 typedef struct Bootstrapper {
     void* userdata;
     int (*startGDBServer)(void*, char* program_to_debug, const DynamicStringArray* executable_arguments);
     int (*stopGDBServer)(void*);
     int (*fileExists)(const char*, void*);
-    void (*calculateHash)(const char*, char**, size_t*, void*);
+    // Returns FALSE when the file could not be hashed, the digest is then empty
+    int (*calculateHash)(const char*, Digest*, void*);
+    // Optional, used instead of calculateHash when set
+    // Returns TRUE when the digest is filled right away, it is empty when the file could not be hashed
+    // Returns FALSE when the digest is calculated elsewhere, it should then be passed to ReceiveFileHash
+    int (*requestHash)(const char*, Digest*, void*);
+    // Optional, returns -1 when the size is unknown
+    // A file whose size differs from the size in the project description is not hashed, it can't match
+    long long (*fileSize)(const char*, void*);
 
     void* _internal;
 } Bootstrapper;
@@ -39,7 +48,22 @@ void UpdateFileActualHash(Bootstrapper*, const char* file_name);
 // Same as UpdateFileActualHash, except checking whether the GDBServer should start happens after all files have been
 // processed
 void UpdateFileActualHashes(Bootstrapper*, const DynamicStringArray* file_names);
+// Same as UpdateFileActualHashes with every existing file of the project description
+// While missing or mismatching files keep the GDBServer from starting, only those are checked again, the other files
+// are checked once the GDBServer could start
+void RecheckProjectFiles(Bootstrapper*);
 void IndicateRemovedFile(Bootstrapper*, const char* file_name);
+// Completes a digest that requestHash could not fill right away, it is empty when the file could not be hashed
+// Will trigger a StartGDBServer when every file exists and matches
+void ReceiveFileHash(Bootstrapper*, const char* file_name, const Digest*);
+// Returns TRUE while a hash requested through requestHash has not been received yet
+int HasPendingHashes(const Bootstrapper*);
+// Files are hashed only until it is known whether the GDBServer can start, the files that are left are deferred
+// Returns TRUE while deferred files are waiting to be hashed, their actual hashes are reported as ""
+int HasDeferredHashes(const Bootstrapper*);
+// Hashes (or requests the hash of) one deferred file, this can't start the GDBServer
+// Returns FALSE when no file was deferred
+int HashDeferredFile(Bootstrapper*);
 
 void IndicateDebuggerHasStopped(Bootstrapper*);
 
@@ -0,0 +1,152 @@
+#include "BroadcastFrame.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/uio.h>
+
+#include "PathIndex.h"
+
+BroadcastFrame* BroadcastFrameCreate(const char* subject, const uint8_t* header, size_t header_size,
+                                     const uint8_t* payload, size_t payload_size) {
+    const size_t subject_size = subject ? strlen(subject) + 1 : 0;
+    BroadcastFrame* frame =
+        (BroadcastFrame*)malloc(sizeof(BroadcastFrame) + header_size + payload_size + subject_size);
+    frame->references = 1;
+    frame->size = header_size + payload_size;
+    frame->data = (uint8_t*)(frame + 1);
+    frame->subject = subject ? (char*)frame->data + frame->size : NULL;
+    if (subject)
+        memcpy(frame->subject, subject, subject_size);
+    if (header_size > 0)
+        memcpy(frame->data, header, header_size);
+    if (payload_size > 0)
+        memcpy(frame->data + header_size, payload, payload_size);
+    return frame;
+}
+
+BroadcastFrame* BroadcastFrameRetain(BroadcastFrame* frame) {
+    ++frame->references;
+    return frame;
+}
+
+void BroadcastFrameRelease(BroadcastFrame* frame) {
+    if (--frame->references == 0)
+        free(frame);
+}
+
+void BroadcastFrameQueueInit(BroadcastFrameQueue* queue) {
+    queue->first = 0;
+    queue->size = 0;
+    queue->capacity = 4;
+    queue->frames = (BroadcastFrame**)malloc(queue->capacity * sizeof(BroadcastFrame*));
+    queue->sent = 0;
+    queue->bytes = 0;
+}
+
+static BroadcastFrame* FrameAt(const BroadcastFrameQueue* queue, size_t index) {
+    return queue->frames[(queue->first + index) % queue->capacity];
+}
+
+void BroadcastFrameQueueDeinit(BroadcastFrameQueue* queue) {
+    for (size_t i = 0; i < queue->size; ++i)
+        BroadcastFrameRelease(FrameAt(queue, i));
+    free(queue->frames);
+}
+
+// The ring is unrolled into the new allocation, so that it starts at index 0 again
+static void Extend(BroadcastFrameQueue* queue) {
+    const size_t capacity = queue->capacity * 2;
+    BroadcastFrame** frames = (BroadcastFrame**)malloc(capacity * sizeof(BroadcastFrame*));
+    for (size_t i = 0; i < queue->size; ++i)
+        frames[i] = FrameAt(queue, i);
+    free(queue->frames);
+    queue->frames = frames;
+    queue->first = 0;
+    queue->capacity = capacity;
+}
+
+void BroadcastFrameQueuePush(BroadcastFrameQueue* queue, BroadcastFrame* frame) {
+    // It would never be consumed, as nothing is ever sent of it
+    if (frame->size == 0)
+        return;
+    if (queue->size == queue->capacity)
+        Extend(queue);
+    queue->frames[(queue->first + queue->size) % queue->capacity] = BroadcastFrameRetain(frame);
+    ++queue->size;
+    queue->bytes += frame->size;
+}
+
+size_t BroadcastFrameQueueGather(const BroadcastFrameQueue* queue, struct iovec* iov, size_t max_iov) {
+    size_t count = 0;
+    for (; count < queue->size && count < max_iov; ++count) {
+        const BroadcastFrame* frame = FrameAt(queue, count);
+        const size_t skipped = count == 0 ? queue->sent : 0;
+        iov[count].iov_base = frame->data + skipped;
+        iov[count].iov_len = frame->size - skipped;
+    }
+    return count;
+}
+
+void BroadcastFrameQueueConsume(BroadcastFrameQueue* queue, size_t sent_bytes) {
+    queue->bytes -= sent_bytes;
+    while (sent_bytes > 0 && queue->size > 0) {
+        BroadcastFrame* frame = FrameAt(queue, 0);
+        const size_t left = frame->size - queue->sent;
+        if (sent_bytes < left) {
+            queue->sent += sent_bytes;
+            return;
+        }
+        sent_bytes -= left;
+        queue->sent = 0;
+        queue->first = (queue->first + 1) % queue->capacity;
+        --queue->size;
+        BroadcastFrameRelease(frame);
+    }
+}
+
+// Keeps the frames that are marked in 'keep', in their order
+static size_t RemoveUnmarked(BroadcastFrameQueue* queue, const char* keep) {
+    BroadcastFrame** frames = (BroadcastFrame**)malloc(queue->capacity * sizeof(BroadcastFrame*));
+    size_t kept = 0, removed_bytes = 0;
+    for (size_t i = 0; i < queue->size; ++i) {
+        BroadcastFrame* frame = FrameAt(queue, i);
+        if (keep[i] || (i == 0 && queue->sent > 0)) {
+            frames[kept++] = frame;
+        } else {
+            removed_bytes += frame->size;
+            BroadcastFrameRelease(frame);
+        }
+    }
+    free(queue->frames);
+    queue->frames = frames;
+    queue->first = 0;
+    queue->size = kept;
+    queue->bytes -= removed_bytes;
+    return removed_bytes;
+}
+
+size_t BroadcastFrameQueueCoalesce(BroadcastFrameQueue* queue) {
+    char* keep = (char*)malloc(queue->size > 0 ? queue->size : 1);
+    PathIndex subjects;
+    PathIndexInit(&subjects);
+    // From the back, so the first frame of a subject that is found is the latest one
+    for (size_t i = queue->size; i-- > 0;) {
+        const char* subject = FrameAt(queue, i)->subject;
+        keep[i] = !subject || PathIndexFind(&subjects, subject) == PATH_INDEX_NOT_FOUND;
+        if (subject && keep[i])
+            PathIndexInsert(&subjects, subject, i);
+    }
+    PathIndexDeinit(&subjects);
+    const size_t removed_bytes = RemoveUnmarked(queue, keep);
+    free(keep);
+    return removed_bytes;
+}
+
+size_t BroadcastFrameQueueDropOutput(BroadcastFrameQueue* queue) {
+    char* keep = (char*)malloc(queue->size > 0 ? queue->size : 1);
+    for (size_t i = 0; i < queue->size; ++i)
+        keep[i] = FrameAt(queue, i)->subject != NULL;
+    const size_t removed_bytes = RemoveUnmarked(queue, keep);
+    free(keep);
+    return removed_bytes;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+struct iovec;
+
+// An encoded packet that is never changed once created, so every subscriber it is sent to can share it
+// It is freed when its last reference is released
+typedef struct BroadcastFrame {
+    size_t references;
+    // Frames with the same subject describe the same state, only the latest one is needed by a subscriber that fell
+    // behind. NULL for debugger output, which is dropped instead. Allocated along with the frame
+    char* subject;
+    size_t size;
+    uint8_t* data; // Allocated along with the frame
+} BroadcastFrame;
+
+// The frame starts out with one reference, for the caller
+BroadcastFrame* BroadcastFrameCreate(const char* subject, const uint8_t* header, size_t header_size,
+                                     const uint8_t* payload, size_t payload_size);
+BroadcastFrame* BroadcastFrameRetain(BroadcastFrame*);
+void BroadcastFrameRelease(BroadcastFrame*);
+
+// The frames a handle still has to send, in order
+typedef struct BroadcastFrameQueue {
+    BroadcastFrame** frames; // A ring of 'capacity' frames, starting at 'first'
+    size_t first, size, capacity;
+    size_t sent; // Of the first frame
+    size_t bytes; // That are not sent yet, of all frames together
+} BroadcastFrameQueue;
+
+void BroadcastFrameQueueInit(BroadcastFrameQueue*);
+// Releases the frames that were not sent
+void BroadcastFrameQueueDeinit(BroadcastFrameQueue*);
+
+// The queue takes a reference of its own
+void BroadcastFrameQueuePush(BroadcastFrameQueue*, BroadcastFrame*);
+
+// Points 'iov' at the bytes that are not sent yet, for writev, returns the amount of iovecs that were used
+size_t BroadcastFrameQueueGather(const BroadcastFrameQueue*, struct iovec* iov, size_t max_iov);
+// Frames that are sent completely are released
+void BroadcastFrameQueueConsume(BroadcastFrameQueue*, size_t sent_bytes);
+
+// A frame that is partially sent is never removed, the rest of it has to follow
+// Only the latest frame of every subject is kept, returns the amount of bytes that were removed
+size_t BroadcastFrameQueueCoalesce(BroadcastFrameQueue*);
+// Removes the frames without a subject, returns the amount of bytes that were removed
+size_t BroadcastFrameQueueDropOutput(BroadcastFrameQueue*);
@@ -0,0 +1,48 @@
+#include "Digest.h"
+
+#include <string.h>
+
+void DigestClear(Digest* digest) { digest->size = 0; }
+
+int DigestIsEmpty(const Digest* digest) { return digest->size == 0; }
+
+int DigestEqual(const Digest* first, const Digest* second) {
+    return first->size > 0 && first->size == second->size && memcmp(first->bytes, second->bytes, first->size) == 0;
+}
+
+// Returns -1 for characters that are not hexadecimal
+static int HexValue(char character) {
+    if (character >= '0' && character <= '9')
+        return character - '0';
+    if (character >= 'a' && character <= 'f')
+        return character - 'a' + 10;
+    if (character >= 'A' && character <= 'F')
+        return character - 'A' + 10;
+    return -1;
+}
+
+int DigestFromHex(const char* hex, Digest* digest) {
+    DigestClear(digest);
+    const size_t hex_length = strlen(hex);
+    if (hex_length == 0 || hex_length % 2 != 0 || hex_length > DIGEST_MAX_SIZE * 2)
+        return 0;
+
+    for (size_t i = 0; i < hex_length / 2; ++i) {
+        const int high = HexValue(hex[i * 2]);
+        const int low = HexValue(hex[i * 2 + 1]);
+        if (high < 0 || low < 0)
+            return 0;
+        digest->bytes[i] = (unsigned char)(high << 4 | low);
+    }
+    digest->size = (unsigned char)(hex_length / 2);
+    return 1;
+}
+
+void DigestToHex(const Digest* digest, char* hex) {
+    static const char hex_characters[] = "0123456789abcdef";
+    for (size_t i = 0; i < digest->size; ++i) {
+        hex[i * 2] = hex_characters[digest->bytes[i] >> 4];
+        hex[i * 2 + 1] = hex_characters[digest->bytes[i] & 0xf];
+    }
+    hex[digest->size * 2] = '\0';
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include <stddef.h>
+
+// SHA-1 is the largest digest that is supported
+#define DIGEST_MAX_SIZE 20
+// Enough room for the hexadecimal representation of any digest, including the null terminator
+#define DIGEST_HEX_BUFFER_SIZE (DIGEST_MAX_SIZE * 2 + 1)
+
+// A hash value, stored inline so that it never needs to be allocated
+// An empty digest (size 0) is used for a hash that is not known
+typedef struct Digest {
+    unsigned char size;
+    unsigned char bytes[DIGEST_MAX_SIZE];
+} Digest;
+
+void DigestClear(Digest*);
+int DigestIsEmpty(const Digest*);
+// Returns TRUE when both digests have the same size and bytes, empty digests are never equal
+int DigestEqual(const Digest*, const Digest*);
+
+// Returns FALSE when 'hex' is not a hexadecimal string of a size that fits a Digest, the digest is then empty
+int DigestFromHex(const char* hex, Digest*);
+// Writes lowercase hexadecimal characters and a null terminator, 'hex' should have room for DIGEST_HEX_BUFFER_SIZE
+// characters. An empty digest results in "".
+void DigestToHex(const Digest*, char* hex);
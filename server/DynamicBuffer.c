@@ -8,33 +8,55 @@
 void DynamicBufferInit(DynamicBuffer* buffer) {
     buffer->size = 0;
     buffer->capacity = DYNAMIC_BUFFER_INITIAL_SIZE;
-    buffer->data = (char*)malloc(DYNAMIC_BUFFER_INITIAL_SIZE);
+    buffer->_allocation = (char*)malloc(DYNAMIC_BUFFER_INITIAL_SIZE);
+    buffer->data = buffer->_allocation;
 }
 
-void DynamicBufferDeinit(DynamicBuffer* buffer) { free(buffer->data); }
+void DynamicBufferDeinit(DynamicBuffer* buffer) { free(buffer->_allocation); }
 
-void _dynamicBufferExtend(DynamicBuffer* buffer, size_t minimal_new_size) {
+static size_t TrimmedSize(const DynamicBuffer* buffer) { return buffer->data - buffer->_allocation; }
+
+static size_t TailRoom(const DynamicBuffer* buffer) { return buffer->capacity - TrimmedSize(buffer) - buffer->size; }
+
+// Moving the data costs at most as much as the trimming that preceded it, so trimming stays O(1) amortized
+static void Compact(DynamicBuffer* buffer) {
+    memmove(buffer->_allocation, buffer->data, buffer->size);
+    buffer->data = buffer->_allocation;
+}
+
+static void _dynamicBufferExtend(DynamicBuffer* buffer, size_t minimal_new_size) {
     const size_t new_size = minimal_new_size * 2;
-    buffer->data = (char*)realloc(buffer->data, new_size);
+    const size_t trimmed_size = TrimmedSize(buffer);
+    buffer->_allocation = (char*)realloc(buffer->_allocation, new_size);
+    buffer->data = buffer->_allocation + trimmed_size;
     buffer->capacity = new_size;
 }
 
-void DynamicBufferAppend(DynamicBuffer* buffer, const char* new_data, size_t new_data_size) {
-    if (buffer->size + new_data_size >= buffer->capacity)
-        _dynamicBufferExtend(buffer, buffer->size + new_data_size);
+char* DynamicBufferReserve(DynamicBuffer* buffer, size_t amount) {
+    if (TailRoom(buffer) < amount && TrimmedSize(buffer) >= buffer->size)
+        Compact(buffer);
+    if (TailRoom(buffer) < amount) {
+        // Growing copies every byte anyway, so the trimmed bytes are dropped rather than carried over
+        Compact(buffer);
+        _dynamicBufferExtend(buffer, buffer->size + amount);
+    }
+    return buffer->data + buffer->size;
+}
+
+void DynamicBufferCommit(DynamicBuffer* buffer, size_t amount) { buffer->size += amount; }
 
-    memcpy(buffer->data + buffer->size, new_data, new_data_size);
-    buffer->size += new_data_size;
+void DynamicBufferAppend(DynamicBuffer* buffer, const char* new_data, size_t new_data_size) {
+    memcpy(DynamicBufferReserve(buffer, new_data_size), new_data, new_data_size);
+    DynamicBufferCommit(buffer, new_data_size);
 }
 
 void DynamicBufferTrimLeft(DynamicBuffer* buffer, size_t trim_amount) {
-    if (trim_amount == buffer->size) {
+    if (trim_amount >= buffer->size) {
         buffer->size = 0;
+        buffer->data = buffer->_allocation;
         return;
     }
 
-    const size_t remainder = buffer->size - trim_amount;
-    for (size_t i = 0; i < remainder; ++i)
-        buffer->data[i] = buffer->data[i + trim_amount];
+    buffer->data += trim_amount;
     buffer->size -= trim_amount;
-}
\ No newline at end of file
+}
@@ -2,10 +2,14 @@
 
 #include <stddef.h>
 
+// 'data' points at the bytes that were not trimmed yet, trimming only moves it forward
+// The bytes are moved back to the start of the allocation once the trimmed bytes outnumber them, when room is needed
 typedef struct DynamicBuffer {
     char* data;
     size_t size;
-    size_t capacity;
+    size_t capacity; // Of the whole allocation, including the bytes that were trimmed
+
+    char* _allocation;
 } DynamicBuffer;
 
 void DynamicBufferInit(DynamicBuffer* buffer);
@@ -13,3 +17,8 @@ void DynamicBufferDeinit(DynamicBuffer* buffer);
 
 void DynamicBufferAppend(DynamicBuffer* buffer, const char* new_data, size_t new_data_size);
 void DynamicBufferTrimLeft(DynamicBuffer* buffer, size_t trim_amount);
+
+// Returns room for at least 'amount' bytes after the data, for reading into the buffer directly
+// The bytes only become part of the data with DynamicBufferCommit, other calls invalidate the returned pointer
+char* DynamicBufferReserve(DynamicBuffer* buffer, size_t amount);
+void DynamicBufferCommit(DynamicBuffer* buffer, size_t amount);
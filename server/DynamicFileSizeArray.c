@@ -0,0 +1,35 @@
+#include "DynamicFileSizeArray.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#define DYNAMIC_FILE_SIZE_ARRAY_INITIAL_CAPACITY 16
+
+void DynamicFileSizeArrayInit(DynamicFileSizeArray* size_array) {
+    size_array->size = 0;
+    size_array->capacity = DYNAMIC_FILE_SIZE_ARRAY_INITIAL_CAPACITY;
+    size_array->data = (long long*)malloc(DYNAMIC_FILE_SIZE_ARRAY_INITIAL_CAPACITY * sizeof(long long));
+}
+
+void DynamicFileSizeArrayCopy(const DynamicFileSizeArray* source, DynamicFileSizeArray* destination) {
+    destination->size = source->size;
+    destination->capacity = source->capacity;
+    destination->data = (long long*)malloc(source->capacity * sizeof(long long));
+    memcpy(destination->data, source->data, source->size * sizeof(long long));
+}
+
+void DynamicFileSizeArrayDeinit(DynamicFileSizeArray* size_array) { free(size_array->data); }
+
+void DynamicFileSizeArrayAppend(DynamicFileSizeArray* size_array, long long item) {
+    if (size_array->size == size_array->capacity) {
+        size_array->capacity *= 2;
+        size_array->data = (long long*)realloc(size_array->data, size_array->capacity * sizeof(long long));
+    }
+    size_array->data[size_array->size++] = item;
+}
+
+void DynamicFileSizeArrayClear(DynamicFileSizeArray* size_array) { size_array->size = 0; }
+
+int DynamicFileSizeArrayEqual(const DynamicFileSizeArray* first, const DynamicFileSizeArray* second) {
+    return first->size == second->size && memcmp(first->data, second->data, first->size * sizeof(long long)) == 0;
+}
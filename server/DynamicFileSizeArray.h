@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stddef.h>
+
+typedef struct DynamicFileSizeArray {
+    long long* data;
+    size_t size;
+    size_t capacity;
+} DynamicFileSizeArray;
+
+void DynamicFileSizeArrayInit(DynamicFileSizeArray* size_array);
+void DynamicFileSizeArrayCopy(const DynamicFileSizeArray* source, DynamicFileSizeArray* destination);
+void DynamicFileSizeArrayDeinit(DynamicFileSizeArray* size_array);
+
+void DynamicFileSizeArrayAppend(DynamicFileSizeArray* size_array, long long item);
+void DynamicFileSizeArrayClear(DynamicFileSizeArray*);
+
+int DynamicFileSizeArrayEqual(const DynamicFileSizeArray*, const DynamicFileSizeArray*);
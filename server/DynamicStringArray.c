@@ -5,55 +5,209 @@
 #include <string.h>
 
 #define DYNAMIC_STRING_ARRAY_INITIAL_CAPACITY 16
+#define DYNAMIC_STRING_ARENA_INITIAL_CAPACITY 256
+
+struct DynamicStringArena {
+    size_t references; // Arrays that share the arena, none of them may append to it while there is more than one
+    size_t size, capacity;
+    char bytes[];
+};
+
+static DynamicStringArena* NewArena(size_t capacity) {
+    DynamicStringArena* arena = (DynamicStringArena*)malloc(sizeof(DynamicStringArena) + capacity);
+    arena->references = 1;
+    arena->size = 0;
+    arena->capacity = capacity;
+    return arena;
+}
+
+static void ReleaseArena(DynamicStringArena* arena) {
+    if (arena && --arena->references == 0)
+        free(arena);
+}
+
+// Returns TRUE when the arena holds exactly the strings of the array, so that it can be copied as a whole
+static int ArenaIsDense(const DynamicStringArray* string_array) {
+    return string_array->_arena && string_array->_erased_arena_bytes == 0;
+}
+
+static size_t StringBytes(const DynamicStringArray* string_array) {
+    if (ArenaIsDense(string_array))
+        return string_array->_arena->size;
+    size_t bytes = 0;
+    for (size_t i = 0; i < string_array->size; ++i)
+        bytes += strlen(string_array->data[i]) + 1;
+    return bytes;
+}
+
+static void ReservePointers(DynamicStringArray* string_array, size_t count) {
+    if (count <= string_array->capacity)
+        return;
+    string_array->capacity *= 2;
+    if (string_array->capacity < count)
+        string_array->capacity = count;
+    string_array->data = (char**)realloc(string_array->data, string_array->capacity * sizeof(char*));
+}
+
+// Copies the strings of 'source' to the end of the arena of 'string_array', which must have room for them
+static void CopyStrings(DynamicStringArray* string_array, const DynamicStringArray* source, size_t bytes) {
+    DynamicStringArena* arena = string_array->_arena;
+    char** destination = &string_array->data[string_array->size];
+    if (ArenaIsDense(source)) {
+        const char* source_bytes = source->_arena->bytes;
+        char* destination_bytes = &arena->bytes[arena->size];
+        memcpy(destination_bytes, source_bytes, bytes);
+        for (size_t i = 0; i < source->size; ++i)
+            destination[i] = destination_bytes + (source->data[i] - source_bytes);
+        arena->size += bytes;
+        return;
+    }
+    for (size_t i = 0; i < source->size; ++i) {
+        // 'destination' and 'source->data' are the same pointers when an array is moved to a new arena
+        const char* item = source->data[i];
+        const size_t item_bytes = strlen(item) + 1;
+        destination[i] = &arena->bytes[arena->size];
+        memcpy(destination[i], item, item_bytes);
+        arena->size += item_bytes;
+    }
+}
+
+// Makes sure the array has an arena of its own with room for 'extra' more bytes
+// Returns the arena that was replaced, it has to be released once nothing is copied from it anymore
+static DynamicStringArena* ReserveBytes(DynamicStringArray* string_array, size_t extra) {
+    DynamicStringArena* previous_arena = string_array->_arena;
+    if (previous_arena && previous_arena->references == 1 && previous_arena->size + extra <= previous_arena->capacity)
+        return NULL;
+
+    // The strings that were erased are left behind
+    const DynamicStringArray previous_strings = *string_array;
+    const size_t bytes = StringBytes(&previous_strings);
+    size_t capacity = (bytes + extra) * 2;
+    if (capacity < DYNAMIC_STRING_ARENA_INITIAL_CAPACITY)
+        capacity = DYNAMIC_STRING_ARENA_INITIAL_CAPACITY;
+    string_array->_arena = NewArena(capacity);
+    string_array->_erased_arena_bytes = 0;
+    string_array->size = 0;
+    CopyStrings(string_array, &previous_strings, bytes);
+    string_array->size = previous_strings.size;
+    return previous_arena;
+}
 
 void DynamicStringArrayInit(DynamicStringArray* string_array) {
     string_array->size = 0;
     string_array->capacity = DYNAMIC_STRING_ARRAY_INITIAL_CAPACITY;
     string_array->data = (char**)malloc(DYNAMIC_STRING_ARRAY_INITIAL_CAPACITY * sizeof(char*));
+    string_array->_arena = NULL;
+    string_array->_erased_arena_bytes = 0;
 }
 
+// A single copy of the pointers and a single copy of the arena, when nothing was erased from the source
 void DynamicStringArrayCopy(const DynamicStringArray* source, DynamicStringArray* destination) {
+    destination->size = 0;
+    destination->capacity = source->capacity;
+    destination->data = (char**)malloc(source->capacity * sizeof(char*));
+    destination->_arena = NULL;
+    destination->_erased_arena_bytes = 0;
+    DynamicStringArrayAppendArray(destination, source);
+}
+
+void DynamicStringArrayShare(const DynamicStringArray* source, DynamicStringArray* destination) {
     destination->size = source->size;
     destination->capacity = source->capacity;
     destination->data = (char**)malloc(source->capacity * sizeof(char*));
-    for (int i = 0; i < destination->size; ++i) {
-        const size_t item_length = strlen(source->data[i]);
-        destination->data[i] = (char*)malloc(item_length + 1);
-        memcpy(destination->data[i], source->data[i], item_length + 1);
-    }
+    memcpy(destination->data, source->data, source->size * sizeof(char*));
+    destination->_arena = source->_arena;
+    destination->_erased_arena_bytes = source->_erased_arena_bytes;
+    if (destination->_arena)
+        ++destination->_arena->references;
 }
 
 void DynamicStringArrayDeinit(DynamicStringArray* string_array) {
-    DynamicStringArrayClear(string_array);
+    ReleaseArena(string_array->_arena);
+    string_array->_arena = NULL;
     free(string_array->data);
 }
 
-static void _extend(DynamicStringArray* string_array) {
-    string_array->capacity *= 2;
-    string_array->data = (char**)realloc(string_array->data, string_array->capacity * sizeof(char*));
-}
-
 void DynamicStringArrayAppend(DynamicStringArray* string_array, const char* item) {
-    if (string_array->size == string_array->capacity)
-        _extend(string_array);
-    const size_t item_length = strlen(item);
-    string_array->data[string_array->size] = (char*)malloc(item_length + 1);
-    strncpy(string_array->data[string_array->size], item, item_length + 1);
+    ReservePointers(string_array, string_array->size + 1);
+    const size_t item_bytes = strlen(item) + 1;
+    // 'item' might be in the replaced arena, so that is released after copying
+    DynamicStringArena* previous_arena = ReserveBytes(string_array, item_bytes);
+    DynamicStringArena* arena = string_array->_arena;
+    string_array->data[string_array->size] = &arena->bytes[arena->size];
+    memcpy(&arena->bytes[arena->size], item, item_bytes);
+    arena->size += item_bytes;
     ++string_array->size;
+    ReleaseArena(previous_arena);
+}
+
+void DynamicStringArrayAppendArray(DynamicStringArray* string_array, const DynamicStringArray* items) {
+    if (items->size == 0)
+        return;
+    const size_t count = items->size;
+    const size_t bytes = StringBytes(items);
+    ReservePointers(string_array, string_array->size + count);
+    // When appending to itself, the strings are copied from the new arena
+    DynamicStringArena* previous_arena = ReserveBytes(string_array, bytes);
+    CopyStrings(string_array, items, bytes);
+    string_array->size += count;
+    ReleaseArena(previous_arena);
+}
+
+void DynamicStringArrayReplace(DynamicStringArray* string_array, size_t at, const char* item) {
+    if (at >= string_array->size)
+        return;
+
+    const size_t item_bytes = strlen(item) + 1;
+    // 'item' might be in the replaced arena, so that is released after copying
+    DynamicStringArena* previous_arena = ReserveBytes(string_array, item_bytes);
+    DynamicStringArena* arena = string_array->_arena;
+    char* replacement = &arena->bytes[arena->size];
+    memcpy(replacement, item, item_bytes);
+    arena->size += item_bytes;
+    string_array->_erased_arena_bytes += strlen(string_array->data[at]) + 1;
+    string_array->data[at] = replacement;
+    ReleaseArena(previous_arena);
 }
 
 void DynamicStringArrayErase(DynamicStringArray* string_array, size_t at) {
     if (at < 0 || at >= string_array->size)
         return;
 
-    free(string_array->data[at]);
-    for (int i = at + 1; i < string_array->size; ++i)
-        string_array->data[i - 1] = string_array->data[i];
+    string_array->_erased_arena_bytes += strlen(string_array->data[at]) + 1;
+    memmove(&string_array->data[at], &string_array->data[at + 1], (string_array->size - at - 1) * sizeof(char*));
+    --string_array->size;
+}
+
+void DynamicStringArrayEraseUnordered(DynamicStringArray* string_array, size_t at) {
+    if (at >= string_array->size)
+        return;
+
+    string_array->_erased_arena_bytes += strlen(string_array->data[at]) + 1;
+    string_array->data[at] = string_array->data[string_array->size - 1];
     --string_array->size;
 }
 
 void DynamicStringArrayClear(DynamicStringArray* string_array) {
-    for (int i = 0; i < string_array->size; ++i)
-        free(string_array->data[i]);
     string_array->size = 0;
-}
\ No newline at end of file
+    string_array->_erased_arena_bytes = 0;
+    if (!string_array->_arena)
+        return;
+    // An arena of its own is reused, so refilling a cleared array doesn't allocate
+    if (string_array->_arena->references == 1) {
+        string_array->_arena->size = 0;
+        return;
+    }
+    ReleaseArena(string_array->_arena);
+    string_array->_arena = NULL;
+}
+
+int DynamicStringArrayEqual(const DynamicStringArray* first, const DynamicStringArray* second) {
+    if (first->size != second->size)
+        return 0;
+
+    for (int i = 0; i < first->size; ++i)
+        if (strcmp(first->data[i], second->data[i]) != 0)
+            return 0;
+    return 1;
+}
@@ -2,16 +2,36 @@
 
 #include <stddef.h>
 
+typedef struct DynamicStringArena DynamicStringArena;
+
+// The strings are stored back to back in a single arena, 'data' points into it
+// Unlike when every string had an allocation of its own, the array owns the strings and 'data' is read-only:
+// - a string must not be freed, modified or replaced through 'data', use DynamicStringArrayReplace instead
+// - the pointers in 'data' move when strings are appended or replaced, and they are invalid after a Clear
 typedef struct DynamicStringArray {
     char** data;
     size_t size;
     size_t capacity;
+
+    DynamicStringArena* _arena;  // NULL until the first string is appended, might be shared with other arrays
+    size_t _erased_arena_bytes; // Bytes of the arena that belong to strings this array no longer has
 } DynamicStringArray;
 
 void DynamicStringArrayInit(DynamicStringArray* string_array);
 void DynamicStringArrayCopy(const DynamicStringArray* source, DynamicStringArray* destination);
+// Like DynamicStringArrayCopy, but the strings are only copied once either array appends to them (copy on write)
+// Arrays that share strings must be used from the same thread
+void DynamicStringArrayShare(const DynamicStringArray* source, DynamicStringArray* destination);
 void DynamicStringArrayDeinit(DynamicStringArray* string_array);
 
 void DynamicStringArrayAppend(DynamicStringArray* string_array, const char* item);
+// Appends every string of 'items' with a single allocation at most
+void DynamicStringArrayAppendArray(DynamicStringArray* string_array, const DynamicStringArray* items);
+// 'item' may be a string of the array itself
+void DynamicStringArrayReplace(DynamicStringArray* string_array, size_t at, const char* item);
 void DynamicStringArrayErase(DynamicStringArray* string_array, size_t at);
+// Moves the last string to 'at' instead of shifting every string after it
+void DynamicStringArrayEraseUnordered(DynamicStringArray* string_array, size_t at);
 void DynamicStringArrayClear(DynamicStringArray*);
+
+int DynamicStringArrayEqual(const DynamicStringArray*, const DynamicStringArray*);
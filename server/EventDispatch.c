@@ -1,3 +1,5 @@
+// For accept4
+#define _GNU_SOURCE
 #include "EventDispatch.h"
 
 #include <errno.h>
@@ -10,119 +12,281 @@
 
 #include <arpa/inet.h>
 #include <fcntl.h>
-#include <poll.h>
 #include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <time.h>
 
 #include "Bootstrapper.h"
+#include "BroadcastFrame.h"
 #include "DynamicBuffer.h"
+#include "EventPoller.h"
+#include "FileChangeSettler.h"
 #include "FileHasher.h"
 #include "GDBServerStartStop.h"
+#include "HashCache.h"
+#include "HashIndex.h"
+#include "HashWorkerPool.h"
+#include "OutputBatcher.h"
 #include "ProjectDescription.h"
+#include "ProjectDescriptionDelta.h"
+#include "ProjectDescription_binary.h"
 #include "ProjectDescription_json.h"
 #include "ProjectFileDifferences.h"
+#include "ProjectFileWatcher.h"
 #include "SubscriberUpdate.h"
 #include "protocol/Protocol.h"
 
-#define CLIENT_MESSAGE_READ_BUFFER_SIZE 128
+// Every handle starts reading with the minimal read size, it doubles while reads fill it completely
+#define MINIMAL_READ_SIZE 4096
+#define MAXIMAL_READ_SIZE (256 * 1024)
+// A handle that keeps having data stops being read after this many bytes, so the other handles are not starved
+#define MAXIMAL_READ_PER_WAKEUP (4 * 1024 * 1024)
+// Frames that are handed to a single sendmsg, more are sent by the next call
+#define MAXIMAL_FRAMES_PER_WRITE 64
+#define DEFAULT_FILE_SETTLE_TIME_MS 200
+#define DEFAULT_SUBSCRIBER_BUDGET_BYTES (4 * 1024 * 1024)
+#define DEFAULT_SUBSCRIBER_BUDGET_FRAMES 4096
+#define DEFAULT_DEBUGGER_OUTPUT_BATCH_SIZE (64 * 1024)
+#define DEFAULT_DEBUGGER_OUTPUT_DELAY_MS 5
+#define POLL_TIMEOUT_MS 1000
 
 enum HandleType {
+    HANDLE_TYPE_FREE, // A slot of the polling handles without a handle
     HANDLE_TYPE_SERVER_SOCKET,
     HANDLE_TYPE_CLIENT_SOCKET,
     HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION, // This client socket will recieve status updates as well
     HANDLE_TYPE_DEBUGGER_STDOUT,
-    HANDLE_TYPE_DEBUGGER_STDERR
+    HANDLE_TYPE_DEBUGGER_STDERR,
+    HANDLE_TYPE_FILESYSTEM_WATCHER,
+    HANDLE_TYPE_HASH_COMPLETION // Becomes readable when the hash workers completed a file
 };
 
 typedef struct {
     GDBInstance gdbserver_instance;
+    HashCache hash_cache;
+    HashAlgorithm hash_algorithm; // The algorithm of the hash cache's digests
+    HashIndex hash_index;
+    HashWorkerPool hash_worker_pool;
 } BoundBootstrapperParameters;
 
+// What the subscribers are sent at the end of a loop iteration
+typedef struct {
+    DynamicStringArray messages; // Encoded subscriber updates
+    // One per message, see the subject of BroadcastFrame, an empty subject is debugger output
+    DynamicStringArray subjects;
+} SubscriberBroadcast;
+
+static void SubscriberBroadcastInit(SubscriberBroadcast* broadcast) {
+    DynamicStringArrayInit(&broadcast->messages);
+    DynamicStringArrayInit(&broadcast->subjects);
+}
+
+static void SubscriberBroadcastDeinit(SubscriberBroadcast* broadcast) {
+    DynamicStringArrayDeinit(&broadcast->messages);
+    DynamicStringArrayDeinit(&broadcast->subjects);
+}
+
+static void SubscriberBroadcastClear(SubscriberBroadcast* broadcast) {
+    DynamicStringArrayClear(&broadcast->messages);
+    DynamicStringArrayClear(&broadcast->subjects);
+}
+
+// A JSON project description is parsed while it arrives, its bytes are dropped from the reading buffer once parsed
 typedef struct {
-    struct pollfd* pfds;
-    enum HandleType* types;
+    int active; // TRUE from the header of the packet until its last byte
+    size_t payload_left; // PACKET_PAYLOAD_SIZE_UNKNOWN for version 1 packets, which end at their '\0'
+    ProjectDescriptionJSONStream json_stream;
+} StreamedProjectDescription;
+
+// The handles are kept in slots, a slot keeps its index while its handle exists and is reused once the handle is erased
+// An event names the slot and its generation, so events of an erased handle are never taken for its successor
+typedef struct {
+    int* fds;
+    enum HandleType* types;        // HANDLE_TYPE_FREE for a slot without a handle
+    uint32_t* generations;         // Increased whenever the handle of the slot is erased
+    int* watched_events;           // The EVENT_POLLER flags the handle is watched for
     DynamicBuffer* reading_buffers;
-    DynamicBuffer* writing_buffers;
-    size_t size, capacity;
+    BroadcastFrameQueue* writing_queues;
+    size_t* dropped_output_bytes; // Of the debugger output a subscriber fell too far behind on, in total
+    size_t* read_sizes; // The amount of bytes the next read of the handle asks for
+    uint8_t* protocol_versions; // Of the packets a subscriber gets, the version its subscribe request had
+    StreamedProjectDescription* streamed_descriptions;
+    size_t* free_slots; // A stack of the free slots below 'slot_count'
+    size_t free_slot_count;
+    size_t size;       // The amount of handles
+    size_t slot_count; // Slots at or above this have never been used
+    size_t capacity;
+    EventPoller poller;
+    // A handle with more than this waiting to be sent has fallen behind, see EnforceWritingBudget
+    size_t writing_budget_bytes, writing_budget_frames;
+    SubscriberOverflowPolicy overflow_policy;
+    int debugger_pid; // Of the debugger whose handles are watched, NO_PID when they are not
 } PollingHandles;
 
-static void Init(PollingHandles* handles) {
+static void Init(PollingHandles* handles, const EventDispatchOptions* options) {
     handles->size = 0;
+    handles->slot_count = 0;
+    handles->free_slot_count = 0;
     handles->capacity = 1;
-    handles->pfds = (struct pollfd*)calloc(sizeof(struct pollfd), handles->capacity);
-    handles->types = (enum HandleType*)calloc(sizeof(enum HandleType), handles->capacity);
+    handles->debugger_pid = NO_PID;
+    handles->writing_budget_bytes = options->subscriber_budget_bytes;
+    handles->writing_budget_frames = options->subscriber_budget_frames;
+    handles->overflow_policy = options->subscriber_overflow_policy;
+    handles->fds = (int*)malloc(sizeof(int) * handles->capacity);
+    handles->types = (enum HandleType*)malloc(sizeof(enum HandleType) * handles->capacity);
+    handles->generations = (uint32_t*)malloc(sizeof(uint32_t) * handles->capacity);
+    handles->watched_events = (int*)malloc(sizeof(int) * handles->capacity);
     handles->reading_buffers = (DynamicBuffer*)malloc(sizeof(DynamicBuffer) * handles->capacity);
-    handles->writing_buffers = (DynamicBuffer*)malloc(sizeof(DynamicBuffer) * handles->capacity);
+    handles->writing_queues = (BroadcastFrameQueue*)malloc(sizeof(BroadcastFrameQueue) * handles->capacity);
+    handles->dropped_output_bytes = (size_t*)malloc(sizeof(size_t) * handles->capacity);
+    handles->read_sizes = (size_t*)malloc(sizeof(size_t) * handles->capacity);
+    handles->protocol_versions = (uint8_t*)malloc(sizeof(uint8_t) * handles->capacity);
+    handles->streamed_descriptions =
+        (StreamedProjectDescription*)malloc(sizeof(StreamedProjectDescription) * handles->capacity);
+    handles->free_slots = (size_t*)malloc(sizeof(size_t) * handles->capacity);
+    EventPollerInit(&handles->poller, options->use_poll ? EVENT_POLLER_BACKEND_POLL : EVENT_POLLER_BACKEND_EPOLL);
 }
 
-static void FreeDynamicBufferArray(DynamicBuffer* dynamic_buffers, size_t n) {
-    for (size_t i = 0; i < n; ++i)
-        DynamicBufferDeinit(&dynamic_buffers[i]);
-    free(dynamic_buffers);
+static void DeinitStreamedProjectDescription(StreamedProjectDescription* streamed_description) {
+    if (streamed_description->active)
+        ProjectDescriptionJSONStreamDeinit(&streamed_description->json_stream);
+    streamed_description->active = 0;
 }
 
 static void Deinit(PollingHandles* handles) {
-    free(handles->pfds);
+    for (size_t i = 0; i < handles->slot_count; ++i) {
+        if (handles->types[i] == HANDLE_TYPE_FREE)
+            continue;
+        DynamicBufferDeinit(&handles->reading_buffers[i]);
+        BroadcastFrameQueueDeinit(&handles->writing_queues[i]);
+        DeinitStreamedProjectDescription(&handles->streamed_descriptions[i]);
+    }
+    EventPollerDeinit(&handles->poller);
+    free(handles->fds);
     free(handles->types);
-    FreeDynamicBufferArray(handles->reading_buffers, handles->capacity);
-    FreeDynamicBufferArray(handles->writing_buffers, handles->capacity);
+    free(handles->generations);
+    free(handles->watched_events);
+    free(handles->reading_buffers);
+    free(handles->writing_queues);
+    free(handles->dropped_output_bytes);
+    free(handles->read_sizes);
+    free(handles->protocol_versions);
+    free(handles->streamed_descriptions);
+    free(handles->free_slots);
 }
 
 static void _extend(PollingHandles* handles) {
     handles->capacity *= 2;
-    handles->pfds = realloc(handles->pfds, handles->capacity * sizeof(struct pollfd));
+    handles->fds = realloc(handles->fds, handles->capacity * sizeof(int));
     handles->types = realloc(handles->types, handles->capacity * sizeof(enum HandleType));
-    memset(handles->pfds + handles->size, 0, handles->size * sizeof(struct pollfd));
-    memset(handles->types + handles->size, 0, handles->size * sizeof(enum HandleType));
+    handles->generations = realloc(handles->generations, handles->capacity * sizeof(uint32_t));
+    handles->watched_events = realloc(handles->watched_events, handles->capacity * sizeof(int));
     handles->reading_buffers = realloc(handles->reading_buffers, handles->capacity * sizeof(DynamicBuffer));
-    handles->writing_buffers = realloc(handles->writing_buffers, handles->capacity * sizeof(DynamicBuffer));
+    handles->writing_queues = realloc(handles->writing_queues, handles->capacity * sizeof(BroadcastFrameQueue));
+    handles->dropped_output_bytes = realloc(handles->dropped_output_bytes, handles->capacity * sizeof(size_t));
+    handles->read_sizes = realloc(handles->read_sizes, handles->capacity * sizeof(size_t));
+    handles->protocol_versions = realloc(handles->protocol_versions, handles->capacity * sizeof(uint8_t));
+    handles->streamed_descriptions =
+        realloc(handles->streamed_descriptions, handles->capacity * sizeof(StreamedProjectDescription));
+    handles->free_slots = realloc(handles->free_slots, handles->capacity * sizeof(size_t));
+}
+
+static uint64_t EventIdOfSlot(const PollingHandles* handles, size_t slot) {
+    return (uint64_t)handles->generations[slot] << 32 | (uint64_t)slot;
+}
+
+// Returns FALSE when the handle of the event was erased in the meantime
+static int SlotOfEventId(const PollingHandles* handles, uint64_t id, size_t* slot) {
+    *slot = (size_t)(id & 0xffffffffu);
+    return *slot < handles->slot_count && handles->types[*slot] != HANDLE_TYPE_FREE &&
+           handles->generations[*slot] == (uint32_t)(id >> 32);
 }
 
-static void Append(PollingHandles* handles, int fd, short events, enum HandleType type) {
-    if (handles->size == handles->capacity)
-        _extend(handles);
+// Returns the slot of the handle, which stays the same until the handle is erased
+static size_t Append(PollingHandles* handles, int fd, int events, enum HandleType type) {
+    size_t slot;
+    if (handles->free_slot_count > 0) {
+        slot = handles->free_slots[--handles->free_slot_count];
+    } else {
+        if (handles->slot_count == handles->capacity)
+            _extend(handles);
+        slot = handles->slot_count++;
+        handles->generations[slot] = 0;
+    }
 
-    handles->pfds[handles->size].fd = fd;
-    handles->pfds[handles->size].events = events;
-    handles->types[handles->size] = type;
-    DynamicBufferInit(&handles->reading_buffers[handles->size]);
-    DynamicBufferInit(&handles->writing_buffers[handles->size]);
+    handles->fds[slot] = fd;
+    handles->types[slot] = type;
+    handles->watched_events[slot] = events;
+    DynamicBufferInit(&handles->reading_buffers[slot]);
+    BroadcastFrameQueueInit(&handles->writing_queues[slot]);
+    handles->dropped_output_bytes[slot] = 0;
+    handles->read_sizes[slot] = MINIMAL_READ_SIZE;
+    handles->protocol_versions[slot] = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION;
+    handles->streamed_descriptions[slot].active = 0;
     ++handles->size;
+    EventPollerAdd(&handles->poller, fd, EventIdOfSlot(handles, slot), events);
+    return slot;
 }
 
+// The fd is not closed, but it is no longer watched, so it can be closed afterwards
 static void Erase(PollingHandles* handles, size_t at) {
-    if (at < 0 || at >= handles->size)
+    if (at >= handles->slot_count || handles->types[at] == HANDLE_TYPE_FREE)
         return;
+    EventPollerRemove(&handles->poller, handles->fds[at]);
     DynamicBufferDeinit(&handles->reading_buffers[at]);
-    DynamicBufferDeinit(&handles->writing_buffers[at]);
-    for (size_t i = at + 1; i < handles->size; ++i) {
-        handles->pfds[i - 1] = handles->pfds[i];
-        handles->types[i - 1] = handles->types[i];
-        handles->reading_buffers[i - 1] = handles->reading_buffers[i];
-        handles->writing_buffers[i - 1] = handles->writing_buffers[i];
-    }
+    BroadcastFrameQueueDeinit(&handles->writing_queues[at]);
+    DeinitStreamedProjectDescription(&handles->streamed_descriptions[at]);
+    handles->types[at] = HANDLE_TYPE_FREE;
+    ++handles->generations[at];
+    handles->free_slots[handles->free_slot_count++] = at;
     --handles->size;
 }
 
-static void AddClientSocket(int socket_desc, PollingHandles* all_handles) {
-    socklen_t c = sizeof(struct sockaddr_in);
-    struct sockaddr_in client;
+// A handle is only watched for writability while it has something to write, otherwise it would always be ready
+static void SyncWriteInterest(PollingHandles* handles, size_t at) {
+    const int events = handles->writing_queues[at].size > 0
+                           ? handles->watched_events[at] | EVENT_POLLER_WRITABLE
+                           : handles->watched_events[at] & ~EVENT_POLLER_WRITABLE;
+    if (events == handles->watched_events[at])
+        return;
+    handles->watched_events[at] = events;
+    EventPollerModify(&handles->poller, handles->fds[at], EventIdOfSlot(handles, at), events);
+}
 
-    int client_sock = accept(socket_desc, (struct sockaddr*)&client, &c);
-    if (client_sock < 0) {
-        fprintf(stderr, "accept failed\n");
-        exit(1);
-    }
+// Returns TRUE when the queued frames of the handle exceed either the byte or the frame budget of a subscriber
+static int IsOverWritingBudget(const PollingHandles* handles, size_t at) {
+    return handles->writing_queues[at].bytes > handles->writing_budget_bytes ||
+           handles->writing_queues[at].size > handles->writing_budget_frames;
+}
 
-    printf("Connection accepted\n");
+// Accepts every pending connection, so a burst of clients doesn't take a loop iteration per client
+// The client sockets are non-blocking and are not inherited by the debugger
+static void AddClientSockets(int socket_desc, PollingHandles* all_handles) {
+    while (1) {
+        socklen_t c = sizeof(struct sockaddr_in);
+        struct sockaddr_in client;
+
+        errno = 0;
+        const int client_sock = accept4(socket_desc, (struct sockaddr*)&client, &c, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (client_sock < 0) {
+            // The connection was reset while it was pending, the next one might be fine
+            if (errno == EINTR || errno == ECONNABORTED)
+                continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+                fprintf(stderr, "accept failed: %s\n", strerror(errno));
+            return;
+        }
 
-    Append(all_handles, client_sock, POLLIN, HANDLE_TYPE_CLIENT_SOCKET);
+        printf("Connection accepted\n");
 
-    fcntl(client_sock, F_SETFL, fcntl(client_sock, F_GETFL, 0) | O_NONBLOCK);
+        Append(all_handles, client_sock, EVENT_POLLER_READABLE, HANDLE_TYPE_CLIENT_SOCKET);
+    }
 }
 
 static void AddDebuggerHandlesToPollingHandles(PollingHandles* all_handles, int debugger_stdout, int debugger_stderr) {
-    Append(all_handles, debugger_stdout, POLLIN, HANDLE_TYPE_DEBUGGER_STDOUT);
-    Append(all_handles, debugger_stderr, POLLIN, HANDLE_TYPE_DEBUGGER_STDERR);
+    Append(all_handles, debugger_stdout, EVENT_POLLER_READABLE, HANDLE_TYPE_DEBUGGER_STDOUT);
+    Append(all_handles, debugger_stderr, EVENT_POLLER_READABLE, HANDLE_TYPE_DEBUGGER_STDERR);
 
     fcntl(debugger_stdout, F_SETFL, fcntl(debugger_stdout, F_GETFL, 0) | O_NONBLOCK);
     fcntl(debugger_stderr, F_SETFL, fcntl(debugger_stderr, F_GETFL, 0) | O_NONBLOCK);
@@ -137,7 +301,7 @@ static void AddDebuggerHandlesToPollingHandlesIfRunning(PollingHandles* all_hand
     if (userdata->gdbserver_instance.pid == NO_PID)
         return;
 
-    for (int fd_index = 0; fd_index < all_handles->size; ++fd_index) {
+    for (size_t fd_index = 0; fd_index < all_handles->slot_count; ++fd_index) {
         if (all_handles->types[fd_index] == HANDLE_TYPE_DEBUGGER_STDOUT ||
             all_handles->types[fd_index] == HANDLE_TYPE_DEBUGGER_STDERR) {
             fprintf(stderr,
@@ -147,22 +311,23 @@ static void AddDebuggerHandlesToPollingHandlesIfRunning(PollingHandles* all_hand
     }
     AddDebuggerHandlesToPollingHandles(all_handles, userdata->gdbserver_instance.stdout_handle,
                                        userdata->gdbserver_instance.stderr_handle);
+    all_handles->debugger_pid = userdata->gdbserver_instance.pid;
 }
 
-// When not found, returns all_handles->size
-static int FindFirstItemWithType(PollingHandles* all_handles, enum HandleType handle_type) {
-    for (int fd_index = 0; fd_index < all_handles->size; ++fd_index) {
+// When not found, returns all_handles->slot_count
+static size_t FindFirstItemWithType(PollingHandles* all_handles, enum HandleType handle_type) {
+    for (size_t fd_index = 0; fd_index < all_handles->slot_count; ++fd_index) {
         if (all_handles->types[fd_index] == handle_type)
             return fd_index;
     }
 
-    return all_handles->size;
+    return all_handles->slot_count;
 }
 
 static void ExpectPresentAndErase(PollingHandles* all_handles, enum HandleType type,
                                   const char* message_when_not_present) {
-    const int stdout_index = FindFirstItemWithType(all_handles, type);
-    if (stdout_index == all_handles->size)
+    const size_t stdout_index = FindFirstItemWithType(all_handles, type);
+    if (stdout_index == all_handles->slot_count)
         fprintf(stderr, "%s", message_when_not_present);
     else
         Erase(all_handles, stdout_index);
@@ -173,6 +338,7 @@ static void ExpectAndEraseDebuggerHandles(PollingHandles* all_handles) {
                           "FIXME: The debugger is running, but its stdout handle is not present\n");
     ExpectPresentAndErase(all_handles, HANDLE_TYPE_DEBUGGER_STDERR,
                           "FIXME: The debugger is running, but its stderr handle is not present\n");
+    all_handles->debugger_pid = NO_PID;
 }
 
 static void RemoveDebuggerHandlesFromPollingHandlesIfNotRunning(PollingHandles* all_handles,
@@ -187,79 +353,270 @@ static void RemoveDebuggerHandlesFromPollingHandlesIfNotRunning(PollingHandles*
     ExpectAndEraseDebuggerHandles(all_handles);
 }
 
-// Returns True when data was successfully interpreted
-static int InterpretProjectDescriptionClientData(DynamicBuffer* reading_buffer, Bootstrapper* bootstrapper,
-                                                 size_t json_offset) {
-    if (json_offset > reading_buffer->size)
-        return 0;
-    size_t null_terminator_index;
-    if (FindNullTerminator((uint8_t*)&reading_buffer->data[json_offset], reading_buffer->size - json_offset,
-                           &null_terminator_index)) {
-        null_terminator_index += json_offset;
-
-        ProjectDescription description;
-        if (ProjectDescriptionLoadFromJSON(&reading_buffer->data[json_offset], &description)) {
-            printf("I got a valid project description!\n");
-            DynamicBufferTrimLeft(reading_buffer, null_terminator_index + 1);
-            ReceiveNewProjectDescription(bootstrapper, &description);
-
-            ProjectDescriptionDeinit(&description);
-            return 1;
-        }
-    }
-    return 0;
+static void AppendToHashIndex(const char* file, const FileStatIdentity* identity, const Digest* digest,
+                              void* userdata) {
+    BoundBootstrapperParameters* bootstrapper_userdata = (BoundBootstrapperParameters*)userdata;
+    HashIndexAppend(&bootstrapper_userdata->hash_index, bootstrapper_userdata->hash_algorithm, file, identity, digest);
+    // The digest is in the cache already, so it survives the compaction
+    HashIndexCompactIfMostlyReplaced(&bootstrapper_userdata->hash_index, bootstrapper_userdata->hash_algorithm,
+                                     &bootstrapper_userdata->hash_cache);
+}
+
+// The hash cache starts out with the digests of the hash index, every digest it learns afterwards is added to the index
+static void InitHashCache(BoundBootstrapperParameters* bootstrapper_userdata, HashAlgorithm algorithm) {
+    HashCache* hash_cache = &bootstrapper_userdata->hash_cache;
+    HashCacheInit(hash_cache, FileHasherForAlgorithm(algorithm));
+    bootstrapper_userdata->hash_algorithm = algorithm;
+    if (bootstrapper_userdata->hash_index.fd < 0)
+        return;
+
+    const size_t loaded = HashIndexLoad(&bootstrapper_userdata->hash_index, algorithm, hash_cache);
+    printf("Loaded %zu %s digests from the hash index\n", loaded, HashAlgorithmName(algorithm));
+    hash_cache->stored = &AppendToHashIndex;
+    hash_cache->stored_userdata = bootstrapper_userdata;
 }
 
-static void AppendMessageToBroadcast(DynamicStringArray* subscriber_broadcast, const char* tag, const char* message) {
+// The hash cache is emptied when the algorithm changes, its hashes would never match anymore
+static void SelectHashAlgorithm(Bootstrapper* bootstrapper, HashAlgorithm algorithm) {
+    BoundBootstrapperParameters* bootstrapper_userdata = (BoundBootstrapperParameters*)bootstrapper->userdata;
+    if (!bootstrapper_userdata)
+        return;
+
+    if (bootstrapper_userdata->hash_algorithm == algorithm)
+        return;
+    HashCacheDeinit(&bootstrapper_userdata->hash_cache);
+    InitHashCache(bootstrapper_userdata, algorithm);
+}
+
+// 'subject' is NULL for debugger output, see the subject of BroadcastFrame
+static void AppendMessageToBroadcast(SubscriberBroadcast* subscriber_broadcast, const char* tag, const char* subject,
+                                     const char* message) {
     printf("Broadcasting:\nTAG=%s\nMESSAGE=%s\n", tag, message);
     char* encoded_message = EncodeSubscriberUpdateMessage(tag, message);
-    DynamicStringArrayAppend(subscriber_broadcast, encoded_message);
+    DynamicStringArrayAppend(&subscriber_broadcast->messages, encoded_message);
+    DynamicStringArrayAppend(&subscriber_broadcast->subjects, subject ? subject : "");
     free(encoded_message);
 }
 
-// This will remove the data that is successfully interpreted
-// Returns True when data was successfully interpreted
+static void ReceiveClientProjectDescription(Bootstrapper* bootstrapper, ProjectFileWatcher* file_watcher,
+                                            ProjectDescription* description) {
+    // Watch before checking the files, so no change is missed in between
+    // The same description again (a client reconnected) is already watched
+    if (!ProjectDescriptionEqual(description, GetProjectDescription(bootstrapper)))
+        ProjectFileWatcherWatch(file_watcher, description);
+    SelectHashAlgorithm(bootstrapper, description->hash_algorithm);
+    ReceiveNewProjectDescription(bootstrapper, description);
+}
+
+// A valid description starts the deltas again at generation 0
+static void AcceptClientProjectDescription(Bootstrapper* bootstrapper, ProjectFileWatcher* file_watcher,
+                                           ProjectDescription* description,
+                                           unsigned long long* description_generation) {
+    printf("I got a valid project description!\n");
+    ReceiveClientProjectDescription(bootstrapper, file_watcher, description);
+    *description_generation = 0;
+}
+
+// The packet is complete, an invalid description is dropped so that the packets after it can still be interpreted
+// Returns True when the description was valid
+static int InterpretBinaryProjectDescription(DynamicBuffer* reading_buffer, Bootstrapper* bootstrapper,
+                                             ProjectFileWatcher* file_watcher, const PacketFrame* frame,
+                                             unsigned long long* description_generation) {
+    ProjectDescription description;
+    const int valid = ProjectDescriptionLoadFromBinary((const uint8_t*)&reading_buffer->data[frame->payload_offset],
+                                                       frame->payload_size, &description);
+    DynamicBufferTrimLeft(reading_buffer, frame->packet_size);
+    if (!valid) {
+        fprintf(stderr, "Got an invalid project description, it is ignored\n");
+        return 0;
+    }
+
+    AcceptClientProjectDescription(bootstrapper, file_watcher, &description, description_generation);
+    ProjectDescriptionDeinit(&description);
+    return 1;
+}
+
+// Only the header of the packet has to be there, the header is dropped and the payload is streamed from then on
+static void StartStreamedProjectDescription(StreamedProjectDescription* streamed_description,
+                                            DynamicBuffer* reading_buffer, const PacketFrame* frame) {
+    streamed_description->active = 1;
+    streamed_description->payload_left = frame->payload_size;
+    ProjectDescriptionJSONStreamInit(&streamed_description->json_stream);
+    DynamicBufferTrimLeft(reading_buffer, frame->payload_offset);
+}
+
+// Feeds whatever part of the payload is in the reading buffer to the JSON parser, and drops it from the buffer
+// Returns True when the packet ended, an invalid description is dropped so that the packets after it can still be
+// interpreted
+static int ContinueStreamedProjectDescription(PollingHandles* all_handles, size_t fd_index,
+                                              Bootstrapper* bootstrapper, ProjectFileWatcher* file_watcher,
+                                              SubscriberBroadcast* subscriber_broadcast,
+                                              unsigned long long* description_generation) {
+    StreamedProjectDescription* streamed_description = &all_handles->streamed_descriptions[fd_index];
+    DynamicBuffer* reading_buffer = &all_handles->reading_buffers[fd_index];
+    if (reading_buffer->size == 0 && streamed_description->payload_left != 0)
+        return 0;
+    // The payload ends with a '\0', which is not part of the JSON
+    size_t consumed, json_size;
+    int ended, terminated;
+    if (streamed_description->payload_left == PACKET_PAYLOAD_SIZE_UNKNOWN) {
+        size_t null_terminator_index;
+        ended = FindNullTerminator((const uint8_t*)reading_buffer->data, reading_buffer->size, &null_terminator_index);
+        json_size = ended ? null_terminator_index : reading_buffer->size;
+        consumed = ended ? null_terminator_index + 1 : reading_buffer->size;
+        terminated = ended;
+    } else {
+        consumed = reading_buffer->size < streamed_description->payload_left ? reading_buffer->size
+                                                                             : streamed_description->payload_left;
+        streamed_description->payload_left -= consumed;
+        ended = streamed_description->payload_left == 0;
+        terminated = ended && consumed > 0 && reading_buffer->data[consumed - 1] == '\0';
+        json_size = terminated ? consumed - 1 : consumed;
+    }
+    ProjectDescriptionJSONStreamFeed(&streamed_description->json_stream, reading_buffer->data, json_size);
+    DynamicBufferTrimLeft(reading_buffer, consumed);
+    if (!ended)
+        return 0;
+
+    ProjectDescription description;
+    const int valid =
+        terminated && ProjectDescriptionJSONStreamFinish(&streamed_description->json_stream, &description);
+    DeinitStreamedProjectDescription(streamed_description);
+    if (!valid) {
+        fprintf(stderr, "Got an invalid project description, it is ignored\n");
+        return 1;
+    }
+
+    AcceptClientProjectDescription(bootstrapper, file_watcher, &description, description_generation);
+    ProjectDescriptionDeinit(&description);
+    AppendMessageToBroadcast(subscriber_broadcast, "PROJECT DESCRIPTION", "PROJECT DESCRIPTION",
+                             "New project description recieved");
+    return 1;
+}
+
+static ProjectDescriptionDeltaType DeltaTypeOfPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type) {
+    switch (type) {
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_REMOVE_PROJECT_ENTRIES:
+        return PROJECT_DESCRIPTION_DELTA_REMOVE_ENTRIES;
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SET_PROJECT_EXECUTABLE:
+        return PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE;
+    default:
+        return PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES;
+    }
+}
+
+// The packet is complete, a delta is only applied when it follows the current generation of the project description
+// Otherwise a delta was lost or the server restarted, and the client is asked for the full description instead
+// Returns True when the delta was applied
+static int InterpretProjectDescriptionDelta(PollingHandles* all_handles, size_t fd_index, Bootstrapper* bootstrapper,
+                                            ProjectFileWatcher* file_watcher, const PacketFrame* frame,
+                                            DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type,
+                                            unsigned long long* description_generation) {
+    DynamicBuffer* reading_buffer = &all_handles->reading_buffers[fd_index];
+    ProjectDescriptionDelta delta;
+    const int valid = ProjectDescriptionDeltaLoadFromBinary(
+        DeltaTypeOfPacket(type), (const uint8_t*)&reading_buffer->data[frame->payload_offset], frame->payload_size,
+        &delta);
+    DynamicBufferTrimLeft(reading_buffer, frame->packet_size);
+    if (!valid) {
+        fprintf(stderr, "Got an invalid project description delta, it is ignored\n");
+        return 0;
+    }
+
+    if (!IsProjectLoaded(bootstrapper) || delta.generation != *description_generation + 1) {
+        printf("Got a project description delta of generation %llu while at generation %llu, requesting a resync\n",
+               delta.generation, *description_generation);
+        uint8_t* packet;
+        size_t packet_size;
+        MakeProjectResyncRequestPacket(&packet, &packet_size);
+        BroadcastFrame* frame = BroadcastFrameCreate("RESYNC", packet, packet_size, NULL, 0);
+        BroadcastFrameQueuePush(&all_handles->writing_queues[fd_index], frame);
+        BroadcastFrameRelease(frame);
+        // A client that keeps sending deltas without reading gets a single resync request
+        if (IsOverWritingBudget(all_handles, fd_index))
+            BroadcastFrameQueueCoalesce(&all_handles->writing_queues[fd_index]);
+        SyncWriteInterest(all_handles, fd_index);
+        free(packet);
+        ProjectDescriptionDeltaDeinit(&delta);
+        return 0;
+    }
+
+    ProjectDescription description;
+    ProjectDescriptionApplyDelta(GetProjectDescription(bootstrapper), &delta, &description);
+    ReceiveClientProjectDescription(bootstrapper, file_watcher, &description);
+    *description_generation = delta.generation;
+
+    ProjectDescriptionDeinit(&description);
+    ProjectDescriptionDeltaDeinit(&delta);
+    return 1;
+}
+
+// This will remove the packets that are interpreted
+// Returns True when a complete packet was interpreted, so that the next one can be tried
 // When the data is unrecognizable, the buffer may be cleared without returning True
 // When the data is incomplete, the buffer will not be cleared and False is returned
 static int InterpretClientData(PollingHandles* all_handles, size_t fd_index, Bootstrapper* bootstrapper,
-                               DynamicStringArray* subscriber_broadcast) {
+                               ProjectFileWatcher* file_watcher, SubscriberBroadcast* subscriber_broadcast,
+                               unsigned long long* description_generation) {
     DynamicBuffer* reading_buffer = &all_handles->reading_buffers[fd_index];
-
-    size_t json_offset;
-    switch (DecodePacket((uint8_t*)reading_buffer->data, reading_buffer->size, &json_offset)) {
-    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION: {
-        const int result = InterpretProjectDescriptionClientData(reading_buffer, bootstrapper, json_offset);
-        if (result)
-            AppendMessageToBroadcast(subscriber_broadcast, "PROJECT DESCRIPTION", "New project description recieved");
-        return result;
+    if (all_handles->streamed_descriptions[fd_index].active)
+        return ContinueStreamedProjectDescription(all_handles, fd_index, bootstrapper, file_watcher,
+                                                  subscriber_broadcast, description_generation);
+
+    // A JSON project description is parsed while it arrives, every other packet is interpreted once it is complete
+    PacketFrame frame;
+    if (DecodePacketHeader((uint8_t*)reading_buffer->data, reading_buffer->size, &frame) ==
+        DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION) {
+        StartStreamedProjectDescription(&all_handles->streamed_descriptions[fd_index], reading_buffer, &frame);
+        return ContinueStreamedProjectDescription(all_handles, fd_index, bootstrapper, file_watcher,
+                                                  subscriber_broadcast, description_generation);
     }
+
+    const DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type =
+        DecodePacketFrame((uint8_t*)reading_buffer->data, reading_buffer->size, &frame);
+    switch (type) {
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION:
+        // Handled above
+        return 1;
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_BINARY_PROJECT_DESCRIPTION:
+        if (InterpretBinaryProjectDescription(reading_buffer, bootstrapper, file_watcher, &frame,
+                                              description_generation))
+            AppendMessageToBroadcast(subscriber_broadcast, "PROJECT DESCRIPTION", "PROJECT DESCRIPTION",
+                             "New project description recieved");
+        return 1;
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UPSERT_PROJECT_ENTRIES:
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_REMOVE_PROJECT_ENTRIES:
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SET_PROJECT_EXECUTABLE:
+        if (InterpretProjectDescriptionDelta(all_handles, fd_index, bootstrapper, file_watcher, &frame, type,
+                                             description_generation))
+            AppendMessageToBroadcast(subscriber_broadcast, "PROJECT DESCRIPTION", "PROJECT DESCRIPTION",
+                             "Project description delta applied");
+        return 1;
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_RESYNC_REQUEST:
+        printf("Got a resync request, that's odd because I'm the server\n");
+        DynamicBufferTrimLeft(reading_buffer, frame.packet_size);
+        return 1;
     case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_REQUEST:
         printf("Got a subscribe request\n");
         all_handles->types[fd_index] = HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION;
-        DynamicBufferTrimLeft(reading_buffer, PACKET_HEADER_SIZE);
+        all_handles->protocol_versions[fd_index] = frame.version;
+        DynamicBufferTrimLeft(reading_buffer, frame.packet_size);
+        return 1;
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE:
+        printf("Got a subscribe response, that's odd because I'm the server\n");
+        DynamicBufferTrimLeft(reading_buffer, frame.packet_size);
         return 1;
-    case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE: {
-        size_t null_terminator_index;
-        if (FindNullTerminator((uint8_t*)&reading_buffer->data[PACKET_HEADER_SIZE],
-                               reading_buffer->size - PACKET_HEADER_SIZE, &null_terminator_index)) {
-            null_terminator_index += PACKET_HEADER_SIZE;
-            printf("Got a subscribe response, that's odd because I'm the server\n");
-            DynamicBufferTrimLeft(reading_buffer, null_terminator_index);
-            return 1;
-        }
-        return 0;
-    }
     case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_START:
         printf("Got request to force start debugger\n");
         // The upper level function would check whether the debugger started/stopped
         (void)ForceStartDebugger(bootstrapper);
-        DynamicBufferTrimLeft(reading_buffer, PACKET_HEADER_SIZE);
+        DynamicBufferTrimLeft(reading_buffer, frame.packet_size);
         return 1;
     case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_STOP:
         printf("Got request to force stop debugger\n");
         // The upper level function would check whether the debugger started/stopped
         (void)ForceStopDebugger(bootstrapper);
-        DynamicBufferTrimLeft(reading_buffer, PACKET_HEADER_SIZE);
+        DynamicBufferTrimLeft(reading_buffer, frame.packet_size);
         return 1;
 
     case DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE:
@@ -275,31 +632,95 @@ static int InterpretClientData(PollingHandles* all_handles, size_t fd_index, Boo
     return 0;
 }
 
-static void RecieveClientSocketData(int client_sock, size_t fd_index, char* client_message, PollingHandles* all_handles,
-                                    Bootstrapper* bootstrapper, DynamicStringArray* subscriber_broadcast) {
-    errno = 0;
-    int read_size = recv(client_sock, client_message, CLIENT_MESSAGE_READ_BUFFER_SIZE, 0);
+// Grows the read size while reads fill it completely, and shrinks it again when reads only use a fraction of it
+static size_t AdaptReadSize(size_t read_size, size_t bytes_read) {
+    if (bytes_read == read_size && read_size < MAXIMAL_READ_SIZE)
+        return read_size * 2;
+    if (bytes_read < read_size / 4 && read_size > MINIMAL_READ_SIZE)
+        return read_size / 2;
+    return read_size;
+}
 
-    if (read_size > 0) {
-        DynamicBufferAppend(&all_handles->reading_buffers[fd_index], client_message, read_size);
-        while (InterpretClientData(all_handles, fd_index, bootstrapper, subscriber_broadcast)) {
+// Reads straight into the reading buffer of the handle until it has no more data for now
+// Returns the amount of bytes read, '*closed' is set to TRUE when the stream ended or failed
+// '*read_error' is the errno of the failed read, or 0 when the stream simply ended
+static size_t ReadAvailableData(PollingHandles* all_handles, size_t fd_index, int* closed, int* read_error) {
+    const int fd = all_handles->fds[fd_index];
+    DynamicBuffer* reading_buffer = &all_handles->reading_buffers[fd_index];
+    size_t* read_size = &all_handles->read_sizes[fd_index];
+    size_t total_bytes_read = 0;
+    *closed = 0;
+    *read_error = 0;
+    while (total_bytes_read < MAXIMAL_READ_PER_WAKEUP) {
+        const size_t requested = *read_size;
+        errno = 0;
+        const ssize_t bytes_read = read(fd, DynamicBufferReserve(reading_buffer, requested), requested);
+        if (bytes_read < 0 && errno == EINTR)
+            continue;
+        if (bytes_read < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (bytes_read <= 0) {
+            *closed = 1;
+            *read_error = bytes_read < 0 ? errno : 0;
+            break;
         }
-    } else if (read_size < 0) {
-        close(client_sock);
-        fprintf(stderr, "recv failed: %s (%d)\n", strerror(errno), errno);
-        Erase(all_handles, fd_index);
-    } else {
-        close(client_sock);
-        printf("Client disconnected\n");
-        Erase(all_handles, fd_index);
+
+        DynamicBufferCommit(reading_buffer, (size_t)bytes_read);
+        total_bytes_read += (size_t)bytes_read;
+        *read_size = AdaptReadSize(requested, (size_t)bytes_read);
+        // A short read drained the handle, reading again would only fail with EAGAIN
+        if ((size_t)bytes_read < requested)
+            break;
     }
+    return total_bytes_read;
+}
+
+static void RecieveClientSocketData(size_t fd_index, PollingHandles* all_handles, Bootstrapper* bootstrapper,
+                                    ProjectFileWatcher* file_watcher, SubscriberBroadcast* subscriber_broadcast,
+                                    unsigned long long* description_generation) {
+    int closed, read_error;
+    // What arrived before the client disconnected is still interpreted
+    if (ReadAvailableData(all_handles, fd_index, &closed, &read_error) > 0) {
+        while (InterpretClientData(all_handles, fd_index, bootstrapper, file_watcher, subscriber_broadcast,
+                                   description_generation)) {
+        }
+    }
+    if (!closed)
+        return;
+
+    const int client_sock = all_handles->fds[fd_index];
+    Erase(all_handles, fd_index);
+    close(client_sock);
+    if (read_error != 0)
+        fprintf(stderr, "recv failed: %s (%d)\n", strerror(read_error), read_error);
+    else
+        printf("Client disconnected\n");
 }
 
 static int FileExists(const char* file) { return access(file, F_OK) == 0; }
 static int FileExists_Bound(const char* file, void* userdata) { return FileExists(file); }
 
-static void CalculateFileHash(const char* file, char** hash, size_t* hash_size, void* userdata) {
-    FileHasher_Do(file, hash, hash_size);
+static long long FileSize_Bound(const char* file, void* userdata) {
+    struct stat file_stat;
+    if (stat(file, &file_stat) != 0)
+        return -1;
+    return file_stat.st_size;
+}
+
+static int CalculateFileHash(const char* file, Digest* digest, void* userdata) {
+    BoundBootstrapperParameters* bootstrapper_userdata = (BoundBootstrapperParameters*)userdata;
+    if (!bootstrapper_userdata)
+        return FileHasher_Do(file, digest);
+    return HashCacheCalculate(&bootstrapper_userdata->hash_cache, file, digest);
+}
+
+// Files that are not in the hash cache are hashed by the hash workers, see PollAwareReceiveFileHashes
+static int RequestFileHash_Bound(const char* file, Digest* digest, void* userdata) {
+    BoundBootstrapperParameters* bootstrapper_userdata = (BoundBootstrapperParameters*)userdata;
+    if (HashCacheLookup(&bootstrapper_userdata->hash_cache, file, digest))
+        return 1;
+    HashWorkerPoolSubmit(&bootstrapper_userdata->hash_worker_pool, file, bootstrapper_userdata->hash_cache.hashFile);
+    return 0;
 }
 
 static int StartGDBServer_Bound(void* userdata, char* program_to_debug,
@@ -325,36 +746,23 @@ static void BindBootstrapper(Bootstrapper* bootstrapper, void* userdata) {
     bootstrapper->stopGDBServer = &StopGDBServer_Bound;
     bootstrapper->fileExists = &FileExists_Bound;
     bootstrapper->calculateHash = &CalculateFileHash;
+    bootstrapper->requestHash = NULL;
+    bootstrapper->fileSize = &FileSize_Bound;
+    BoundBootstrapperParameters* bootstrapper_userdata = (BoundBootstrapperParameters*)userdata;
+    if (bootstrapper_userdata && bootstrapper_userdata->hash_worker_pool.fd >= 0)
+        bootstrapper->requestHash = &RequestFileHash_Bound;
     BootstrapperInit(bootstrapper);
 }
 
-static void CreatePollingHandlesStartingWithServerSocket(PollingHandles* all_handles, int socket_desc) {
-    Init(all_handles);
+static void CreatePollingHandlesStartingWithServerSocket(PollingHandles* all_handles, int socket_desc,
+                                                         const EventDispatchOptions* options) {
+    Init(all_handles, options);
 
-    Append(all_handles, socket_desc, POLLIN, HANDLE_TYPE_SERVER_SOCKET);
+    Append(all_handles, socket_desc, EVENT_POLLER_READABLE, HANDLE_TYPE_SERVER_SOCKET);
 
     fcntl(socket_desc, F_SETFL, fcntl(socket_desc, F_GETFL, 0) | O_NONBLOCK);
 }
 
-static void ValidateMissingFiles(Bootstrapper* bootstrapper) {
-    DynamicStringArray missing;
-    DynamicStringArrayInit(&missing);
-    ReportMissingFiles(bootstrapper, &missing);
-
-    for (int i = 0; i < missing.size; ++i) {
-        if (FileExists(missing.data[i]))
-            UpdateFileActualHash(bootstrapper, missing.data[i]);
-    }
-    DynamicStringArrayDeinit(&missing);
-}
-
-static void ValidateMismatchingHashes(Bootstrapper* bootstrapper) {
-    ProjectDescription* project_description = GetProjectDescription(bootstrapper);
-
-    UpdateFileActualHash(bootstrapper, project_description->executable_name);
-    UpdateFileActualHashes(bootstrapper, &project_description->link_dependencies_for_executable);
-}
-
 // Actually checks whether the PID is set, instead of relying on the bootstrapper's perspective
 static int DebuggerProcessIsRunning(Bootstrapper* bootstrapper) {
     BoundBootstrapperParameters* bootstrapper_userdata = (BoundBootstrapperParameters*)bootstrapper->userdata;
@@ -363,97 +771,156 @@ static int DebuggerProcessIsRunning(Bootstrapper* bootstrapper) {
     return bootstrapper_userdata->gdbserver_instance.pid != NO_PID;
 }
 
+// Adds or removes the debugger handles when the debugger started or stopped
+// A restarted debugger has new handles, which are watched instead of the old ones even when they got the same fds
+static void SyncDebuggerHandles(PollingHandles* all_handles, Bootstrapper* bootstrapper, int debugger_was_running) {
+    BoundBootstrapperParameters* userdata = (BoundBootstrapperParameters*)bootstrapper->userdata;
+    const int restarted = userdata && all_handles->debugger_pid != NO_PID &&
+                          userdata->gdbserver_instance.pid != NO_PID &&
+                          userdata->gdbserver_instance.pid != all_handles->debugger_pid;
+    if (restarted)
+        ExpectAndEraseDebuggerHandles(all_handles);
+    else if (debugger_was_running == DebuggerProcessIsRunning(bootstrapper))
+        return;
+    AddDebuggerHandlesToPollingHandlesIfRunning(all_handles, bootstrapper);
+    RemoveDebuggerHandlesFromPollingHandlesIfNotRunning(all_handles, bootstrapper);
+}
+
 // Result should be freed
 static ProjectFileDifferences* ValidateMismatches(PollingHandles* all_handles, Bootstrapper* bootstrapper,
-                                                  DynamicStringArray* subscriber_broadcast) {
+                                                  SubscriberBroadcast* subscriber_broadcast) {
     const int debugger_is_running = DebuggerProcessIsRunning(bootstrapper);
 
-    ValidateMissingFiles(bootstrapper);
-    ValidateMismatchingHashes(bootstrapper);
+    // A single update, so that the bootstrapper can stop hashing at the first mismatch of any of the files
+    RecheckProjectFiles(bootstrapper);
 
-    if (debugger_is_running != DebuggerProcessIsRunning(bootstrapper)) {
-        AddDebuggerHandlesToPollingHandlesIfRunning(all_handles, bootstrapper);
-        RemoveDebuggerHandlesFromPollingHandlesIfNotRunning(all_handles, bootstrapper);
-    }
+    SyncDebuggerHandles(all_handles, bootstrapper, debugger_is_running);
 }
 
-static void PutBroadcastMessagesInSubscriptionBuffer(DynamicStringArray* subscriber_broadcast,
-                                                     DynamicBuffer* subscription_buffer) {
-    for (int i = 0; i < subscriber_broadcast->size; ++i) {
-        uint8_t* header;
-        size_t packet_size;
-        MakeSubscriptionResponsePacketHeader(&header, &packet_size);
-        DynamicBufferAppend(subscription_buffer, (char*)header, packet_size);
-        free(header);
-        DynamicBufferAppend(subscription_buffer, subscriber_broadcast->data[i],
-                            strlen(subscriber_broadcast->data[i]) + 1);
-    }
+// 'subject' is NULL for debugger output, see the subject of BroadcastFrame
+static BroadcastFrame* EncodeBroadcastMessage(const char* subject, const char* message, uint8_t protocol_version) {
+    const size_t message_size = strlen(message) + 1;
+    uint8_t* header;
+    size_t header_size;
+    MakeSubscriptionResponsePacketHeader(protocol_version, message_size, &header, &header_size);
+    BroadcastFrame* frame =
+        BroadcastFrameCreate(subject, header, header_size, (const uint8_t*)message, message_size);
+    free(header);
+    return frame;
 }
 
-static void PutBroadcastMessagesInSubscriptionBuffers(PollingHandles* all_handles,
-                                                      DynamicStringArray* subscriber_broadcast) {
-    for (int i = 0; i < all_handles->size; ++i) {
-        if (all_handles->types[i] == HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION)
-            PutBroadcastMessagesInSubscriptionBuffer(subscriber_broadcast, &all_handles->writing_buffers[i]);
-    }
+static void QueueDroppedOutputMessage(PollingHandles* all_handles, size_t slot) {
+    char message[64];
+    snprintf(message, sizeof(message), "%zu bytes of debugger output were dropped",
+             all_handles->dropped_output_bytes[slot]);
+    char* encoded_message = EncodeSubscriberUpdateMessage("DROPPED", message);
+    // Replaces the previous one when it was not sent yet, its bytes are part of the total
+    BroadcastFrame* frame = EncodeBroadcastMessage("DROPPED", encoded_message, all_handles->protocol_versions[slot]);
+    BroadcastFrameQueuePush(&all_handles->writing_queues[slot], frame);
+    BroadcastFrameRelease(frame);
+    free(encoded_message);
 }
 
-static void SetPollWriteFlagsWhereWritebuffersHaveData(PollingHandles* polling_handles,
-                                                       const DynamicStringArray* broadcast_buffer) {
+// A subscriber that fell behind first only gets the latest status, then depending on the policy it is disconnected or
+// its debugger output is dropped, so a subscriber that doesn't read can't make the server run out of memory
+// Returns FALSE when the subscriber was disconnected
+static int EnforceWritingBudget(PollingHandles* all_handles, size_t slot) {
+    BroadcastFrameQueue* writing_queue = &all_handles->writing_queues[slot];
+    if (!IsOverWritingBudget(all_handles, slot))
+        return 1;
+    BroadcastFrameQueueCoalesce(writing_queue);
+    if (!IsOverWritingBudget(all_handles, slot))
+        return 1;
 
-    for (size_t i = 0; i < polling_handles->size; ++i) {
-        if (polling_handles->writing_buffers[i].size > 0)
-            polling_handles->pfds[i].events |= POLLOUT;
+    if (all_handles->overflow_policy == SUBSCRIBER_OVERFLOW_DISCONNECT) {
+        const int fd = all_handles->fds[slot];
+        printf("Disconnecting a subscriber that fell behind by %zu bytes\n", writing_queue->bytes);
+        Erase(all_handles, slot);
+        close(fd);
+        return 0;
     }
+
+    const size_t dropped_bytes = BroadcastFrameQueueDropOutput(writing_queue);
+    if (dropped_bytes == 0)
+        return 1;
+    all_handles->dropped_output_bytes[slot] += dropped_bytes;
+    printf("Dropped %zu bytes of debugger output for a subscriber that fell behind\n", dropped_bytes);
+    QueueDroppedOutputMessage(all_handles, slot);
+    BroadcastFrameQueueCoalesce(writing_queue);
+    return 1;
 }
 
-static void ClearPollWriteFlags(PollingHandles* polling_handles) {
-    for (size_t i = 0; i < polling_handles->size; ++i) {
-        polling_handles->pfds[i].events &= ~POLLOUT;
+// Every message is encoded once per protocol version that is subscribed with, the subscribers share the frames
+static void PutBroadcastMessagesInSubscriptionBuffers(PollingHandles* all_handles,
+                                                      SubscriberBroadcast* subscriber_broadcast) {
+    if (subscriber_broadcast->messages.size == 0)
+        return;
+    for (size_t i = 0; i < subscriber_broadcast->messages.size; ++i) {
+        const char* subject = subscriber_broadcast->subjects.data[i][0] != '\0' ? subscriber_broadcast->subjects.data[i]
+                                                                               : NULL;
+        BroadcastFrame* frames[DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION + 1] = {NULL};
+        for (size_t slot = 0; slot < all_handles->slot_count; ++slot) {
+            const uint8_t protocol_version = all_handles->protocol_versions[slot];
+            if (all_handles->types[slot] != HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION ||
+                protocol_version > DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION)
+                continue;
+            if (!frames[protocol_version])
+                frames[protocol_version] =
+                    EncodeBroadcastMessage(subject, subscriber_broadcast->messages.data[i], protocol_version);
+            BroadcastFrameQueuePush(&all_handles->writing_queues[slot], frames[protocol_version]);
+        }
+        for (size_t version = 0; version <= DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION; ++version) {
+            if (frames[version])
+                BroadcastFrameRelease(frames[version]);
+        }
+    }
+    for (size_t slot = 0; slot < all_handles->slot_count; ++slot) {
+        if (all_handles->types[slot] == HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION &&
+            EnforceWritingBudget(all_handles, slot))
+            SyncWriteInterest(all_handles, slot);
     }
 }
 
-// Returns true when the current poll result is invalidated
-static int ReceivePollAware(PollingHandles* all_handles, size_t fd_index, char* client_message,
-                            Bootstrapper* bootstrapper, DynamicStringArray* subscriber_broadcast) {
-    size_t current_size = all_handles->size;
+static void ReceivePollAware(PollingHandles* all_handles, size_t fd_index, Bootstrapper* bootstrapper,
+                             ProjectFileWatcher* file_watcher, SubscriberBroadcast* subscriber_broadcast,
+                             unsigned long long* description_generation) {
     const int debugger_is_running = DebuggerProcessIsRunning(bootstrapper);
-
-    RecieveClientSocketData(all_handles->pfds[fd_index].fd, fd_index, client_message, all_handles, bootstrapper,
-                            subscriber_broadcast);
-
-    if ((debugger_is_running != DebuggerProcessIsRunning(bootstrapper))) {
-        AddDebuggerHandlesToPollingHandlesIfRunning(all_handles, bootstrapper);
-        RemoveDebuggerHandlesFromPollingHandlesIfNotRunning(all_handles, bootstrapper);
-        return 1;
-    }
-
-    if (current_size != all_handles->size)
-        return 1;
-
-    return 0;
+    RecieveClientSocketData(fd_index, all_handles, bootstrapper, file_watcher, subscriber_broadcast,
+                            description_generation);
+    SyncDebuggerHandles(all_handles, bootstrapper, debugger_is_running);
 }
 
-// Returns true when the current poll result is invalidated
-static int WritePollAware(PollingHandles* all_handles, size_t fd_index) {
-    const int fd = all_handles->pfds[fd_index].fd;
-    errno = 0;
-    int bytes_written =
-        write(fd, all_handles->writing_buffers[fd_index].data, all_handles->writing_buffers[fd_index].size);
-    if (bytes_written > 0)
-        DynamicBufferTrimLeft(&all_handles->writing_buffers[fd_index], bytes_written);
-    else if (bytes_written == 0) {
-        close(fd);
-        printf("Client disconnected\n");
-        Erase(all_handles, fd_index);
-        return 1;
-    } else {
-        close(fd);
-        printf("Error writing: %s\n", strerror(errno));
-        Erase(all_handles, fd_index);
-        return 1;
+// Writes until the writing queue is empty or the socket is full, the rest is written once it is writable again
+// The queued frames are gathered into a single sendmsg, which is a writev that can be told not to raise SIGPIPE
+static void WritePollAware(PollingHandles* all_handles, size_t fd_index) {
+    const int fd = all_handles->fds[fd_index];
+    BroadcastFrameQueue* writing_queue = &all_handles->writing_queues[fd_index];
+    while (writing_queue->size > 0) {
+        struct iovec iov[MAXIMAL_FRAMES_PER_WRITE];
+        struct msghdr message;
+        memset(&message, 0, sizeof(message));
+        message.msg_iov = iov;
+        message.msg_iovlen = BroadcastFrameQueueGather(writing_queue, iov, MAXIMAL_FRAMES_PER_WRITE);
+        errno = 0;
+        // A client that went away is noticed by the failed send, instead of a SIGPIPE ending the process
+        const ssize_t bytes_written = sendmsg(fd, &message, MSG_NOSIGNAL);
+        if (bytes_written < 0 && errno == EINTR)
+            continue;
+        if (bytes_written < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        if (bytes_written <= 0) {
+            const int write_error = errno;
+            Erase(all_handles, fd_index);
+            close(fd);
+            if (bytes_written == 0)
+                printf("Client disconnected\n");
+            else
+                printf("Error writing: %s\n", strerror(write_error));
+            return;
+        }
+        BroadcastFrameQueueConsume(writing_queue, (size_t)bytes_written);
     }
-    return 0;
+    SyncWriteInterest(all_handles, fd_index);
 }
 
 // The result should be freed
@@ -466,20 +933,15 @@ static char* MakeDebuggerOutputTag(const char* human_readable_handle_name) {
     return tag;
 }
 
-// The result should be freed
-static char* MakeNullterminatedStringFromBuffer(char* buffer, size_t buffer_size) {
-    char* null_terminated_string = calloc(buffer_size + 1, sizeof(char));
-    memcpy(null_terminated_string, buffer, buffer_size);
-    return null_terminated_string;
-}
-
-static void PutDataAsMessageIntoBroadcast(DynamicStringArray* subscriber_broadcast, char* data, size_t data_size,
-                                          const char* human_readable_handle_name) {
+static void PutBatchesAsMessagesIntoBroadcast(SubscriberBroadcast* subscriber_broadcast,
+                                              const DynamicStringArray* batches,
+                                              const char* human_readable_handle_name) {
+    if (batches->size == 0)
+        return;
     char* tag = MakeDebuggerOutputTag(human_readable_handle_name);
-    char* message = MakeNullterminatedStringFromBuffer(data, data_size);
-    AppendMessageToBroadcast(subscriber_broadcast, tag, message);
+    for (size_t i = 0; i < batches->size; ++i)
+        AppendMessageToBroadcast(subscriber_broadcast, tag, NULL, batches->data[i]);
     free(tag);
-    free(message);
 }
 
 // Cleans up the debugger handles from all the high level objects
@@ -493,159 +955,263 @@ static void CleanupDebuggerInstance(PollingHandles* all_handles, Bootstrapper* b
     GDBInstanceClear(&userdata->gdbserver_instance);
 }
 
-// Returns TRUE when the polling handles are changed (so the current polling iteration becomes invalid)
-static int PollAwareBroadcastDebuggerOutput(PollingHandles* all_handles, int fd_index, Bootstrapper* bootstrapper,
-                                            DynamicStringArray* subscriber_broadcast, char* client_message,
-                                            const char* human_readable_handle_name) {
-    const int fd = all_handles->pfds[fd_index].fd;
-    errno = 0;
-    int bytes_read = read(fd, client_message, CLIENT_MESSAGE_READ_BUFFER_SIZE);
-    if (bytes_read > 0) {
-        PutDataAsMessageIntoBroadcast(subscriber_broadcast, client_message, (size_t)bytes_read,
-                                      human_readable_handle_name);
-    } else if (bytes_read == 0) {
-        CleanupDebuggerInstance(all_handles, bootstrapper);
-        return 1;
-    } else {
-        CleanupDebuggerInstance(all_handles, bootstrapper);
-        fprintf(stderr, "Error reading debugger %s: %s\n", human_readable_handle_name, strerror(errno));
-        return 1;
-    }
+static long long MonotonicMilliseconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000LL + now.tv_nsec / 1000000LL;
+}
 
-    return 0;
+// What the debugger prints is batched, see 'BroadcastDueDebuggerOutput'. When the debugger closes its output, the
+// pending output is broadcasted right away
+static void PollAwareBroadcastDebuggerOutput(PollingHandles* all_handles, size_t fd_index, Bootstrapper* bootstrapper,
+                                             OutputBatcher* output_batcher, SubscriberBroadcast* subscriber_broadcast,
+                                             const char* human_readable_handle_name) {
+    DynamicBuffer* reading_buffer = &all_handles->reading_buffers[fd_index];
+    int closed, read_error;
+    ReadAvailableData(all_handles, fd_index, &closed, &read_error);
+    OutputBatcherAppend(output_batcher, reading_buffer->data, reading_buffer->size, MonotonicMilliseconds());
+    DynamicBufferTrimLeft(reading_buffer, reading_buffer->size);
+    if (!closed)
+        return;
+
+    DynamicStringArray batches;
+    DynamicStringArrayInit(&batches);
+    OutputBatcherTakeAll(output_batcher, &batches);
+    PutBatchesAsMessagesIntoBroadcast(subscriber_broadcast, &batches, human_readable_handle_name);
+    DynamicStringArrayDeinit(&batches);
+
+    CleanupDebuggerInstance(all_handles, bootstrapper);
+    if (read_error != 0)
+        fprintf(stderr, "Error reading debugger %s: %s\n", human_readable_handle_name, strerror(read_error));
 }
 
 // See 'PollAwareBroadcastDebuggerOutput' comment
-static int PollAwareBroadcastDebuggerStdout(PollingHandles* all_handles, int fd_index, Bootstrapper* bootstrapper,
-                                            DynamicStringArray* subscriber_broadcast, char* client_message) {
-    return PollAwareBroadcastDebuggerOutput(all_handles, fd_index, bootstrapper, subscriber_broadcast, client_message,
-                                            "stdout");
+static void PollAwareBroadcastDebuggerStdout(PollingHandles* all_handles, size_t fd_index, Bootstrapper* bootstrapper,
+                                             OutputBatcher* output_batcher, SubscriberBroadcast* subscriber_broadcast) {
+    PollAwareBroadcastDebuggerOutput(all_handles, fd_index, bootstrapper, output_batcher, subscriber_broadcast,
+                                     "stdout");
 }
 
 // See 'PollAwareBroadcastDebuggerOutput' comment
-static int PollAwareBroadcastDebuggerStderr(PollingHandles* all_handles, int fd_index, Bootstrapper* bootstrapper,
-                                            DynamicStringArray* subscriber_broadcast, char* client_message) {
-    return PollAwareBroadcastDebuggerOutput(all_handles, fd_index, bootstrapper, subscriber_broadcast, client_message,
-                                            "stderr");
+static void PollAwareBroadcastDebuggerStderr(PollingHandles* all_handles, size_t fd_index, Bootstrapper* bootstrapper,
+                                             OutputBatcher* output_batcher, SubscriberBroadcast* subscriber_broadcast) {
+    PollAwareBroadcastDebuggerOutput(all_handles, fd_index, bootstrapper, output_batcher, subscriber_broadcast,
+                                     "stderr");
 }
 
 typedef struct {
     PollingHandles all_handles;
-    DynamicStringArray subscriber_broadcast;
+    SubscriberBroadcast subscriber_broadcast;
+    // Outlive the debugger handles, so nothing that was printed right before a restart is lost
+    OutputBatcher debugger_stdout_batcher, debugger_stderr_batcher;
     size_t idle_counter; // Used for logging a message when the poll exits through its timeout
-    char client_message[CLIENT_MESSAGE_READ_BUFFER_SIZE]; // A buffer used for reading data from poll handles
     Bootstrapper bootstrapper;
     BoundBootstrapperParameters bound_bootstrapper_parameters;
     ProjectFileDifferences last_broadcasted_project_differences;
+    ProjectFileWatcher file_watcher;
+    int file_watcher_lost_events; // When TRUE, every project file is checked again and the watches are renewed
+    long long file_changes_polled_ms; // When the project files were last checked without the watcher
+    FileChangeSettler file_change_settler;
+    unsigned long long project_description_generation; // Of the current project description, see the deltas
 } ToplevelPolling;
 
 static void InitToplevelPolling(ToplevelPolling* toplevel_polling, int socket_desc,
-                                DebuggerParameters* debugger_parameters) {
-    CreatePollingHandlesStartingWithServerSocket(&toplevel_polling->all_handles, socket_desc);
+                                DebuggerParameters* debugger_parameters, const EventDispatchOptions* options) {
+    CreatePollingHandlesStartingWithServerSocket(&toplevel_polling->all_handles, socket_desc, options);
 
-    DynamicStringArrayInit(&toplevel_polling->subscriber_broadcast);
+    SubscriberBroadcastInit(&toplevel_polling->subscriber_broadcast);
+    OutputBatcherInit(&toplevel_polling->debugger_stdout_batcher, options->debugger_output_batch_size,
+                      options->debugger_output_delay_ms);
+    OutputBatcherInit(&toplevel_polling->debugger_stderr_batcher, options->debugger_output_batch_size,
+                      options->debugger_output_delay_ms);
 
     toplevel_polling->idle_counter = 0;
+    toplevel_polling->project_description_generation = 0;
     GDBInstanceInit(&toplevel_polling->bound_bootstrapper_parameters.gdbserver_instance,
                     debugger_parameters->debugger_path, &debugger_parameters->debugger_args);
+    HashIndex* hash_index = &toplevel_polling->bound_bootstrapper_parameters.hash_index;
+    hash_index->fd = -1;
+    if (options->hash_index_path)
+        HashIndexOpen(hash_index, options->hash_index_path);
+    InitHashCache(&toplevel_polling->bound_bootstrapper_parameters, HASH_ALGORITHM_SHA1);
+    HashWorkerPool* hash_worker_pool = &toplevel_polling->bound_bootstrapper_parameters.hash_worker_pool;
+    // Without workers, files are hashed on the event loop
+    hash_worker_pool->fd = -1;
+    hash_worker_pool->_internal = NULL;
+    if (options->hash_threads > 0 && !HashWorkerPoolInit(hash_worker_pool, options->hash_threads))
+        HashWorkerPoolDeinit(hash_worker_pool);
     BindBootstrapper(&toplevel_polling->bootstrapper, &toplevel_polling->bound_bootstrapper_parameters);
     ProjectFileDifferencesInit(&toplevel_polling->last_broadcasted_project_differences, NULL);
+
+    ProjectFileWatcherInit(&toplevel_polling->file_watcher);
+    toplevel_polling->file_watcher_lost_events = 0;
+    toplevel_polling->file_changes_polled_ms = MonotonicMilliseconds();
+    FileChangeSettlerInit(&toplevel_polling->file_change_settler, options->file_settle_time_ms);
+    if (toplevel_polling->file_watcher.fd >= 0)
+        Append(&toplevel_polling->all_handles, toplevel_polling->file_watcher.fd, EVENT_POLLER_READABLE,
+               HANDLE_TYPE_FILESYSTEM_WATCHER);
+    if (hash_worker_pool->fd >= 0)
+        Append(&toplevel_polling->all_handles, hash_worker_pool->fd, EVENT_POLLER_READABLE,
+               HANDLE_TYPE_HASH_COMPLETION);
 }
 
 static void DeinitToplevelPolling(ToplevelPolling* toplevel_polling) {
+    HashWorkerPoolDeinit(&toplevel_polling->bound_bootstrapper_parameters.hash_worker_pool);
     GDBInstanceDeinit(&toplevel_polling->bound_bootstrapper_parameters.gdbserver_instance);
-    DynamicStringArrayDeinit(&toplevel_polling->subscriber_broadcast);
+    HashCacheDeinit(&toplevel_polling->bound_bootstrapper_parameters.hash_cache);
+    HashIndexClose(&toplevel_polling->bound_bootstrapper_parameters.hash_index);
+    ProjectFileDifferencesDeinit(&toplevel_polling->last_broadcasted_project_differences);
+    ProjectFileWatcherDeinit(&toplevel_polling->file_watcher);
+    FileChangeSettlerDeinit(&toplevel_polling->file_change_settler);
+    OutputBatcherDeinit(&toplevel_polling->debugger_stdout_batcher);
+    OutputBatcherDeinit(&toplevel_polling->debugger_stderr_batcher);
+    SubscriberBroadcastDeinit(&toplevel_polling->subscriber_broadcast);
     Deinit(&toplevel_polling->all_handles);
     BootstrapperDeinit(&toplevel_polling->bootstrapper);
 }
 
-// Returns TRUE when the poll result is invalidated
-static int DoPollIn(ToplevelPolling* toplevel_polling, size_t fd_index) {
+// Written files are handed to the settler, removed files are handled right away
+static void PollAwareHandleFileChanges(ToplevelPolling* toplevel_polling) {
+    Bootstrapper* bootstrapper = &toplevel_polling->bootstrapper;
+    const int debugger_is_running = DebuggerProcessIsRunning(bootstrapper);
+    const long long now_ms = MonotonicMilliseconds();
+
+    DynamicStringArray finished_files, active_files, removed_files;
+    DynamicStringArrayInit(&finished_files);
+    DynamicStringArrayInit(&active_files);
+    DynamicStringArrayInit(&removed_files);
+    if (!ProjectFileWatcherReadEvents(&toplevel_polling->file_watcher, &finished_files, &active_files,
+                                      &removed_files))
+        toplevel_polling->file_watcher_lost_events = 1;
+
+    for (size_t i = 0; i < finished_files.size; ++i)
+        FileChangeSettlerNotifyFinished(&toplevel_polling->file_change_settler, finished_files.data[i], now_ms);
+    for (size_t i = 0; i < active_files.size; ++i)
+        FileChangeSettlerNotifyActivity(&toplevel_polling->file_change_settler, active_files.data[i], now_ms);
+    for (size_t i = 0; i < removed_files.size; ++i) {
+        FileChangeSettlerForget(&toplevel_polling->file_change_settler, removed_files.data[i]);
+        IndicateRemovedFile(bootstrapper, removed_files.data[i]);
+    }
+
+    DynamicStringArrayDeinit(&finished_files);
+    DynamicStringArrayDeinit(&active_files);
+    DynamicStringArrayDeinit(&removed_files);
+
+    SyncDebuggerHandles(&toplevel_polling->all_handles, bootstrapper, debugger_is_running);
+}
+
+// The settled files are checked again all at once
+static void UpdateSettledFiles(ToplevelPolling* toplevel_polling) {
+    DynamicStringArray settled_files;
+    DynamicStringArrayInit(&settled_files);
+    FileChangeSettlerTakeSettled(&toplevel_polling->file_change_settler, MonotonicMilliseconds(), &settled_files);
+
+    if (settled_files.size > 0) {
+        const int debugger_is_running = DebuggerProcessIsRunning(&toplevel_polling->bootstrapper);
+        UpdateFileActualHashes(&toplevel_polling->bootstrapper, &settled_files);
+        SyncDebuggerHandles(&toplevel_polling->all_handles, &toplevel_polling->bootstrapper, debugger_is_running);
+    }
+    DynamicStringArrayDeinit(&settled_files);
+}
+
+// Completed hashes are remembered in the hash cache and handed to the bootstrapper
+static void PollAwareReceiveFileHashes(ToplevelPolling* toplevel_polling) {
+    Bootstrapper* bootstrapper = &toplevel_polling->bootstrapper;
+    BoundBootstrapperParameters* bootstrapper_userdata = &toplevel_polling->bound_bootstrapper_parameters;
+    const int debugger_is_running = DebuggerProcessIsRunning(bootstrapper);
+
+    HashJobResult* completed = HashWorkerPoolTakeCompleted(&bootstrapper_userdata->hash_worker_pool);
+    for (HashJobResult* result = completed; result; result = result->next) {
+        // A result of another hash algorithm is only passed on, the bootstrapper requests the file again
+        if (result->identity_valid && result->hashFile == bootstrapper_userdata->hash_cache.hashFile)
+            HashCacheStore(&bootstrapper_userdata->hash_cache, result->file, &result->identity, &result->digest);
+        ReceiveFileHash(bootstrapper, result->file, &result->digest);
+    }
+    HashJobResultFree(completed);
+
+    SyncDebuggerHandles(&toplevel_polling->all_handles, bootstrapper, debugger_is_running);
+}
+
+static void DoPollIn(ToplevelPolling* toplevel_polling, size_t fd_index) {
     PollingHandles* all_handles = &toplevel_polling->all_handles;
     switch (all_handles->types[fd_index]) {
     case HANDLE_TYPE_SERVER_SOCKET:
-        AddClientSocket(all_handles->pfds[fd_index].fd, all_handles);
-        // A new handle is added in all_handles, so further indexes might be invalid now
-        return 1;
+        AddClientSockets(all_handles->fds[fd_index], all_handles);
+        break;
     case HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION:
-    case HANDLE_TYPE_CLIENT_SOCKET: {
-        if (ReceivePollAware(all_handles, fd_index, toplevel_polling->client_message, &toplevel_polling->bootstrapper,
-                             &toplevel_polling->subscriber_broadcast)) {
-            return 1;
-        }
+    case HANDLE_TYPE_CLIENT_SOCKET:
+        ReceivePollAware(all_handles, fd_index, &toplevel_polling->bootstrapper, &toplevel_polling->file_watcher,
+                         &toplevel_polling->subscriber_broadcast, &toplevel_polling->project_description_generation);
         break;
-    }
     case HANDLE_TYPE_DEBUGGER_STDOUT:
-        if (PollAwareBroadcastDebuggerStdout(all_handles, fd_index, &toplevel_polling->bootstrapper,
-                                             &toplevel_polling->subscriber_broadcast,
-                                             toplevel_polling->client_message)) {
-            return 1;
-        }
+        PollAwareBroadcastDebuggerStdout(all_handles, fd_index, &toplevel_polling->bootstrapper,
+                                         &toplevel_polling->debugger_stdout_batcher,
+                                         &toplevel_polling->subscriber_broadcast);
         break;
     case HANDLE_TYPE_DEBUGGER_STDERR:
-        if (PollAwareBroadcastDebuggerStderr(all_handles, fd_index, &toplevel_polling->bootstrapper,
-                                             &toplevel_polling->subscriber_broadcast,
-                                             toplevel_polling->client_message)) {
-            return 1;
-        }
+        PollAwareBroadcastDebuggerStderr(all_handles, fd_index, &toplevel_polling->bootstrapper,
+                                         &toplevel_polling->debugger_stderr_batcher,
+                                         &toplevel_polling->subscriber_broadcast);
+        break;
+    case HANDLE_TYPE_FILESYSTEM_WATCHER:
+        PollAwareHandleFileChanges(toplevel_polling);
+        break;
+    case HANDLE_TYPE_HASH_COMPLETION:
+        PollAwareReceiveFileHashes(toplevel_polling);
+        break;
+    default:
         break;
     }
-    return 0;
 }
 
-// Returns TRUE when the poll result is invalidated
-static int DoPollOut(PollingHandles* all_handles, size_t fd_index) {
+static void DoPollOut(PollingHandles* all_handles, size_t fd_index) {
     switch (all_handles->types[fd_index]) {
+    // A client without a subscription only gets resync requests
+    case HANDLE_TYPE_CLIENT_SOCKET:
     case HANDLE_TYPE_CLIENT_SOCKET_WITH_SUBSCRIPTION:
-        if (WritePollAware(all_handles, fd_index)) {
-            return 1;
-        }
+        WritePollAware(all_handles, fd_index);
         break;
     default:
         break;
     }
-    return 0;
 }
 
-// Returns TRUE when the poll result is invalidated
-static int DoPollHup(PollingHandles* all_handles, Bootstrapper* bootstrapper, size_t fd_index) {
+static void DoPollHup(PollingHandles* all_handles, Bootstrapper* bootstrapper, size_t fd_index) {
     if (all_handles->types[fd_index] != HANDLE_TYPE_DEBUGGER_STDOUT &&
         all_handles->types[fd_index] != HANDLE_TYPE_DEBUGGER_STDERR) {
         fprintf(stderr, "FIXME: When polling, a POLLHUP has occurred on a non debugger fd. This is not "
                         "handled because this is not expected to happen.\n");
     } else {
         CleanupDebuggerInstance(all_handles, bootstrapper);
-        return 1;
     }
-    return 0;
 }
 
+// Every ready event is served, a handle that was erased by an earlier event is recognized by its stale id and a
+// handle that was added by an earlier event has not been waited for yet
 static void PollIteration(int ready, ToplevelPolling* toplevel_polling, int* running) {
+    PollingHandles* all_handles = &toplevel_polling->all_handles;
     if (ready > 0) {
-        int poll_result_invalidated = 0;
-        for (size_t fd_index = 0; fd_index < toplevel_polling->all_handles.size && !poll_result_invalidated;
-             ++fd_index) {
-            if (toplevel_polling->all_handles.pfds[fd_index].revents & POLLIN) {
-                if (DoPollIn(toplevel_polling, fd_index))
-                    break;
-            }
-            if (toplevel_polling->all_handles.pfds[fd_index].revents & POLLOUT) {
-                if (DoPollOut(&toplevel_polling->all_handles, fd_index))
-                    break;
-            }
-            if (toplevel_polling->all_handles.pfds[fd_index].revents & POLLHUP) {
-                if (DoPollHup(&toplevel_polling->all_handles, &toplevel_polling->bootstrapper, fd_index))
-                    break;
-            }
-            if (toplevel_polling->all_handles.pfds[fd_index].revents & POLLERR) {
+        for (int event_index = 0; event_index < ready; ++event_index) {
+            // Copied, adding a handle might move the events
+            const EventPollerEvent event = all_handles->poller.events[event_index];
+            const uint64_t id = event.id;
+            size_t fd_index;
+            if (!SlotOfEventId(all_handles, id, &fd_index))
+                continue;
+            if (event.events & EVENT_POLLER_READABLE)
+                DoPollIn(toplevel_polling, fd_index);
+            if ((event.events & EVENT_POLLER_WRITABLE) && SlotOfEventId(all_handles, id, &fd_index))
+                DoPollOut(all_handles, fd_index);
+            if ((event.events & EVENT_POLLER_HANGUP) && SlotOfEventId(all_handles, id, &fd_index))
+                DoPollHup(all_handles, &toplevel_polling->bootstrapper, fd_index);
+            if ((event.events & EVENT_POLLER_ERROR) && SlotOfEventId(all_handles, id, &fd_index)) {
                 fprintf(stderr, "FIXME: When polling, a POLLERR has occurred. This is not handled because this is not "
                                 "expected to happen.\n");
             }
-            if (toplevel_polling->all_handles.pfds[fd_index].revents & POLLNVAL) {
+            if ((event.events & EVENT_POLLER_INVALID) && SlotOfEventId(all_handles, id, &fd_index)) {
                 fprintf(stderr, "FIXME: When polling, a POLLNVAL has occurred. This is not handled because this is not "
                                 "expected to happen.\n");
-                Erase(&toplevel_polling->all_handles, fd_index);
-                break;
+                Erase(all_handles, fd_index);
             }
         }
 
@@ -653,7 +1219,9 @@ static void PollIteration(int ready, ToplevelPolling* toplevel_polling, int* run
         fprintf(stderr, "poll failed\n");
         *running = 0;
     } else {
-        printf("I do nothing this time %lu\n", ++toplevel_polling->idle_counter);
+        const HashCache* hash_cache = &toplevel_polling->bound_bootstrapper_parameters.hash_cache;
+        printf("I do nothing this time %zu (hash cache hits: %zu, misses: %zu)\n", ++toplevel_polling->idle_counter,
+               hash_cache->hits, hash_cache->misses);
     }
 }
 
@@ -675,64 +1243,154 @@ DynamicBuffer* CombineMessageForFileMismatch(const char* file, const char* wante
 }
 
 static void BroadcastProjectDifferences(const ProjectFileDifferences* project_differences,
-                                        DynamicStringArray* subscriber_broadcast) {
+                                        SubscriberBroadcast* subscriber_broadcast) {
 
     for (int i = 0; i < project_differences->existing.size; ++i) {
         if (strcmp(project_differences->actual_hashes.data[i], project_differences->wanted_hashes.data[i]) == 0) {
-            AppendMessageToBroadcast(subscriber_broadcast, "MATCH", project_differences->existing.data[i]);
+            AppendMessageToBroadcast(subscriber_broadcast, "MATCH", project_differences->existing.data[i],
+                                     project_differences->existing.data[i]);
         } else {
             DynamicBuffer* combined_mismatch = CombineMessageForFileMismatch(
-                project_differences->existing.data[i], project_differences->actual_hashes.data[i],
-                project_differences->wanted_hashes.data[i]);
-            AppendMessageToBroadcast(subscriber_broadcast, "MISMATCH", combined_mismatch->data);
+                project_differences->existing.data[i], project_differences->wanted_hashes.data[i],
+                project_differences->actual_hashes.data[i]);
+            AppendMessageToBroadcast(subscriber_broadcast, "MISMATCH", project_differences->existing.data[i],
+                                     combined_mismatch->data);
             free(combined_mismatch);
         }
     }
 
     for (int i = 0; i < project_differences->missing.size; ++i) {
-        AppendMessageToBroadcast(subscriber_broadcast, "MISSING", project_differences->missing.data[i]);
+        AppendMessageToBroadcast(subscriber_broadcast, "MISSING", project_differences->missing.data[i],
+                                 project_differences->missing.data[i]);
     }
 }
 
-static void BroadcastProjectDifferencesIfOutOfDate(Bootstrapper* bootstrapper, DynamicStringArray* subscriber_broadcast,
-                                                   const ProjectFileDifferences* last_broadcasted_differences) {
-    ProjectFileDifferences* project_differences = (ProjectFileDifferences*)malloc(sizeof(ProjectFileDifferences));
+static void BroadcastProjectDifferencesIfOutOfDate(Bootstrapper* bootstrapper,
+                                                   SubscriberBroadcast* subscriber_broadcast,
+                                                   ProjectFileDifferences* last_broadcasted_differences) {
+    ProjectFileDifferences project_differences;
+
+    // The actual hashes of files that are still being hashed are not known yet
+    if (HasPendingHashes(bootstrapper) || HasDeferredHashes(bootstrapper))
+        return;
 
-    ProjectFileDifferencesInit(project_differences, bootstrapper);
+    ProjectFileDifferencesInit(&project_differences, bootstrapper);
 
-    if (!ProjectFileDifferencesEqual(project_differences, last_broadcasted_differences))
-        BroadcastProjectDifferences(project_differences, subscriber_broadcast);
+    if (!ProjectFileDifferencesEqual(&project_differences, last_broadcasted_differences)) {
+        BroadcastProjectDifferences(&project_differences, subscriber_broadcast);
+        ProjectFileDifferencesDeinit(last_broadcasted_differences);
+        *last_broadcasted_differences = project_differences;
+        return;
+    }
 
-    free(project_differences);
+    ProjectFileDifferencesDeinit(&project_differences);
 }
 
-#define POLL_TIMEOUT_MS 1000
+// Without a complete set of inotify watches, changes can only be found by checking the project files, at most once per
+// POLL_TIMEOUT_MS. That waits until the deferred files are hashed, otherwise they would be marked again before they
+// ever are.
+// Returns the milliseconds until the files are due to be checked, -1 when the watcher reports every change
+long long TimeUntilFileChangesArePolled(const ProjectFileWatcher* file_watcher, int file_watcher_lost_events,
+                                        const Bootstrapper* bootstrapper, long long polled_ms, long long now_ms) {
+    if (HasDeferredHashes(bootstrapper))
+        return -1;
+    if (!file_watcher_lost_events && ProjectFileWatcherIsComplete(file_watcher))
+        return -1;
+    const long long due_ms = polled_ms + POLL_TIMEOUT_MS;
+    return due_ms > now_ms ? due_ms - now_ms : 0;
+}
 
-static void StartRecievingData(int socket_desc, struct sockaddr_in* server, DebuggerParameters* debugger_parameters) {
-    listen(socket_desc, 3);
+static long long TimeUntilFileChangesNeedPolling(const ToplevelPolling* toplevel_polling, long long now_ms) {
+    return TimeUntilFileChangesArePolled(&toplevel_polling->file_watcher, toplevel_polling->file_watcher_lost_events,
+                                         &toplevel_polling->bootstrapper, toplevel_polling->file_changes_polled_ms,
+                                         now_ms);
+}
+
+// One file per iteration, so that the sockets stay responsive while the files are hashed in the background
+static void HashDeferredFiles(ToplevelPolling* toplevel_polling) {
+    Bootstrapper* bootstrapper = &toplevel_polling->bootstrapper;
+    const int debugger_is_running = DebuggerProcessIsRunning(bootstrapper);
+    if (HashDeferredFile(bootstrapper))
+        SyncDebuggerHandles(&toplevel_polling->all_handles, bootstrapper, debugger_is_running);
+}
+
+static void PollFileChanges(ToplevelPolling* toplevel_polling) {
+    // Directories that did not exist before might exist now
+    ProjectFileWatcherWatch(&toplevel_polling->file_watcher, GetProjectDescription(&toplevel_polling->bootstrapper));
+    toplevel_polling->file_watcher_lost_events = 0;
+    toplevel_polling->file_changes_polled_ms = MonotonicMilliseconds();
+
+    ValidateMismatches(&toplevel_polling->all_handles, &toplevel_polling->bootstrapper,
+                       &toplevel_polling->subscriber_broadcast);
+}
+
+// A batch of debugger output is broadcasted once it is full, or once its oldest byte waited for the output delay
+static void BroadcastDueDebuggerOutput(ToplevelPolling* toplevel_polling) {
+    const long long now_ms = MonotonicMilliseconds();
+    DynamicStringArray batches;
+    DynamicStringArrayInit(&batches);
+    OutputBatcherTakeDue(&toplevel_polling->debugger_stdout_batcher, now_ms, &batches);
+    PutBatchesAsMessagesIntoBroadcast(&toplevel_polling->subscriber_broadcast, &batches, "stdout");
+    DynamicStringArrayClear(&batches);
+    OutputBatcherTakeDue(&toplevel_polling->debugger_stderr_batcher, now_ms, &batches);
+    PutBatchesAsMessagesIntoBroadcast(&toplevel_polling->subscriber_broadcast, &batches, "stderr");
+    DynamicStringArrayDeinit(&batches);
+}
+
+// Returns the earliest of both timeouts, -1 means there is nothing to wait for
+static long long EarliestTimeout(long long timeout, long long other_timeout) {
+    if (timeout < 0)
+        return other_timeout;
+    if (other_timeout < 0)
+        return timeout;
+    return timeout < other_timeout ? timeout : other_timeout;
+}
+
+// Wakes up in time for the next file to settle, batch of debugger output or check of the project files to be due, and
+// doesn't wait at all while files are deferred
+static int PollTimeout(const ToplevelPolling* toplevel_polling) {
+    if (HasDeferredHashes(&toplevel_polling->bootstrapper))
+        return 0;
+    const long long now_ms = MonotonicMilliseconds();
+    long long timeout = FileChangeSettlerTimeUntilNextSettle(&toplevel_polling->file_change_settler, now_ms);
+    timeout = EarliestTimeout(timeout, OutputBatcherTimeUntilDue(&toplevel_polling->debugger_stdout_batcher, now_ms));
+    timeout = EarliestTimeout(timeout, OutputBatcherTimeUntilDue(&toplevel_polling->debugger_stderr_batcher, now_ms));
+    timeout = EarliestTimeout(timeout, TimeUntilFileChangesNeedPolling(toplevel_polling, now_ms));
+    if (timeout >= 0 && timeout < POLL_TIMEOUT_MS)
+        return (int)timeout;
+    return POLL_TIMEOUT_MS;
+}
+
+static void StartRecievingData(int socket_desc, struct sockaddr_in* server, DebuggerParameters* debugger_parameters,
+                               const EventDispatchOptions* options) {
+    if (listen(socket_desc, options->listen_backlog) < 0) {
+        fprintf(stderr, "listen failed: %s\n", strerror(errno));
+        exit(1);
+    }
 
     printf("Waiting for incoming connections\n");
 
     ToplevelPolling toplevel_polling;
-    InitToplevelPolling(&toplevel_polling, socket_desc, debugger_parameters);
+    InitToplevelPolling(&toplevel_polling, socket_desc, debugger_parameters, options);
 
     int running = 1;
     while (running) {
-        ClearPollWriteFlags(&toplevel_polling.all_handles);
-        SetPollWriteFlagsWhereWritebuffersHaveData(&toplevel_polling.all_handles,
-                                                   &toplevel_polling.subscriber_broadcast);
-        int ready = poll(toplevel_polling.all_handles.pfds, toplevel_polling.all_handles.size, POLL_TIMEOUT_MS);
+        int ready = EventPollerWait(&toplevel_polling.all_handles.poller, PollTimeout(&toplevel_polling));
         PollIteration(ready, &toplevel_polling, &running);
+        BroadcastDueDebuggerOutput(&toplevel_polling);
 
-        ValidateMismatches(&toplevel_polling.all_handles, &toplevel_polling.bootstrapper,
-                           &toplevel_polling.subscriber_broadcast);
+        UpdateSettledFiles(&toplevel_polling);
+        HashDeferredFiles(&toplevel_polling);
+
+        if (TimeUntilFileChangesNeedPolling(&toplevel_polling, MonotonicMilliseconds()) == 0)
+            PollFileChanges(&toplevel_polling);
 
         BroadcastProjectDifferencesIfOutOfDate(&toplevel_polling.bootstrapper, &toplevel_polling.subscriber_broadcast,
                                                &toplevel_polling.last_broadcasted_project_differences);
 
         PutBroadcastMessagesInSubscriptionBuffers(&toplevel_polling.all_handles,
                                                   &toplevel_polling.subscriber_broadcast);
-        DynamicStringArrayClear(&toplevel_polling.subscriber_broadcast);
+        SubscriberBroadcastClear(&toplevel_polling.subscriber_broadcast);
     }
     DeinitToplevelPolling(&toplevel_polling);
 }
@@ -748,9 +1406,23 @@ static void ReportSocketPort(int socket_desc) {
         fprintf(stderr, "Something went wrong retrieving server socket name: %s\n", strerror(errno));
 }
 
-void StartEventDispatch(int port, DebuggerParameters* debugger_parameters) {
+void EventDispatchOptionsSetDefaults(EventDispatchOptions* options) {
+    options->file_settle_time_ms = DEFAULT_FILE_SETTLE_TIME_MS;
+    const long online_processors = sysconf(_SC_NPROCESSORS_ONLN);
+    options->hash_threads = online_processors > 0 ? (size_t)online_processors : 1;
+    options->hash_index_path = NULL;
+    options->use_poll = 0;
+    options->listen_backlog = SOMAXCONN;
+    options->subscriber_budget_bytes = DEFAULT_SUBSCRIBER_BUDGET_BYTES;
+    options->subscriber_budget_frames = DEFAULT_SUBSCRIBER_BUDGET_FRAMES;
+    options->subscriber_overflow_policy = SUBSCRIBER_OVERFLOW_DROP_OUTPUT;
+    options->debugger_output_batch_size = DEFAULT_DEBUGGER_OUTPUT_BATCH_SIZE;
+    options->debugger_output_delay_ms = DEFAULT_DEBUGGER_OUTPUT_DELAY_MS;
+}
+
+void StartEventDispatch(int port, DebuggerParameters* debugger_parameters, const EventDispatchOptions* options) {
     int socket_desc;
-    socket_desc = socket(AF_INET, SOCK_STREAM, 0);
+    socket_desc = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
 
     if (socket_desc == -1) {
         fprintf(stderr, "Could not create socket\n");
@@ -769,5 +1441,5 @@ void StartEventDispatch(int port, DebuggerParameters* debugger_parameters) {
 
     ReportSocketPort(socket_desc);
 
-    StartRecievingData(socket_desc, &server, debugger_parameters);
+    StartRecievingData(socket_desc, &server, debugger_parameters, options);
 }
\ No newline at end of file
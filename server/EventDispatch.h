@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stddef.h>
+
 #include "DynamicStringArray.h"
 
 typedef struct DebuggerParameters {
@@ -7,5 +9,33 @@ typedef struct DebuggerParameters {
     DynamicStringArray debugger_args;
 } DebuggerParameters;
 
+// What happens to a subscriber whose unsent messages exceed the budget, after only the latest status of every file
+// was kept
+typedef enum SubscriberOverflowPolicy {
+    SUBSCRIBER_OVERFLOW_DROP_OUTPUT, // Its debugger output is dropped, it is told how much
+    SUBSCRIBER_OVERFLOW_DISCONNECT,
+} SubscriberOverflowPolicy;
+
+typedef struct EventDispatchOptions {
+    // A changed project file is only hashed once nothing has written to it for this long
+    long long file_settle_time_ms;
+    // Changed project files are hashed by this many worker threads, 0 hashes them on the event loop
+    size_t hash_threads;
+    // Digests are remembered across restarts in this file, NULL only remembers them while running
+    const char* hash_index_path;
+    // When TRUE, events are waited for with poll() instead of epoll
+    int use_poll;
+    // The amount of connections that may wait to be accepted, the kernel caps it at net.core.somaxconn
+    int listen_backlog;
+    // The amount of bytes and messages that may wait to be sent to a subscriber
+    size_t subscriber_budget_bytes, subscriber_budget_frames;
+    SubscriberOverflowPolicy subscriber_overflow_policy;
+    // Debugger output is broadcasted in batches of up to this many bytes, or once it waited this long
+    size_t debugger_output_batch_size;
+    long long debugger_output_delay_ms;
+} EventDispatchOptions;
+
+void EventDispatchOptionsSetDefaults(EventDispatchOptions*);
+
 // Debugger parameters are not free'd by this function
-void StartEventDispatch(int port, DebuggerParameters*);
\ No newline at end of file
+void StartEventDispatch(int port, DebuggerParameters*, const EventDispatchOptions*);
\ No newline at end of file
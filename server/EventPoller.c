@@ -0,0 +1,222 @@
+#include "EventPoller.h"
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// More ready fds than this are reported by the next wait, epoll hands them out round robin
+#define EPOLL_MAXIMAL_EVENTS 256
+#define NO_POSITION ((size_t)-1)
+
+typedef struct {
+    int epoll_fd; // -1 for the poll() backend
+    struct epoll_event* epoll_events;
+
+    // The poll() backend keeps the fds packed, removing one moves the last one into its place
+    struct pollfd* pfds;
+    uint64_t* ids;
+    size_t size, capacity;
+    size_t* positions; // The position in 'pfds' of every fd, indexed by the fd
+    size_t positions_size;
+} EventPollerInternal;
+
+static uint32_t ToEpollEvents(int events) {
+    uint32_t epoll_events = 0;
+    if (events & EVENT_POLLER_READABLE)
+        epoll_events |= EPOLLIN;
+    if (events & EVENT_POLLER_WRITABLE)
+        epoll_events |= EPOLLOUT;
+    return epoll_events;
+}
+
+static int FromEpollEvents(uint32_t epoll_events) {
+    int events = 0;
+    if (epoll_events & EPOLLIN)
+        events |= EVENT_POLLER_READABLE;
+    if (epoll_events & EPOLLOUT)
+        events |= EVENT_POLLER_WRITABLE;
+    if (epoll_events & EPOLLHUP)
+        events |= EVENT_POLLER_HANGUP;
+    if (epoll_events & EPOLLERR)
+        events |= EVENT_POLLER_ERROR;
+    return events;
+}
+
+static short ToPollEvents(int events) {
+    short poll_events = 0;
+    if (events & EVENT_POLLER_READABLE)
+        poll_events |= POLLIN;
+    if (events & EVENT_POLLER_WRITABLE)
+        poll_events |= POLLOUT;
+    return poll_events;
+}
+
+static int FromPollEvents(short poll_events) {
+    int events = 0;
+    if (poll_events & POLLIN)
+        events |= EVENT_POLLER_READABLE;
+    if (poll_events & POLLOUT)
+        events |= EVENT_POLLER_WRITABLE;
+    if (poll_events & POLLHUP)
+        events |= EVENT_POLLER_HANGUP;
+    if (poll_events & POLLERR)
+        events |= EVENT_POLLER_ERROR;
+    if (poll_events & POLLNVAL)
+        events |= EVENT_POLLER_INVALID;
+    return events;
+}
+
+void EventPollerInit(EventPoller* poller, EventPollerBackend preferred_backend) {
+    EventPollerInternal* internal = (EventPollerInternal*)calloc(1, sizeof(EventPollerInternal));
+    internal->epoll_fd = -1;
+    if (preferred_backend == EVENT_POLLER_BACKEND_EPOLL) {
+        errno = 0;
+        internal->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+        if (internal->epoll_fd < 0)
+            fprintf(stderr, "Unable to create an epoll fd, falling back to poll(): %s\n", strerror(errno));
+    }
+
+    if (internal->epoll_fd >= 0) {
+        poller->backend = EVENT_POLLER_BACKEND_EPOLL;
+        internal->epoll_events = (struct epoll_event*)malloc(EPOLL_MAXIMAL_EVENTS * sizeof(struct epoll_event));
+        poller->events = (EventPollerEvent*)malloc(EPOLL_MAXIMAL_EVENTS * sizeof(EventPollerEvent));
+    } else {
+        poller->backend = EVENT_POLLER_BACKEND_POLL;
+        internal->capacity = 1;
+        internal->pfds = (struct pollfd*)malloc(internal->capacity * sizeof(struct pollfd));
+        internal->ids = (uint64_t*)malloc(internal->capacity * sizeof(uint64_t));
+        poller->events = (EventPollerEvent*)malloc(internal->capacity * sizeof(EventPollerEvent));
+    }
+    poller->_internal = internal;
+}
+
+void EventPollerDeinit(EventPoller* poller) {
+    EventPollerInternal* internal = (EventPollerInternal*)poller->_internal;
+    if (internal->epoll_fd >= 0)
+        close(internal->epoll_fd);
+    free(internal->epoll_events);
+    free(internal->pfds);
+    free(internal->ids);
+    free(internal->positions);
+    free(internal);
+    free(poller->events);
+}
+
+static void EpollControl(EventPollerInternal* internal, int operation, int fd, uint64_t id, int events) {
+    struct epoll_event epoll_event;
+    memset(&epoll_event, 0, sizeof(epoll_event));
+    epoll_event.events = ToEpollEvents(events);
+    epoll_event.data.u64 = id;
+    errno = 0;
+    if (epoll_ctl(internal->epoll_fd, operation, fd, &epoll_event) == 0)
+        return;
+    // A closed fd is dropped by epoll itself
+    if (operation == EPOLL_CTL_DEL && (errno == EBADF || errno == ENOENT))
+        return;
+    fprintf(stderr, "epoll_ctl failed for fd %d: %s\n", fd, strerror(errno));
+}
+
+static void ReservePosition(EventPollerInternal* internal, int fd) {
+    if ((size_t)fd < internal->positions_size)
+        return;
+    size_t positions_size = internal->positions_size > 0 ? internal->positions_size : 16;
+    while (positions_size <= (size_t)fd)
+        positions_size *= 2;
+    internal->positions = (size_t*)realloc(internal->positions, positions_size * sizeof(size_t));
+    for (size_t i = internal->positions_size; i < positions_size; ++i)
+        internal->positions[i] = NO_POSITION;
+    internal->positions_size = positions_size;
+}
+
+static size_t FindPosition(const EventPollerInternal* internal, int fd) {
+    if (fd < 0 || (size_t)fd >= internal->positions_size)
+        return NO_POSITION;
+    return internal->positions[fd];
+}
+
+void EventPollerAdd(EventPoller* poller, int fd, uint64_t id, int events) {
+    EventPollerInternal* internal = (EventPollerInternal*)poller->_internal;
+    if (poller->backend == EVENT_POLLER_BACKEND_EPOLL) {
+        EpollControl(internal, EPOLL_CTL_ADD, fd, id, events);
+        return;
+    }
+
+    if (fd < 0 || FindPosition(internal, fd) != NO_POSITION)
+        return;
+    if (internal->size == internal->capacity) {
+        internal->capacity *= 2;
+        internal->pfds = (struct pollfd*)realloc(internal->pfds, internal->capacity * sizeof(struct pollfd));
+        internal->ids = (uint64_t*)realloc(internal->ids, internal->capacity * sizeof(uint64_t));
+        poller->events = (EventPollerEvent*)realloc(poller->events, internal->capacity * sizeof(EventPollerEvent));
+    }
+    ReservePosition(internal, fd);
+    internal->pfds[internal->size].fd = fd;
+    internal->pfds[internal->size].events = ToPollEvents(events);
+    internal->pfds[internal->size].revents = 0;
+    internal->ids[internal->size] = id;
+    internal->positions[fd] = internal->size++;
+}
+
+void EventPollerModify(EventPoller* poller, int fd, uint64_t id, int events) {
+    EventPollerInternal* internal = (EventPollerInternal*)poller->_internal;
+    if (poller->backend == EVENT_POLLER_BACKEND_EPOLL) {
+        EpollControl(internal, EPOLL_CTL_MOD, fd, id, events);
+        return;
+    }
+
+    const size_t position = FindPosition(internal, fd);
+    if (position == NO_POSITION)
+        return;
+    internal->pfds[position].events = ToPollEvents(events);
+    internal->ids[position] = id;
+}
+
+void EventPollerRemove(EventPoller* poller, int fd) {
+    EventPollerInternal* internal = (EventPollerInternal*)poller->_internal;
+    if (poller->backend == EVENT_POLLER_BACKEND_EPOLL) {
+        EpollControl(internal, EPOLL_CTL_DEL, fd, 0, 0);
+        return;
+    }
+
+    const size_t position = FindPosition(internal, fd);
+    if (position == NO_POSITION)
+        return;
+    const size_t last = --internal->size;
+    if (position != last) {
+        internal->pfds[position] = internal->pfds[last];
+        internal->ids[position] = internal->ids[last];
+        internal->positions[internal->pfds[position].fd] = position;
+    }
+    internal->positions[fd] = NO_POSITION;
+}
+
+int EventPollerWait(EventPoller* poller, int timeout_ms) {
+    EventPollerInternal* internal = (EventPollerInternal*)poller->_internal;
+    if (poller->backend == EVENT_POLLER_BACKEND_EPOLL) {
+        const int ready = epoll_wait(internal->epoll_fd, internal->epoll_events, EPOLL_MAXIMAL_EVENTS, timeout_ms);
+        if (ready < 0)
+            return errno == EINTR ? 0 : -1;
+        for (int i = 0; i < ready; ++i) {
+            poller->events[i].id = internal->epoll_events[i].data.u64;
+            poller->events[i].events = FromEpollEvents(internal->epoll_events[i].events);
+        }
+        return ready;
+    }
+
+    const int ready = poll(internal->pfds, internal->size, timeout_ms);
+    if (ready < 0)
+        return errno == EINTR ? 0 : -1;
+    int event_count = 0;
+    for (size_t i = 0; i < internal->size && event_count < ready; ++i) {
+        if (internal->pfds[i].revents == 0)
+            continue;
+        poller->events[event_count].id = internal->ids[i];
+        poller->events[event_count].events = FromPollEvents(internal->pfds[i].revents);
+        ++event_count;
+    }
+    return event_count;
+}
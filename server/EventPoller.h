@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define EVENT_POLLER_READABLE 0x1
+#define EVENT_POLLER_WRITABLE 0x2
+#define EVENT_POLLER_HANGUP 0x4
+#define EVENT_POLLER_ERROR 0x8
+#define EVENT_POLLER_INVALID 0x10 // The fd is not open, only the poll() backend notices this
+
+typedef enum EventPollerBackend { EVENT_POLLER_BACKEND_EPOLL, EVENT_POLLER_BACKEND_POLL } EventPollerBackend;
+
+typedef struct EventPollerEvent {
+    uint64_t id; // As given when the fd was added
+    int events;
+} EventPollerEvent;
+
+// Waits until any of a set of fds is ready, with epoll or with poll() as a fallback
+// Only the ready fds are reported, with epoll that takes O(ready) instead of O(fds)
+typedef struct EventPoller {
+    EventPollerBackend backend;
+    EventPollerEvent* events; // Filled by EventPollerWait, adding an fd might move them
+    void* _internal;
+} EventPoller;
+
+// Falls back to poll() when epoll is not available
+void EventPollerInit(EventPoller*, EventPollerBackend preferred_backend);
+void EventPollerDeinit(EventPoller*);
+
+// An fd is added at most once, 'events' are READABLE and WRITABLE flags, hangups and errors are always reported
+void EventPollerAdd(EventPoller*, int fd, uint64_t id, int events);
+void EventPollerModify(EventPoller*, int fd, uint64_t id, int events);
+// Should happen before the fd is closed, removing an fd that was already closed is harmless as long as its number was
+// not reused for another watched fd
+void EventPollerRemove(EventPoller*, int fd);
+
+// Returns the amount of events put in 'events', 0 when the timeout passed or a signal interrupted the wait, and -1
+// when waiting failed
+int EventPollerWait(EventPoller*, int timeout_ms);
@@ -0,0 +1,110 @@
+#include "FileChangeSettler.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "DynamicStringArray.h"
+
+#define FILE_CHANGE_SETTLER_INITIAL_CAPACITY 16
+
+typedef struct {
+    char* file;
+    long long settle_time_ms;
+} PendingFile;
+
+typedef struct {
+    PendingFile* pending;
+    size_t size, capacity;
+} FileChangeSettlerInternal;
+
+void FileChangeSettlerInit(FileChangeSettler* settler, long long quiet_window_ms) {
+    settler->quiet_window_ms = quiet_window_ms;
+
+    FileChangeSettlerInternal* internal = (FileChangeSettlerInternal*)malloc(sizeof(FileChangeSettlerInternal));
+    internal->size = 0;
+    internal->capacity = FILE_CHANGE_SETTLER_INITIAL_CAPACITY;
+    internal->pending = (PendingFile*)malloc(sizeof(PendingFile) * internal->capacity);
+    settler->_internal = internal;
+}
+
+void FileChangeSettlerDeinit(FileChangeSettler* settler) {
+    FileChangeSettlerInternal* internal = (FileChangeSettlerInternal*)settler->_internal;
+    if (!internal)
+        return;
+    for (size_t i = 0; i < internal->size; ++i)
+        free(internal->pending[i].file);
+    free(internal->pending);
+    free(internal);
+    settler->_internal = NULL;
+}
+
+// When not found, returns internal->size
+static size_t FindPendingFile(const FileChangeSettlerInternal* internal, const char* file) {
+    for (size_t i = 0; i < internal->size; ++i) {
+        if (strcmp(internal->pending[i].file, file) == 0)
+            return i;
+    }
+    return internal->size;
+}
+
+// Pending files are not kept in order, the last one takes the place of the erased one
+static void ErasePendingFile(FileChangeSettlerInternal* internal, size_t at) {
+    free(internal->pending[at].file);
+    internal->pending[at] = internal->pending[internal->size - 1];
+    --internal->size;
+}
+
+void FileChangeSettlerNotifyFinished(FileChangeSettler* settler, const char* file, long long now_ms) {
+    FileChangeSettlerInternal* internal = (FileChangeSettlerInternal*)settler->_internal;
+    const size_t index = FindPendingFile(internal, file);
+    if (index == internal->size) {
+        if (internal->size == internal->capacity) {
+            internal->capacity *= 2;
+            internal->pending = (PendingFile*)realloc(internal->pending, sizeof(PendingFile) * internal->capacity);
+        }
+        const size_t file_length = strlen(file);
+        internal->pending[index].file = (char*)malloc(file_length + 1);
+        memcpy(internal->pending[index].file, file, file_length + 1);
+        ++internal->size;
+    }
+    internal->pending[index].settle_time_ms = now_ms + settler->quiet_window_ms;
+}
+
+void FileChangeSettlerNotifyActivity(FileChangeSettler* settler, const char* file, long long now_ms) {
+    FileChangeSettlerInternal* internal = (FileChangeSettlerInternal*)settler->_internal;
+    const size_t index = FindPendingFile(internal, file);
+    if (index != internal->size)
+        internal->pending[index].settle_time_ms = now_ms + settler->quiet_window_ms;
+}
+
+void FileChangeSettlerForget(FileChangeSettler* settler, const char* file) {
+    FileChangeSettlerInternal* internal = (FileChangeSettlerInternal*)settler->_internal;
+    const size_t index = FindPendingFile(internal, file);
+    if (index != internal->size)
+        ErasePendingFile(internal, index);
+}
+
+void FileChangeSettlerTakeSettled(FileChangeSettler* settler, long long now_ms, DynamicStringArray* settled_files) {
+    FileChangeSettlerInternal* internal = (FileChangeSettlerInternal*)settler->_internal;
+    for (size_t i = 0; i < internal->size;) {
+        if (internal->pending[i].settle_time_ms <= now_ms) {
+            DynamicStringArrayAppend(settled_files, internal->pending[i].file);
+            ErasePendingFile(internal, i);
+        } else {
+            ++i;
+        }
+    }
+}
+
+long long FileChangeSettlerTimeUntilNextSettle(const FileChangeSettler* settler, long long now_ms) {
+    const FileChangeSettlerInternal* internal = (const FileChangeSettlerInternal*)settler->_internal;
+    long long time_until_next = -1;
+    for (size_t i = 0; i < internal->size; ++i) {
+        long long time_until_settle = internal->pending[i].settle_time_ms - now_ms;
+        if (time_until_settle < 0)
+            time_until_settle = 0;
+        if (time_until_next < 0 || time_until_settle < time_until_next)
+            time_until_next = time_until_settle;
+    }
+    return time_until_next;
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+typedef struct DynamicStringArray DynamicStringArray;
+
+// Holds on to changed files until nobody has written to them for a while, so a file that is still being copied into
+// place is hashed once when the copy is done instead of on every write
+typedef struct FileChangeSettler {
+    long long quiet_window_ms;
+    void* _internal;
+} FileChangeSettler;
+
+void FileChangeSettlerInit(FileChangeSettler*, long long quiet_window_ms);
+void FileChangeSettlerDeinit(FileChangeSettler*);
+
+// A writer has finished with the file (closed after writing, or renamed into place)
+// The file settles when no other activity happens during the quiet window
+void FileChangeSettlerNotifyFinished(FileChangeSettler*, const char* file, long long now_ms);
+// The file is being written to, when the file is pending it is postponed for another quiet window
+void FileChangeSettlerNotifyActivity(FileChangeSettler*, const char* file, long long now_ms);
+// The file is gone, it won't settle anymore
+void FileChangeSettlerForget(FileChangeSettler*, const char* file);
+
+// Moves every settled file into the output argument, which must be initialized and will be owned by the caller
+void FileChangeSettlerTakeSettled(FileChangeSettler*, long long now_ms, DynamicStringArray* settled_files);
+// Returns -1 when no file is pending, otherwise the amount of milliseconds until the next file settles
+long long FileChangeSettlerTimeUntilNextSettle(const FileChangeSettler*, long long now_ms);
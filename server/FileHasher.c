@@ -1,39 +1,103 @@
 #include "FileHasher.h"
 
-#include <stdio.h>
+#include <fcntl.h>
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
 
 #include <openssl/sha.h>
 
-static void PutSHA1BytesIntoAllocatedString(const unsigned char* hash_bytes, char** hash_string, size_t* hash_length) {
-    *hash_length = SHA_DIGEST_LENGTH * 2;
-    *hash_string = (char*)malloc(sizeof(char) * *hash_length + 1);
+#include "XXHash64.h"
 
-    for (int i = 0; i < SHA_DIGEST_LENGTH; ++i) {
-        sprintf(&(*hash_string)[i * 2], "%x", hash_bytes[i]);
-    }
+// Files are read rather than mapped, a mapped file that is truncated while it is hashed raises SIGBUS, and files are
+// hashed exactly while they are being deployed
+// Small enough to stay in the CPU cache between reading and hashing
+#define READ_BLOCK_SIZE (128 * 1024)
+#define READ_BLOCK_ALIGNMENT 4096
+
+typedef union {
+    SHA_CTX sha1;
+    XXH64State xxh64;
+} HashContext;
+
+typedef struct {
+    void (*init)(HashContext*);
+    void (*update)(HashContext*, const void* data, size_t size);
+    void (*final)(HashContext*, Digest*);
+} HashFunctions;
+
+static void SHA1Init(HashContext* context) { SHA1_Init(&context->sha1); }
+static void SHA1Update(HashContext* context, const void* data, size_t size) { SHA1_Update(&context->sha1, data, size); }
+static void SHA1Final(HashContext* context, Digest* digest) {
+    SHA1_Final(digest->bytes, &context->sha1);
+    digest->size = SHA_DIGEST_LENGTH;
 }
 
-void FileHasher_Do(const char* file, char** hash, size_t* hash_length) {
-    FILE* file_handle = fopen(file, "rb");
-    if (!file_handle) {
-        *hash = "";
-        *hash_length = 0;
-        return;
-    }
-    unsigned char read_buffer[512];
-    SHA_CTX sha1_context;
-    SHA1_Init(&sha1_context);
-    size_t bytes_read;
-    while ((bytes_read = fread(read_buffer, sizeof(char), 512, file_handle)) > 0) {
-        SHA1_Update(&sha1_context, read_buffer, bytes_read);
-    }
+static void XXH64InitWithoutSeed(HashContext* context) { XXH64Init(&context->xxh64, 0); }
+static void XXH64UpdateContext(HashContext* context, const void* data, size_t size) {
+    XXH64Update(&context->xxh64, data, size);
+}
+// The digest is written big endian, like the canonical xxHash representation
+static void XXH64FinalContext(HashContext* context, Digest* digest) {
+    const uint64_t hash = XXH64Final(&context->xxh64);
+    for (int i = 0; i < 8; ++i)
+        digest->bytes[i] = (unsigned char)(hash >> (56 - i * 8));
+    digest->size = 8;
+}
+
+// Indexed by HashAlgorithm
+static const HashFunctions hash_functions[] = {{&SHA1Init, &SHA1Update, &SHA1Final},
+                                               {&XXH64InitWithoutSeed, &XXH64UpdateContext, &XXH64FinalContext}};
 
-    unsigned char hash_buffer[SHA_DIGEST_LENGTH];
-    SHA1_Final(hash_buffer, &sha1_context);
+// Returns FALSE when reading fails
+static int UpdateWithReads(const HashFunctions* functions, HashContext* context, int fd) {
+    void* read_buffer;
+    if (posix_memalign(&read_buffer, READ_BLOCK_ALIGNMENT, READ_BLOCK_SIZE) != 0)
+        return 0;
+
+    ssize_t bytes_read;
+    while ((bytes_read = read(fd, read_buffer, READ_BLOCK_SIZE)) > 0)
+        functions->update(context, read_buffer, bytes_read);
+
+    free(read_buffer);
+    return bytes_read == 0;
+}
 
-    PutSHA1BytesIntoAllocatedString(&hash_buffer[0], hash, hash_length);
+static int HashFile(const HashFunctions* functions, const char* file, Digest* digest) {
+    DigestClear(digest);
 
-    fclose(file_handle);
-}
\ No newline at end of file
+    const int fd = open(file, O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return 0;
+
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    HashContext context;
+    functions->init(&context);
+    const int hashed = UpdateWithReads(functions, &context, fd);
+    close(fd);
+    if (!hashed)
+        return 0;
+
+    functions->final(&context, digest);
+    return 1;
+}
+
+int FileHasher_Do(const char* file, Digest* digest) {
+    return HashFile(&hash_functions[HASH_ALGORITHM_SHA1], file, digest);
+}
+
+int FileHasher_DoXXH64(const char* file, Digest* digest) {
+    return HashFile(&hash_functions[HASH_ALGORITHM_XXH64], file, digest);
+}
+
+FileHasherFunction FileHasherForAlgorithm(HashAlgorithm algorithm) {
+    switch (algorithm) {
+    case HASH_ALGORITHM_XXH64:
+        return &FileHasher_DoXXH64;
+    case HASH_ALGORITHM_SHA1:
+    default:
+        return &FileHasher_Do;
+    }
+}
@@ -1,9 +1,13 @@
 #pragma once
 
-#include <stddef.h>
+#include "Digest.h"
+#include "HashAlgorithm.h"
 
-// Calculates the hash of the given file, puts the result as a c-string in 'hash', the length of the resulting string is
-// put into 'hash_length'.
-// When something goes wrong, like the file can't be openened, the hash_length is zero
-// When hash_length is 0 the hash is NOT to be freed!
-void FileHasher_Do(const char* file, char** hash, size_t* hash_length);
\ No newline at end of file
+// Calculates the SHA-1 digest of the given file
+// Returns FALSE when something goes wrong, like the file can't be opened, the digest is then empty
+int FileHasher_Do(const char* file, Digest*);
+// Same as FileHasher_Do, hashes with XXH64 which is a lot cheaper
+int FileHasher_DoXXH64(const char* file, Digest*);
+
+typedef int (*FileHasherFunction)(const char* file, Digest*);
+FileHasherFunction FileHasherForAlgorithm(HashAlgorithm);
@@ -121,6 +121,18 @@ static int ChildProcessExited(int waitpid_status) { return WIFEXITED(waitpid_sta
 #define SLEEP_WAIT_TIME_MS 10
 #define MAX_WAIT_LOOPS (STOPPING_WAIT_TIME_MS / SLEEP_WAIT_TIME_MS)
 
+// Returns TRUE when the child process exited within STOPPING_WAIT_TIME_MS
+static int WaitForChildProcessExit(pid_t pid) {
+    for (int loops = 0; loops < MAX_WAIT_LOOPS; ++loops) {
+        int status = 0;
+        const pid_t waited = waitpid(pid, &status, WNOHANG);
+        if (waited < 0 || (waited == pid && ChildProcessExited(status)))
+            return 1;
+        usleep(SLEEP_WAIT_TIME_MS * 1000);
+    }
+    return 0;
+}
+
 // First signals SIGTERM, then waits up to STOPPING_WAIT_TIME_MS for GDB server to stop
 // When the GDB server has not stopped after STOPPING_WAIT_TIME_MS, SIGKILL is sent, and it is assumed that the GDB
 // server will stop
@@ -131,23 +143,10 @@ int StopGDBServer(GDBInstance* instance) {
     CloseStdOutputs(instance);
 
     kill(instance->pid, SIGTERM);
-    int status;
-    int loops = 0;
-
-    waitpid(instance->pid, &status, WNOHANG);
-
-    if (!ChildProcessExited(status)) {
-
-        do {
-            waitpid(instance->pid, &status, WNOHANG);
-
-            sleep(SLEEP_WAIT_TIME_MS);
-            ++loops;
-        } while (!ChildProcessExited(status) && loops <= MAX_WAIT_LOOPS);
-    }
-
-    if (loops == MAX_WAIT_LOOPS)
+    if (!WaitForChildProcessExit(instance->pid)) {
         kill(instance->pid, SIGKILL);
+        waitpid(instance->pid, NULL, 0);
+    }
 
     SetHandleDefaults(instance);
 
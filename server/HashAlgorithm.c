@@ -0,0 +1,17 @@
+#include "HashAlgorithm.h"
+
+#include <string.h>
+
+static const char* const hash_algorithm_names[HASH_ALGORITHM_COUNT] = {"sha1", "xxh64"};
+
+int HashAlgorithmFromName(const char* name, HashAlgorithm* algorithm) {
+    for (int i = 0; i < sizeof(hash_algorithm_names) / sizeof(hash_algorithm_names[0]); ++i) {
+        if (strcmp(name, hash_algorithm_names[i]) == 0) {
+            *algorithm = (HashAlgorithm)i;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+const char* HashAlgorithmName(HashAlgorithm algorithm) { return hash_algorithm_names[algorithm]; }
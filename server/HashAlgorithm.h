@@ -0,0 +1,14 @@
+#pragma once
+
+// The algorithm that was used for the hashes in a project description
+typedef enum HashAlgorithm {
+    HASH_ALGORITHM_SHA1, // Used when the project description does not name an algorithm
+    HASH_ALGORITHM_XXH64,
+
+    HASH_ALGORITHM_COUNT // Not an algorithm, every valid algorithm is below it
+} HashAlgorithm;
+
+// Returns FALSE when the name is not a known algorithm
+int HashAlgorithmFromName(const char* name, HashAlgorithm*);
+// The name as it appears in a project description
+const char* HashAlgorithmName(HashAlgorithm);
@@ -0,0 +1,176 @@
+#include "HashCache.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+#include "PathIndex.h"
+
+#define HASH_CACHE_INITIAL_CAPACITY 16
+
+typedef struct {
+    char* file;
+    FileStatIdentity identity;
+    Digest digest;
+} HashCacheEntry;
+
+typedef struct {
+    HashCacheEntry* entries;
+    size_t size, capacity;
+    PathIndex entries_index; // Keyed by the files of the entries
+} HashCacheInternal;
+
+static long long TimespecToNanoseconds(const struct timespec* time) {
+    return (long long)time->tv_sec * 1000000000LL + time->tv_nsec;
+}
+
+int FileStatIdentityRead(const char* file, FileStatIdentity* identity) {
+    struct stat file_stat;
+    if (stat(file, &file_stat) != 0)
+        return 0;
+    identity->device = file_stat.st_dev;
+    identity->inode = file_stat.st_ino;
+    identity->size = file_stat.st_size;
+    identity->mtime_ns = TimespecToNanoseconds(&file_stat.st_mtim);
+    identity->ctime_ns = TimespecToNanoseconds(&file_stat.st_ctim);
+    return 1;
+}
+
+int FileStatIdentityEqual(const FileStatIdentity* first, const FileStatIdentity* second) {
+    return first->device == second->device && first->inode == second->inode && first->size == second->size &&
+           first->mtime_ns == second->mtime_ns && first->ctime_ns == second->ctime_ns;
+}
+
+void HashCacheInit(HashCache* cache, int (*hashFile)(const char*, Digest*)) {
+    cache->hashFile = hashFile;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->stored = NULL;
+    cache->stored_userdata = NULL;
+
+    HashCacheInternal* internal = (HashCacheInternal*)malloc(sizeof(HashCacheInternal));
+    internal->size = 0;
+    internal->capacity = HASH_CACHE_INITIAL_CAPACITY;
+    internal->entries = (HashCacheEntry*)malloc(sizeof(HashCacheEntry) * internal->capacity);
+    PathIndexInit(&internal->entries_index);
+    cache->_internal = internal;
+}
+
+static void FreeEntry(HashCacheEntry* entry) { free(entry->file); }
+
+void HashCacheDeinit(HashCache* cache) {
+    HashCacheInternal* internal = (HashCacheInternal*)cache->_internal;
+    if (!internal)
+        return;
+    for (size_t i = 0; i < internal->size; ++i)
+        FreeEntry(&internal->entries[i]);
+    free(internal->entries);
+    PathIndexDeinit(&internal->entries_index);
+    free(internal);
+    cache->_internal = NULL;
+}
+
+// When not found, returns internal->size
+static size_t FindEntry(const HashCacheInternal* internal, const char* file) {
+    const size_t index = PathIndexFind(&internal->entries_index, file);
+    return index == PATH_INDEX_NOT_FOUND ? internal->size : index;
+}
+
+static void EraseEntry(HashCacheInternal* internal, size_t at) {
+    PathIndexErase(&internal->entries_index, internal->entries[at].file);
+    FreeEntry(&internal->entries[at]);
+    --internal->size;
+    if (at == internal->size)
+        return;
+    internal->entries[at] = internal->entries[internal->size];
+    PathIndexInsert(&internal->entries_index, internal->entries[at].file, at);
+}
+
+static char* CopyString(const char* string) {
+    const size_t length = strlen(string);
+    char* copy = (char*)malloc(length + 1);
+    memcpy(copy, string, length + 1);
+    return copy;
+}
+
+static void StoreEntry(HashCache* cache, const char* file, const FileStatIdentity* identity, const Digest* digest) {
+    HashCacheInternal* internal = (HashCacheInternal*)cache->_internal;
+    size_t index = FindEntry(internal, file);
+    if (index == internal->size) {
+        if (internal->size == internal->capacity) {
+            internal->capacity *= 2;
+            internal->entries =
+                (HashCacheEntry*)realloc(internal->entries, sizeof(HashCacheEntry) * internal->capacity);
+        }
+        internal->entries[index].file = CopyString(file);
+        PathIndexInsert(&internal->entries_index, internal->entries[index].file, index);
+        ++internal->size;
+    } else if (FileStatIdentityEqual(&internal->entries[index].identity, identity) &&
+               DigestEqual(&internal->entries[index].digest, digest)) {
+        return;
+    }
+    internal->entries[index].identity = *identity;
+    internal->entries[index].digest = *digest;
+    if (cache->stored)
+        cache->stored(file, identity, digest, cache->stored_userdata);
+}
+
+static int Lookup(HashCache* cache, const char* file, const FileStatIdentity* identity, Digest* digest) {
+    HashCacheInternal* internal = (HashCacheInternal*)cache->_internal;
+    const size_t index = FindEntry(internal, file);
+    if (index != internal->size && FileStatIdentityEqual(&internal->entries[index].identity, identity)) {
+        ++cache->hits;
+        *digest = internal->entries[index].digest;
+        return 1;
+    }
+    ++cache->misses;
+    return 0;
+}
+
+static void Forget(HashCache* cache, const char* file) {
+    HashCacheInternal* internal = (HashCacheInternal*)cache->_internal;
+    const size_t index = FindEntry(internal, file);
+    if (index != internal->size)
+        EraseEntry(internal, index);
+}
+
+int HashCacheCalculate(HashCache* cache, const char* file, Digest* digest) {
+    FileStatIdentity identity;
+    if (!FileStatIdentityRead(file, &identity)) {
+        Forget(cache, file);
+        DigestClear(digest);
+        return 0;
+    }
+
+    if (Lookup(cache, file, &identity, digest))
+        return 1;
+
+    if (!cache->hashFile(file, digest))
+        return 0;
+    StoreEntry(cache, file, &identity, digest);
+    return 1;
+}
+
+int HashCacheLookup(HashCache* cache, const char* file, Digest* digest) {
+    FileStatIdentity identity;
+    if (!FileStatIdentityRead(file, &identity)) {
+        Forget(cache, file);
+        return 0;
+    }
+    return Lookup(cache, file, &identity, digest);
+}
+
+void HashCacheStore(HashCache* cache, const char* file, const FileStatIdentity* identity, const Digest* digest) {
+    if (!DigestIsEmpty(digest))
+        StoreEntry(cache, file, identity, digest);
+}
+
+size_t HashCacheSize(const HashCache* cache) { return ((const HashCacheInternal*)cache->_internal)->size; }
+
+void HashCacheVisit(const HashCache* cache,
+                    void (*visit)(const char* file, const FileStatIdentity*, const Digest*, void* userdata),
+                    void* userdata) {
+    const HashCacheInternal* internal = (const HashCacheInternal*)cache->_internal;
+    for (size_t i = 0; i < internal->size; ++i)
+        visit(internal->entries[i].file, &internal->entries[i].identity, &internal->entries[i].digest, userdata);
+}
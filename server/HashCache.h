@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stddef.h>
+#include <sys/types.h>
+
+#include "Digest.h"
+
+// Everything stat(2) tells about a file that changes when its content changes
+typedef struct FileStatIdentity {
+    dev_t device;
+    ino_t inode;
+    off_t size;
+    long long mtime_ns, ctime_ns;
+} FileStatIdentity;
+
+// Returns FALSE when the file can't be stat'ed
+int FileStatIdentityRead(const char* file, FileStatIdentity*);
+int FileStatIdentityEqual(const FileStatIdentity*, const FileStatIdentity*);
+
+// Remembers file digests, a file is only hashed again when its stat identity changes
+typedef struct HashCache {
+    // Same contract as FileHasher_Do
+    int (*hashFile)(const char* file, Digest*);
+    size_t hits, misses;
+    // Optional, called whenever a digest is remembered that the cache did not know yet
+    void (*stored)(const char* file, const FileStatIdentity*, const Digest*, void* userdata);
+    void* stored_userdata;
+
+    void* _internal;
+} HashCache;
+
+void HashCacheInit(HashCache*, int (*hashFile)(const char*, Digest*));
+void HashCacheDeinit(HashCache*);
+
+// Same contract as FileHasher_Do, the result is taken from the cache when the file's stat identity is unchanged
+int HashCacheCalculate(HashCache*, const char* file, Digest*);
+
+// Returns TRUE and puts the cached digest in 'digest' when the file's stat identity is unchanged
+// Returns FALSE when the file has to be hashed
+int HashCacheLookup(HashCache*, const char* file, Digest*);
+// Remembers a digest that was calculated elsewhere, 'identity' should be read before the file was hashed
+// Empty digests are not remembered
+void HashCacheStore(HashCache*, const char* file, const FileStatIdentity* identity, const Digest*);
+// Returns the amount of remembered digests
+size_t HashCacheSize(const HashCache*);
+// Calls 'visit' for every remembered digest
+void HashCacheVisit(const HashCache*,
+                    void (*visit)(const char* file, const FileStatIdentity*, const Digest*, void* userdata),
+                    void* userdata);
@@ -0,0 +1,213 @@
+#include "HashIndex.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "XXHash64.h"
+
+#define HASH_INDEX_MAGIC "DBHASHIX"
+#define HASH_INDEX_VERSION 1
+// The file is rewritten when it has this many times more records than digests that are still used
+#define COMPACTION_RECORD_FACTOR 4
+#define COMPACTION_MINIMUM_RECORDS 4096
+
+typedef struct {
+    char magic[8];
+    uint32_t version;     // Also tells apart files that were written with another byte order
+    uint32_t record_size; // Tells apart files that were written with another record layout
+} HashIndexHeader;
+
+// Followed by 'path_length' bytes of path, without a null terminator
+typedef struct {
+    uint32_t checksum; // Lower half of the XXH64 of everything after the checksum, including the path
+    uint16_t path_length;
+    uint8_t algorithm;
+    uint8_t digest_size;
+    uint64_t device, inode;
+    int64_t size, mtime_ns, ctime_ns;
+    uint8_t digest[DIGEST_MAX_SIZE];
+    uint32_t reserved;
+} HashIndexRecord;
+
+static uint32_t RecordChecksum(const HashIndexRecord* record, const char* path) {
+    XXH64State state;
+    XXH64Init(&state, 0);
+    XXH64Update(&state, &record->path_length, sizeof(HashIndexRecord) - offsetof(HashIndexRecord, path_length));
+    XXH64Update(&state, path, record->path_length);
+    return (uint32_t)XXH64Final(&state);
+}
+
+static void MakeHeader(HashIndexHeader* header) {
+    memcpy(header->magic, HASH_INDEX_MAGIC, sizeof(header->magic));
+    header->version = HASH_INDEX_VERSION;
+    header->record_size = sizeof(HashIndexRecord);
+}
+
+// Returns FALSE when the header could not be written
+static int StartOver(HashIndex* index) {
+    HashIndexHeader header;
+    MakeHeader(&header);
+    index->record_count = 0;
+    return ftruncate(index->fd, 0) == 0 && write(index->fd, &header, sizeof(header)) == sizeof(header);
+}
+
+int HashIndexOpen(HashIndex* index, const char* path) {
+    index->record_count = 0;
+    index->fd = open(path, O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (index->fd < 0) {
+        fprintf(stderr, "Unable to open the hash index %s: %s\n", path, strerror(errno));
+        return 0;
+    }
+    // Compaction truncates the file, which would drop whatever another process appended since it was loaded
+    if (flock(index->fd, LOCK_EX | LOCK_NB) != 0) {
+        fprintf(stderr, "The hash index %s is not used, another process uses it: %s\n", path, strerror(errno));
+        close(index->fd);
+        index->fd = -1;
+        return 0;
+    }
+
+    HashIndexHeader expected_header, header;
+    MakeHeader(&expected_header);
+    const ssize_t header_size = pread(index->fd, &header, sizeof(header), 0);
+    if (header_size == sizeof(header) && memcmp(&header, &expected_header, sizeof(header)) == 0)
+        return 1;
+
+    if (header_size > 0)
+        fprintf(stderr, "The hash index %s was not written by this version, it is started over\n", path);
+    if (!StartOver(index)) {
+        fprintf(stderr, "Unable to initialize the hash index %s: %s\n", path, strerror(errno));
+        close(index->fd);
+        index->fd = -1;
+        return 0;
+    }
+    return 1;
+}
+
+void HashIndexClose(HashIndex* index) {
+    if (index->fd >= 0)
+        close(index->fd);
+    index->fd = -1;
+}
+
+// Returns FALSE when no intact record starts at 'position'
+static int ReadRecord(const unsigned char* mapping, size_t mapping_size, size_t position, HashIndexRecord* record) {
+    if (mapping_size - position < sizeof(HashIndexRecord))
+        return 0;
+    memcpy(record, mapping + position, sizeof(HashIndexRecord));
+    if (record->path_length == 0 || mapping_size - position - sizeof(HashIndexRecord) < record->path_length)
+        return 0;
+    if (record->digest_size == 0 || record->digest_size > DIGEST_MAX_SIZE)
+        return 0;
+    return record->checksum == RecordChecksum(record, (const char*)mapping + position + sizeof(HashIndexRecord));
+}
+
+typedef struct {
+    HashIndex* index;
+    HashAlgorithm algorithm;
+} CompactionContext;
+
+static void AppendVisited(const char* file, const FileStatIdentity* identity, const Digest* digest, void* userdata) {
+    const CompactionContext* context = (const CompactionContext*)userdata;
+    HashIndexAppend(context->index, context->algorithm, file, identity, digest);
+}
+
+// Records of other algorithms are dropped, their digests are not in the cache
+int HashIndexCompactIfMostlyReplaced(HashIndex* index, HashAlgorithm algorithm, const HashCache* cache) {
+    if (index->fd < 0 || index->record_count <= COMPACTION_MINIMUM_RECORDS ||
+        index->record_count <= HashCacheSize(cache) * COMPACTION_RECORD_FACTOR)
+        return 0;
+    if (!StartOver(index)) {
+        fprintf(stderr, "Unable to compact the hash index: %s\n", strerror(errno));
+        return 0;
+    }
+    CompactionContext context = {index, algorithm};
+    HashCacheVisit(cache, &AppendVisited, &context);
+    return 1;
+}
+
+size_t HashIndexLoad(HashIndex* index, HashAlgorithm algorithm, HashCache* cache) {
+    if (index->fd < 0)
+        return 0;
+
+    struct stat index_stat;
+    if (fstat(index->fd, &index_stat) != 0 || (size_t)index_stat.st_size <= sizeof(HashIndexHeader))
+        return 0;
+    const size_t mapping_size = index_stat.st_size;
+    const unsigned char* mapping = (const unsigned char*)mmap(NULL, mapping_size, PROT_READ, MAP_SHARED, index->fd, 0);
+    if (mapping == MAP_FAILED) {
+        fprintf(stderr, "Unable to map the hash index: %s\n", strerror(errno));
+        return 0;
+    }
+
+    char* path = (char*)malloc(UINT16_MAX + 1);
+    size_t loaded = 0;
+    size_t position = sizeof(HashIndexHeader);
+    HashIndexRecord record;
+    index->record_count = 0;
+    while (ReadRecord(mapping, mapping_size, position, &record)) {
+        if (record.algorithm == algorithm) {
+            memcpy(path, mapping + position + sizeof(HashIndexRecord), record.path_length);
+            path[record.path_length] = '\0';
+            const FileStatIdentity identity = {(dev_t)record.device, (ino_t)record.inode, (off_t)record.size,
+                                               record.mtime_ns, record.ctime_ns};
+            Digest digest;
+            digest.size = record.digest_size;
+            memcpy(digest.bytes, record.digest, record.digest_size);
+            HashCacheStore(cache, path, &identity, &digest);
+            ++loaded;
+        }
+        position += sizeof(HashIndexRecord) + record.path_length;
+        ++index->record_count;
+    }
+    free(path);
+    munmap((void*)mapping, mapping_size);
+
+    // Most likely the process stopped while appending, what remains can't be trusted
+    if (position < mapping_size) {
+        fprintf(stderr, "Ignoring the last %zu bytes of the hash index, they are not an intact record\n",
+                mapping_size - position);
+        if (ftruncate(index->fd, position) != 0)
+            fprintf(stderr, "Unable to truncate the hash index: %s\n", strerror(errno));
+    }
+
+    HashIndexCompactIfMostlyReplaced(index, algorithm, cache);
+    return loaded;
+}
+
+int HashIndexAppend(HashIndex* index, HashAlgorithm algorithm, const char* file, const FileStatIdentity* identity,
+                    const Digest* digest) {
+    const size_t path_length = strlen(file);
+    if (index->fd < 0 || path_length == 0 || path_length > UINT16_MAX || DigestIsEmpty(digest))
+        return 0;
+
+    HashIndexRecord record;
+    memset(&record, 0, sizeof(record));
+    record.path_length = (uint16_t)path_length;
+    record.algorithm = (uint8_t)algorithm;
+    record.digest_size = digest->size;
+    record.device = identity->device;
+    record.inode = identity->inode;
+    record.size = identity->size;
+    record.mtime_ns = identity->mtime_ns;
+    record.ctime_ns = identity->ctime_ns;
+    memcpy(record.digest, digest->bytes, digest->size);
+    record.checksum = RecordChecksum(&record, file);
+
+    // A single write, so that a record is never interleaved with another one
+    struct iovec parts[] = {{&record, sizeof(record)}, {(void*)file, path_length}};
+    if (writev(index->fd, parts, 2) != (ssize_t)(sizeof(record) + path_length)) {
+        fprintf(stderr, "Unable to append to the hash index: %s\n", strerror(errno));
+        return 0;
+    }
+    ++index->record_count;
+    return 1;
+}
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "Digest.h"
+#include "HashAlgorithm.h"
+#include "HashCache.h"
+
+// An append-only file of (path, stat identity, digest) records that outlives the process, so that after a restart
+// the files of a project description don't all have to be hashed again
+// Every record has a checksum, the index is truncated at the first record that is corrupt or incomplete
+// Stale records are harmless, the hash cache only uses a digest while the file's stat identity is unchanged
+// The index has a single writer: it is locked while it is open, another process can't open it until it is closed
+typedef struct HashIndex {
+    int fd;              // -1 when no index is used
+    size_t record_count; // Records in the file, including those that were replaced by later records
+} HashIndex;
+
+// Creates the file when it doesn't exist, a file that is not a hash index of this version is started over
+// Returns FALSE when the file can't be opened or is open elsewhere, the index is then not used but should still be
+// closed
+int HashIndexOpen(HashIndex*, const char* path);
+void HashIndexClose(HashIndex*);
+
+// Puts the digests of every intact record of the given algorithm in the cache, later records replace earlier ones
+// The index is compacted afterwards, see HashIndexCompactIfMostlyReplaced
+// Returns the amount of records that were put in the cache
+size_t HashIndexLoad(HashIndex*, HashAlgorithm, HashCache*);
+// Returns FALSE when the record could not be written
+int HashIndexAppend(HashIndex*, HashAlgorithm, const char* file, const FileStatIdentity*, const Digest*);
+// When most records were replaced, the file is rewritten with only the digests of the cache, so a running server that
+// keeps appending doesn't grow the index without limit. Rewriting costs as much as the records that were appended
+// since the index was last this small, so it is cheap enough to check after every append
+// Returns TRUE when the index was rewritten
+int HashIndexCompactIfMostlyReplaced(HashIndex*, HashAlgorithm, const HashCache*);
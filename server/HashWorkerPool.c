@@ -0,0 +1,188 @@
+#include "HashWorkerPool.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+typedef struct HashJob {
+    char* file;
+    int (*hashFile)(const char*, Digest*);
+    struct HashJob* next;
+} HashJob;
+
+typedef struct {
+    pthread_t* workers;
+    size_t worker_count;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t job_available;
+    int stopping;
+
+    // Queues are appended at the tail and taken from the head
+    HashJob *jobs_head, *jobs_tail;
+    HashJobResult *completed_head, *completed_tail;
+} HashWorkerPoolInternal;
+
+static char* CopyString(const char* string) {
+    const size_t length = strlen(string);
+    char* copy = (char*)malloc(length + 1);
+    memcpy(copy, string, length + 1);
+    return copy;
+}
+
+static HashJob* TakeJob(HashWorkerPoolInternal* internal) {
+    HashJob* job = internal->jobs_head;
+    internal->jobs_head = job->next;
+    if (!internal->jobs_head)
+        internal->jobs_tail = NULL;
+    return job;
+}
+
+static HashJobResult* DoJob(const HashJob* job) {
+    HashJobResult* result = (HashJobResult*)malloc(sizeof(HashJobResult));
+    result->file = CopyString(job->file);
+    result->hashFile = job->hashFile;
+    result->next = NULL;
+    result->identity_valid = FileStatIdentityRead(job->file, &result->identity);
+
+    job->hashFile(job->file, &result->digest);
+    return result;
+}
+
+static void SignalCompletion(HashWorkerPool* pool) {
+    const uint64_t completed = 1;
+    if (write(pool->fd, &completed, sizeof(completed)) != sizeof(completed))
+        fprintf(stderr, "Error signaling a completed hash job: %s\n", strerror(errno));
+}
+
+static void* WorkerMain(void* argument) {
+    HashWorkerPool* pool = (HashWorkerPool*)argument;
+    HashWorkerPoolInternal* internal = (HashWorkerPoolInternal*)pool->_internal;
+
+    pthread_mutex_lock(&internal->mutex);
+    for (;;) {
+        while (!internal->stopping && !internal->jobs_head)
+            pthread_cond_wait(&internal->job_available, &internal->mutex);
+        if (internal->stopping)
+            break;
+
+        HashJob* job = TakeJob(internal);
+        pthread_mutex_unlock(&internal->mutex);
+
+        HashJobResult* result = DoJob(job);
+        free(job->file);
+        free(job);
+
+        pthread_mutex_lock(&internal->mutex);
+        if (internal->completed_tail)
+            internal->completed_tail->next = result;
+        else
+            internal->completed_head = result;
+        internal->completed_tail = result;
+        SignalCompletion(pool);
+    }
+    pthread_mutex_unlock(&internal->mutex);
+    return NULL;
+}
+
+int HashWorkerPoolInit(HashWorkerPool* pool, size_t worker_count) {
+    HashWorkerPoolInternal* internal = (HashWorkerPoolInternal*)calloc(1, sizeof(HashWorkerPoolInternal));
+    pthread_mutex_init(&internal->mutex, NULL);
+    pthread_cond_init(&internal->job_available, NULL);
+    internal->workers = (pthread_t*)malloc(sizeof(pthread_t) * worker_count);
+    pool->_internal = internal;
+
+    errno = 0;
+    pool->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (pool->fd < 0) {
+        fprintf(stderr, "Unable to create an eventfd for hash workers: %s\n", strerror(errno));
+        return 0;
+    }
+
+    for (size_t i = 0; i < worker_count; ++i) {
+        if (pthread_create(&internal->workers[i], NULL, &WorkerMain, pool) != 0) {
+            fprintf(stderr, "Unable to start hash worker %zu\n", i);
+            return internal->worker_count > 0;
+        }
+        ++internal->worker_count;
+    }
+    return 1;
+}
+
+void HashWorkerPoolDeinit(HashWorkerPool* pool) {
+    HashWorkerPoolInternal* internal = (HashWorkerPoolInternal*)pool->_internal;
+    if (!internal)
+        return;
+
+    pthread_mutex_lock(&internal->mutex);
+    internal->stopping = 1;
+    pthread_cond_broadcast(&internal->job_available);
+    pthread_mutex_unlock(&internal->mutex);
+
+    for (size_t i = 0; i < internal->worker_count; ++i)
+        pthread_join(internal->workers[i], NULL);
+
+    while (internal->jobs_head) {
+        HashJob* job = TakeJob(internal);
+        free(job->file);
+        free(job);
+    }
+    HashJobResultFree(internal->completed_head);
+
+    pthread_cond_destroy(&internal->job_available);
+    pthread_mutex_destroy(&internal->mutex);
+    free(internal->workers);
+    free(internal);
+    pool->_internal = NULL;
+
+    if (pool->fd >= 0)
+        close(pool->fd);
+    pool->fd = -1;
+}
+
+void HashWorkerPoolSubmit(HashWorkerPool* pool, const char* file, int (*hashFile)(const char*, Digest*)) {
+    HashWorkerPoolInternal* internal = (HashWorkerPoolInternal*)pool->_internal;
+
+    HashJob* job = (HashJob*)malloc(sizeof(HashJob));
+    job->file = CopyString(file);
+    job->hashFile = hashFile;
+    job->next = NULL;
+
+    pthread_mutex_lock(&internal->mutex);
+    if (internal->jobs_tail)
+        internal->jobs_tail->next = job;
+    else
+        internal->jobs_head = job;
+    internal->jobs_tail = job;
+    pthread_cond_signal(&internal->job_available);
+    pthread_mutex_unlock(&internal->mutex);
+}
+
+HashJobResult* HashWorkerPoolTakeCompleted(HashWorkerPool* pool) {
+    HashWorkerPoolInternal* internal = (HashWorkerPoolInternal*)pool->_internal;
+
+    uint64_t completed_count;
+    if (read(pool->fd, &completed_count, sizeof(completed_count)) < 0 && errno != EAGAIN)
+        fprintf(stderr, "Error reading hash worker completions: %s\n", strerror(errno));
+
+    pthread_mutex_lock(&internal->mutex);
+    HashJobResult* completed = internal->completed_head;
+    internal->completed_head = NULL;
+    internal->completed_tail = NULL;
+    pthread_mutex_unlock(&internal->mutex);
+    return completed;
+}
+
+void HashJobResultFree(HashJobResult* result) {
+    while (result) {
+        HashJobResult* next = result->next;
+        free(result->file);
+        free(result);
+        result = next;
+    }
+}
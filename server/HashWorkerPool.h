@@ -0,0 +1,35 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "HashCache.h"
+
+typedef struct HashJobResult {
+    char* file;
+    Digest digest;             // Empty when the file could not be hashed
+    FileStatIdentity identity; // Read right before the file was hashed
+    int identity_valid;
+    int (*hashFile)(const char*, Digest*); // The function the file was hashed with
+    struct HashJobResult* next;
+} HashJobResult;
+
+// Hashes files on worker threads, so the caller doesn't block on big files
+typedef struct HashWorkerPool {
+    int fd; // An eventfd that becomes readable (POLLIN) when completed jobs are waiting
+    void* _internal;
+} HashWorkerPool;
+
+// Starts 'worker_count' threads
+// Returns FALSE when the pool could not be started, in that case it should still be deinitialized
+int HashWorkerPoolInit(HashWorkerPool*, size_t worker_count);
+// Stops the workers, jobs that did not complete yet are discarded
+void HashWorkerPoolDeinit(HashWorkerPool*);
+
+// The file is hashed with 'hashFile' (same contract as FileHasher_Do)
+void HashWorkerPoolSubmit(HashWorkerPool*, const char* file, int (*hashFile)(const char*, Digest*));
+
+// Returns the completed jobs in order of completion, or NULL when none completed since the last call
+// The result should be freed with HashJobResultFree
+HashJobResult* HashWorkerPoolTakeCompleted(HashWorkerPool*);
+// Frees the given result and every result after it
+void HashJobResultFree(HashJobResult*);
@@ -0,0 +1,67 @@
+#include "OutputBatcher.h"
+
+#include <string.h>
+
+#include "DynamicStringArray.h"
+
+void OutputBatcherInit(OutputBatcher* batcher, size_t batch_size, long long delay_ms) {
+    batcher->batch_size = batch_size > 0 ? batch_size : 1;
+    batcher->delay_ms = delay_ms;
+    DynamicBufferInit(&batcher->pending);
+    batcher->oldest_pending_ms = 0;
+}
+
+void OutputBatcherDeinit(OutputBatcher* batcher) { DynamicBufferDeinit(&batcher->pending); }
+
+void OutputBatcherAppend(OutputBatcher* batcher, const char* data, size_t data_size, long long now_ms) {
+    if (data_size == 0)
+        return;
+    if (batcher->pending.size == 0)
+        batcher->oldest_pending_ms = now_ms;
+    DynamicBufferAppend(&batcher->pending, data, data_size);
+}
+
+static void TakeBatch(OutputBatcher* batcher, size_t batch_size, DynamicStringArray* batches) {
+    // The byte after the batch is swapped for a terminator while the batch is copied, that saves copying it twice
+    DynamicBufferReserve(&batcher->pending, 1);
+    char* batch = batcher->pending.data;
+    const char following = batch[batch_size];
+    batch[batch_size] = '\0';
+    DynamicStringArrayAppend(batches, batch);
+    batch[batch_size] = following;
+    DynamicBufferTrimLeft(&batcher->pending, batch_size);
+}
+
+// A line that is longer than a batch is split
+static size_t FullBatchSize(const OutputBatcher* batcher) {
+    const char* data = batcher->pending.data;
+    for (size_t size = batcher->batch_size; size > 0; --size) {
+        if (data[size - 1] == '\n')
+            return size;
+    }
+    return batcher->batch_size;
+}
+
+void OutputBatcherTakeDue(OutputBatcher* batcher, long long now_ms, DynamicStringArray* batches) {
+    // The bytes that are left arrived after the oldest one, so the delay is still counted from it
+    while (batcher->pending.size >= batcher->batch_size)
+        TakeBatch(batcher, FullBatchSize(batcher), batches);
+    if (batcher->pending.size > 0 && now_ms - batcher->oldest_pending_ms >= batcher->delay_ms)
+        TakeBatch(batcher, batcher->pending.size, batches);
+}
+
+void OutputBatcherTakeAll(OutputBatcher* batcher, DynamicStringArray* batches) {
+    while (batcher->pending.size >= batcher->batch_size)
+        TakeBatch(batcher, FullBatchSize(batcher), batches);
+    if (batcher->pending.size > 0)
+        TakeBatch(batcher, batcher->pending.size, batches);
+}
+
+long long OutputBatcherTimeUntilDue(const OutputBatcher* batcher, long long now_ms) {
+    if (batcher->pending.size == 0)
+        return -1;
+    if (batcher->pending.size >= batcher->batch_size)
+        return 0;
+    const long long time_until_due = batcher->oldest_pending_ms + batcher->delay_ms - now_ms;
+    return time_until_due > 0 ? time_until_due : 0;
+}
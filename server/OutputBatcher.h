@@ -0,0 +1,30 @@
+#pragma once
+
+#include <stddef.h>
+
+#include "DynamicBuffer.h"
+
+typedef struct DynamicStringArray DynamicStringArray;
+
+// Collects the output of a stream until a batch of 'batch_size' bytes arrived or the oldest byte waited for 'delay_ms',
+// so a stream that prints a lot is broadcasted in a few large messages instead of one message per read
+// A full batch ends after its last complete line, the partial line waits for the rest of it. A batch that is due
+// because of the delay is taken as a whole, so output never waits longer than the delay
+typedef struct OutputBatcher {
+    size_t batch_size;
+    long long delay_ms;
+    DynamicBuffer pending;
+    long long oldest_pending_ms; // When the first of the pending bytes arrived
+} OutputBatcher;
+
+void OutputBatcherInit(OutputBatcher*, size_t batch_size, long long delay_ms);
+void OutputBatcherDeinit(OutputBatcher*);
+
+void OutputBatcherAppend(OutputBatcher*, const char* data, size_t data_size, long long now_ms);
+
+// Moves the batches that are due into the output argument, which must be initialized and will be owned by the caller
+void OutputBatcherTakeDue(OutputBatcher*, long long now_ms, DynamicStringArray* batches);
+// Moves every pending byte into the output argument, for a stream that was closed
+void OutputBatcherTakeAll(OutputBatcher*, DynamicStringArray* batches);
+// Returns -1 when nothing is pending, otherwise the amount of milliseconds until the pending bytes are due
+long long OutputBatcherTimeUntilDue(const OutputBatcher*, long long now_ms);
@@ -0,0 +1,118 @@
+#include "PathIndex.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define PATH_INDEX_INITIAL_CAPACITY 16
+
+struct PathIndexSlot {
+    const char* path; // NULL for an empty slot
+    uint64_t hash;
+    size_t position;
+};
+
+// FNV-1a, paths are short so there is little to gain from a hash that processes more bytes at a time
+static uint64_t HashPath(const char* path) {
+    uint64_t hash = 14695981039346656037ULL;
+    for (const unsigned char* character = (const unsigned char*)path; *character; ++character) {
+        hash ^= *character;
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+static PathIndexSlot* AllocateSlots(size_t capacity) {
+    return (PathIndexSlot*)calloc(capacity, sizeof(PathIndexSlot));
+}
+
+void PathIndexInit(PathIndex* index) {
+    index->size = 0;
+    index->capacity = PATH_INDEX_INITIAL_CAPACITY;
+    index->slots = AllocateSlots(index->capacity);
+}
+
+void PathIndexDeinit(PathIndex* index) {
+    free(index->slots);
+    index->slots = NULL;
+    index->size = 0;
+    index->capacity = 0;
+}
+
+void PathIndexClear(PathIndex* index) {
+    memset(index->slots, 0, index->capacity * sizeof(PathIndexSlot));
+    index->size = 0;
+}
+
+// Returns the slot of the path, or the empty slot where it would be inserted
+static size_t FindSlot(const PathIndex* index, const char* path, uint64_t hash) {
+    const size_t mask = index->capacity - 1;
+    size_t at = (size_t)hash & mask;
+    while (index->slots[at].path) {
+        if (index->slots[at].hash == hash && strcmp(index->slots[at].path, path) == 0)
+            return at;
+        at = (at + 1) & mask;
+    }
+    return at;
+}
+
+size_t PathIndexFind(const PathIndex* index, const char* path) {
+    const size_t at = FindSlot(index, path, HashPath(path));
+    return index->slots[at].path ? index->slots[at].position : PATH_INDEX_NOT_FOUND;
+}
+
+static void Grow(PathIndex* index) {
+    PathIndexSlot* old_slots = index->slots;
+    const size_t old_capacity = index->capacity;
+    index->capacity *= 2;
+    index->slots = AllocateSlots(index->capacity);
+    for (size_t i = 0; i < old_capacity; ++i) {
+        if (old_slots[i].path)
+            index->slots[FindSlot(index, old_slots[i].path, old_slots[i].hash)] = old_slots[i];
+    }
+    free(old_slots);
+}
+
+void PathIndexInsert(PathIndex* index, const char* path, size_t position) {
+    // At most three quarters full, so that probe sequences stay short
+    if ((index->size + 1) * 4 > index->capacity * 3)
+        Grow(index);
+
+    const uint64_t hash = HashPath(path);
+    const size_t at = FindSlot(index, path, hash);
+    if (!index->slots[at].path) {
+        index->slots[at].hash = hash;
+        ++index->size;
+    }
+    // The caller's copy of the path replaces an equal one that might be freed
+    index->slots[at].path = path;
+    index->slots[at].position = position;
+}
+
+// Whether 'home' lies cyclically in (empty, at]
+static int HomeIsBetween(size_t empty, size_t home, size_t at) {
+    if (empty <= at)
+        return empty < home && home <= at;
+    return empty < home || home <= at;
+}
+
+void PathIndexErase(PathIndex* index, const char* path) {
+    const size_t mask = index->capacity - 1;
+    size_t empty = FindSlot(index, path, HashPath(path));
+    if (!index->slots[empty].path)
+        return;
+    --index->size;
+
+    // Moves later slots of the probe sequence back, so that no tombstones are needed
+    size_t at = empty;
+    for (;;) {
+        index->slots[empty].path = NULL;
+        do {
+            at = (at + 1) & mask;
+            if (!index->slots[at].path)
+                return;
+        } while (HomeIsBetween(empty, (size_t)index->slots[at].hash & mask, at));
+        index->slots[empty] = index->slots[at];
+        empty = at;
+    }
+}
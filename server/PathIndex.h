@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+
+#define PATH_INDEX_NOT_FOUND ((size_t)-1)
+
+typedef struct PathIndexSlot PathIndexSlot;
+
+// Finds the position of a path in an array that is owned by the caller, with an open addressing hash table
+// The paths are not copied, they have to stay valid until they are erased or the index is cleared
+typedef struct PathIndex {
+    PathIndexSlot* slots;
+    size_t size;
+    size_t capacity; // Always a power of two
+} PathIndex;
+
+void PathIndexInit(PathIndex*);
+void PathIndexDeinit(PathIndex*);
+void PathIndexClear(PathIndex*);
+
+// Returns PATH_INDEX_NOT_FOUND when the path was not inserted
+size_t PathIndexFind(const PathIndex*, const char* path);
+// Replaces the position when the path was already inserted
+void PathIndexInsert(PathIndex*, const char* path, size_t position);
+void PathIndexErase(PathIndex*, const char* path);
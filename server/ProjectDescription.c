@@ -18,6 +18,9 @@ void ProjectDescriptionInit(ProjectDescription* project_description, const char*
     DynamicStringArrayInit(&project_description->link_dependencies_for_executable);
     DynamicStringArrayInit(&project_description->link_dependencies_for_executable_hashes);
     DynamicStringArrayInit(&project_description->executable_arguments);
+    project_description->hash_algorithm = HASH_ALGORITHM_SHA1;
+    project_description->executable_size = -1;
+    DynamicFileSizeArrayInit(&project_description->link_dependencies_for_executable_sizes);
 }
 
 void ProjectDescriptionDeinit(ProjectDescription* project_description) {
@@ -26,6 +29,7 @@ void ProjectDescriptionDeinit(ProjectDescription* project_description) {
     DynamicStringArrayDeinit(&project_description->link_dependencies_for_executable);
     DynamicStringArrayDeinit(&project_description->link_dependencies_for_executable_hashes);
     DynamicStringArrayDeinit(&project_description->executable_arguments);
+    DynamicFileSizeArrayDeinit(&project_description->link_dependencies_for_executable_sizes);
 }
 
 void ProjectDescriptionCopy(const ProjectDescription* source, ProjectDescription* dest) {
@@ -33,8 +37,26 @@ void ProjectDescriptionCopy(const ProjectDescription* source, ProjectDescription
     strcpy(dest->executable_name, source->executable_name);
     dest->executable_hash = (char*)malloc(strlen(source->executable_hash) + 1);
     strcpy(dest->executable_hash, source->executable_hash);
-    DynamicStringArrayCopy(&source->executable_arguments, &dest->executable_arguments);
-    DynamicStringArrayCopy(&source->link_dependencies_for_executable, &dest->link_dependencies_for_executable);
-    DynamicStringArrayCopy(&source->link_dependencies_for_executable_hashes,
-                           &dest->link_dependencies_for_executable_hashes);
+    // The copy is usually kept while the source is thrown away, so the strings are shared instead of copied
+    DynamicStringArrayShare(&source->executable_arguments, &dest->executable_arguments);
+    DynamicStringArrayShare(&source->link_dependencies_for_executable, &dest->link_dependencies_for_executable);
+    DynamicStringArrayShare(&source->link_dependencies_for_executable_hashes,
+                            &dest->link_dependencies_for_executable_hashes);
+    dest->hash_algorithm = source->hash_algorithm;
+    dest->executable_size = source->executable_size;
+    DynamicFileSizeArrayCopy(&source->link_dependencies_for_executable_sizes,
+                             &dest->link_dependencies_for_executable_sizes);
+}
+
+int ProjectDescriptionEqual(const ProjectDescription* first, const ProjectDescription* second) {
+    return strcmp(first->executable_name, second->executable_name) == 0 &&
+           strcmp(first->executable_hash, second->executable_hash) == 0 &&
+           first->hash_algorithm == second->hash_algorithm && first->executable_size == second->executable_size &&
+           DynamicStringArrayEqual(&first->executable_arguments, &second->executable_arguments) &&
+           DynamicStringArrayEqual(&first->link_dependencies_for_executable,
+                                   &second->link_dependencies_for_executable) &&
+           DynamicStringArrayEqual(&first->link_dependencies_for_executable_hashes,
+                                   &second->link_dependencies_for_executable_hashes) &&
+           DynamicFileSizeArrayEqual(&first->link_dependencies_for_executable_sizes,
+                                     &second->link_dependencies_for_executable_sizes);
 }
@@ -1,6 +1,8 @@
 #pragma once
 
+#include "DynamicFileSizeArray.h"
 #include "DynamicStringArray.h"
+#include "HashAlgorithm.h"
 
 typedef struct ProjectDescription {
     char* executable_name;
@@ -8,8 +10,15 @@ typedef struct ProjectDescription {
     DynamicStringArray link_dependencies_for_executable;
     DynamicStringArray link_dependencies_for_executable_hashes;
     DynamicStringArray executable_arguments;
+    HashAlgorithm hash_algorithm; // The algorithm used for all of the hashes above
+    // Optional, a file whose size differs doesn't need to be hashed to know that it doesn't match
+    long long executable_size; // -1 when unknown
+    // Either empty or one size per link dependency, -1 for a size that is unknown
+    DynamicFileSizeArray link_dependencies_for_executable_sizes;
 } ProjectDescription;
 
+// The hash algorithm is HASH_ALGORITHM_SHA1, the sizes are unknown
 void ProjectDescriptionInit(ProjectDescription*, const char* executable_name, const char* executable_hash);
 void ProjectDescriptionDeinit(ProjectDescription*);
-void ProjectDescriptionCopy(const ProjectDescription* source, ProjectDescription* dest);
\ No newline at end of file
+void ProjectDescriptionCopy(const ProjectDescription* source, ProjectDescription* dest);
+int ProjectDescriptionEqual(const ProjectDescription*, const ProjectDescription*);
\ No newline at end of file
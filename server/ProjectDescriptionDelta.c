@@ -0,0 +1,128 @@
+#include "ProjectDescriptionDelta.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "PathIndex.h"
+#include "ProjectDescription.h"
+
+static char* CopyString(const char* string) {
+    char* copy = (char*)malloc(strlen(string) + 1);
+    strcpy(copy, string);
+    return copy;
+}
+
+void ProjectDescriptionDeltaInit(ProjectDescriptionDelta* delta, ProjectDescriptionDeltaType type,
+                                 unsigned long long generation) {
+    delta->type = type;
+    delta->generation = generation;
+    DynamicStringArrayInit(&delta->files);
+    DynamicStringArrayInit(&delta->hashes);
+    DynamicFileSizeArrayInit(&delta->sizes);
+    delta->executable_name = NULL;
+    delta->executable_hash = NULL;
+    delta->executable_size = -1;
+    DynamicStringArrayInit(&delta->executable_arguments);
+}
+
+void ProjectDescriptionDeltaDeinit(ProjectDescriptionDelta* delta) {
+    DynamicStringArrayDeinit(&delta->files);
+    DynamicStringArrayDeinit(&delta->hashes);
+    DynamicFileSizeArrayDeinit(&delta->sizes);
+    free(delta->executable_name);
+    free(delta->executable_hash);
+    DynamicStringArrayDeinit(&delta->executable_arguments);
+}
+
+void ProjectDescriptionDeltaSetExecutable(ProjectDescriptionDelta* delta, const char* executable_name,
+                                          const char* executable_hash, long long executable_size) {
+    free(delta->executable_name);
+    free(delta->executable_hash);
+    delta->executable_name = CopyString(executable_name);
+    delta->executable_hash = CopyString(executable_hash);
+    delta->executable_size = executable_size;
+}
+
+static void ApplySetExecutable(const ProjectDescription* base, const ProjectDescriptionDelta* delta,
+                               ProjectDescription* result) {
+    // The link dependencies are shared with the base, only the executable is replaced
+    ProjectDescriptionCopy(base, result);
+    free(result->executable_name);
+    free(result->executable_hash);
+    result->executable_name = CopyString(delta->executable_name ? delta->executable_name : "");
+    result->executable_hash = CopyString(delta->executable_hash ? delta->executable_hash : "");
+    result->executable_size = delta->executable_size;
+    DynamicStringArrayClear(&result->executable_arguments);
+    DynamicStringArrayAppendArray(&result->executable_arguments, &delta->executable_arguments);
+}
+
+static void AppendLinkDependency(ProjectDescription* result, const char* file, const char* hash, long long size,
+                                 int with_sizes) {
+    DynamicStringArrayAppend(&result->link_dependencies_for_executable, file);
+    DynamicStringArrayAppend(&result->link_dependencies_for_executable_hashes, hash);
+    if (with_sizes)
+        DynamicFileSizeArrayAppend(&result->link_dependencies_for_executable_sizes, size);
+}
+
+static int HasKnownSize(const DynamicFileSizeArray* sizes) {
+    for (size_t i = 0; i < sizes->size; ++i) {
+        if (sizes->data[i] >= 0)
+            return 1;
+    }
+    return 0;
+}
+
+// A single pass over the base, the files of the delta are looked up in an index
+static void ApplyEntries(const ProjectDescription* base, const ProjectDescriptionDelta* delta,
+                         ProjectDescription* result) {
+    const DynamicStringArray* dependencies = &base->link_dependencies_for_executable;
+    const DynamicStringArray* hashes = &base->link_dependencies_for_executable_hashes;
+    const DynamicFileSizeArray* sizes = &base->link_dependencies_for_executable_sizes;
+    const int upsert = delta->type == PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES;
+
+    ProjectDescriptionInit(result, base->executable_name, base->executable_hash);
+    result->hash_algorithm = base->hash_algorithm;
+    result->executable_size = base->executable_size;
+    DynamicStringArrayAppendArray(&result->executable_arguments, &base->executable_arguments);
+    // Sizes are kept for every file as soon as one file has a size
+    const int base_has_sizes = sizes->size == dependencies->size && sizes->size > 0;
+    const int with_sizes = base_has_sizes || (upsert && HasKnownSize(&delta->sizes));
+
+    // A file that is in the delta more than once is found at its last position
+    PathIndex delta_files;
+    PathIndexInit(&delta_files);
+    for (size_t i = 0; i < delta->files.size; ++i)
+        PathIndexInsert(&delta_files, delta->files.data[i], i);
+    char* upserted = (char*)calloc(delta->files.size > 0 ? delta->files.size : 1, sizeof(char));
+
+    for (size_t i = 0; i < dependencies->size; ++i) {
+        const size_t position = PathIndexFind(&delta_files, dependencies->data[i]);
+        if (position == PATH_INDEX_NOT_FOUND) {
+            // The JSON allows fewer hashes than files, the result has a hash for every file
+            AppendLinkDependency(result, dependencies->data[i], i < hashes->size ? hashes->data[i] : "",
+                                 base_has_sizes ? sizes->data[i] : -1, with_sizes);
+        } else if (upsert && !upserted[position]) {
+            AppendLinkDependency(result, dependencies->data[i],
+                                 position < delta->hashes.size ? delta->hashes.data[position] : "",
+                                 position < delta->sizes.size ? delta->sizes.data[position] : -1, with_sizes);
+            upserted[position] = 1;
+        }
+    }
+
+    for (size_t i = 0; i < delta->files.size && upsert; ++i) {
+        if (upserted[i] || PathIndexFind(&delta_files, delta->files.data[i]) != i)
+            continue;
+        AppendLinkDependency(result, delta->files.data[i], i < delta->hashes.size ? delta->hashes.data[i] : "",
+                             i < delta->sizes.size ? delta->sizes.data[i] : -1, with_sizes);
+    }
+    free(upserted);
+    PathIndexDeinit(&delta_files);
+}
+
+void ProjectDescriptionApplyDelta(const ProjectDescription* base, const ProjectDescriptionDelta* delta,
+                                  ProjectDescription* result) {
+    if (delta->type == PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE)
+        ApplySetExecutable(base, delta, result);
+    else
+        ApplyEntries(base, delta, result);
+}
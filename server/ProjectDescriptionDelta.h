@@ -0,0 +1,37 @@
+#pragma once
+
+#include "DynamicFileSizeArray.h"
+#include "DynamicStringArray.h"
+
+typedef struct ProjectDescription ProjectDescription;
+
+typedef enum ProjectDescriptionDeltaType {
+    PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES, // Link dependencies are added, or replaced with a new hash and size
+    PROJECT_DESCRIPTION_DELTA_REMOVE_ENTRIES,
+    PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE // The executable, its hash, its size and its arguments are replaced
+} ProjectDescriptionDeltaType;
+
+// A change to the current project description, so that a small change doesn't need the whole description
+// Every delta increases the generation by one, a full project description starts again at generation 0
+typedef struct ProjectDescriptionDelta {
+    ProjectDescriptionDeltaType type;
+    unsigned long long generation; // Of the description that results from applying the delta
+    DynamicStringArray files;      // The link dependencies that are upserted or removed
+    DynamicStringArray hashes;     // One per upserted file
+    DynamicFileSizeArray sizes;    // One per upserted file, -1 for a size that is unknown
+    char* executable_name;         // Only set by SET_EXECUTABLE, NULL otherwise
+    char* executable_hash;
+    long long executable_size;
+    DynamicStringArray executable_arguments;
+} ProjectDescriptionDelta;
+
+void ProjectDescriptionDeltaInit(ProjectDescriptionDelta*, ProjectDescriptionDeltaType, unsigned long long generation);
+void ProjectDescriptionDeltaDeinit(ProjectDescriptionDelta*);
+// The strings are copied
+void ProjectDescriptionDeltaSetExecutable(ProjectDescriptionDelta*, const char* executable_name,
+                                          const char* executable_hash, long long executable_size);
+
+// 'result' is initialized as 'base' with the delta applied, the generation is not checked
+// The link dependencies keep their order, upserted files that are new are appended, removing an unknown file is a no-op
+void ProjectDescriptionApplyDelta(const ProjectDescription* base, const ProjectDescriptionDelta*,
+                                  ProjectDescription* result);
@@ -0,0 +1,421 @@
+#include "ProjectDescription_binary.h"
+
+#include <limits.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "Digest.h"
+#include "DynamicBuffer.h"
+#include "PathIndex.h"
+#include "ProjectDescription.h"
+#include "ProjectDescriptionDelta.h"
+
+#define MAXIMAL_VARINT_SIZE 10
+
+typedef struct {
+    const uint8_t* data;
+    size_t size, position;
+    int failed; // Every read after a failed one fails as well, so the result only has to be checked at the end
+} Reader;
+
+static uint64_t ReadVarint(Reader* reader) {
+    uint64_t value = 0;
+    for (int i = 0; i < MAXIMAL_VARINT_SIZE && !reader->failed && reader->position < reader->size; ++i) {
+        const uint8_t byte = reader->data[reader->position++];
+        value |= (uint64_t)(byte & 0x7f) << (7 * i);
+        if (!(byte & 0x80))
+            return value;
+    }
+    reader->failed = 1;
+    return 0;
+}
+
+static uint8_t ReadByte(Reader* reader) {
+    if (reader->failed || reader->position >= reader->size) {
+        reader->failed = 1;
+        return 0;
+    }
+    return reader->data[reader->position++];
+}
+
+// The string points into the data, strings with a '\0' are refused since they are used as C strings later on
+static const char* ReadString(Reader* reader, size_t* length) {
+    *length = (size_t)ReadVarint(reader);
+    if (reader->failed || *length > reader->size - reader->position ||
+        memchr(&reader->data[reader->position], '\0', *length)) {
+        reader->failed = 1;
+        *length = 0;
+        return "";
+    }
+    const char* string = (const char*)&reader->data[reader->position];
+    reader->position += *length;
+    return string;
+}
+
+static void ReadDigestAsHex(Reader* reader, char* hex) {
+    Digest digest;
+    digest.size = ReadByte(reader);
+    if (reader->failed || digest.size > DIGEST_MAX_SIZE || digest.size > reader->size - reader->position) {
+        reader->failed = 1;
+        digest.size = 0;
+    }
+    memcpy(digest.bytes, &reader->data[reader->position], digest.size);
+    reader->position += digest.size;
+    DigestToHex(&digest, hex);
+}
+
+static long long ReadFileSize(Reader* reader) {
+    const uint64_t size_plus_one = ReadVarint(reader);
+    if (size_plus_one == 0 || size_plus_one - 1 > (uint64_t)LLONG_MAX)
+        return -1;
+    return (long long)(size_plus_one - 1);
+}
+
+typedef struct {
+    const char* string;
+    size_t length;
+} Prefix;
+
+// Writes the path into 'path' as a C string, 'path' is reused for every path
+static void ReadPath(Reader* reader, const Prefix* prefixes, size_t prefix_count, DynamicBuffer* path) {
+    const uint64_t prefix_index = ReadVarint(reader);
+    size_t rest_length;
+    const char* rest = ReadString(reader, &rest_length);
+    DynamicBufferTrimLeft(path, path->size);
+    if (prefix_index >= prefix_count) {
+        reader->failed = 1;
+        DynamicBufferAppend(path, "", 1);
+        return;
+    }
+    DynamicBufferAppend(path, prefixes[prefix_index].string, prefixes[prefix_index].length);
+    DynamicBufferAppend(path, rest, rest_length);
+    DynamicBufferAppend(path, "", 1);
+}
+
+// Every count is at most the amount of bytes that are left, each item takes at least one byte
+static size_t ReadCount(Reader* reader) {
+    const uint64_t count = ReadVarint(reader);
+    if (count > reader->size - reader->position) {
+        reader->failed = 1;
+        return 0;
+    }
+    return (size_t)count;
+}
+
+static void ReadLinkDependencies(Reader* reader, const Prefix* prefixes, size_t prefix_count, int with_sizes,
+                                 DynamicBuffer* path, ProjectDescription* project_description) {
+    const size_t count = ReadCount(reader);
+    char hex[DIGEST_HEX_BUFFER_SIZE];
+    for (size_t i = 0; i < count && !reader->failed; ++i) {
+        ReadPath(reader, prefixes, prefix_count, path);
+        ReadDigestAsHex(reader, hex);
+        DynamicStringArrayAppend(&project_description->link_dependencies_for_executable, path->data);
+        DynamicStringArrayAppend(&project_description->link_dependencies_for_executable_hashes, hex);
+        if (with_sizes)
+            DynamicFileSizeArrayAppend(&project_description->link_dependencies_for_executable_sizes,
+                                       ReadFileSize(reader));
+    }
+}
+
+// Writes the string into 'buffer' as a C string, 'buffer' is reused for every string
+static void ReadCString(Reader* reader, DynamicBuffer* buffer) {
+    size_t length;
+    const char* string = ReadString(reader, &length);
+    DynamicBufferTrimLeft(buffer, buffer->size);
+    DynamicBufferAppend(buffer, string, length);
+    DynamicBufferAppend(buffer, "", 1);
+}
+
+static void ReadArguments(Reader* reader, DynamicBuffer* argument, DynamicStringArray* arguments) {
+    const size_t count = ReadCount(reader);
+    for (size_t i = 0; i < count && !reader->failed; ++i) {
+        ReadCString(reader, argument);
+        DynamicStringArrayAppend(arguments, argument->data);
+    }
+}
+
+int ProjectDescriptionLoadFromBinary(const uint8_t* data, size_t size, ProjectDescription* project_description) {
+    Reader reader = {data, size, 0, 0};
+    if (ReadByte(&reader) != PROJECT_DESCRIPTION_BINARY_FORMAT_VERSION)
+        return 0;
+    const uint8_t hash_algorithm = ReadByte(&reader);
+    const uint8_t flags = ReadByte(&reader);
+    if (reader.failed || hash_algorithm >= HASH_ALGORITHM_COUNT)
+        return 0;
+
+    const size_t prefix_count = ReadCount(&reader);
+    Prefix* prefixes = (Prefix*)malloc((prefix_count > 0 ? prefix_count : 1) * sizeof(Prefix));
+    for (size_t i = 0; i < prefix_count; ++i)
+        prefixes[i].string = ReadString(&reader, &prefixes[i].length);
+
+    DynamicBuffer path;
+    DynamicBufferInit(&path);
+    char executable_hash[DIGEST_HEX_BUFFER_SIZE];
+    ReadPath(&reader, prefixes, prefix_count, &path);
+    ReadDigestAsHex(&reader, executable_hash);
+    const long long executable_size = ReadFileSize(&reader);
+    if (reader.failed) {
+        DynamicBufferDeinit(&path);
+        free(prefixes);
+        return 0;
+    }
+
+    ProjectDescriptionInit(project_description, path.data, executable_hash);
+    project_description->hash_algorithm = (HashAlgorithm)hash_algorithm;
+    project_description->executable_size = executable_size;
+    ReadLinkDependencies(&reader, prefixes, prefix_count, flags & PROJECT_DESCRIPTION_BINARY_FLAG_LINK_DEPENDENCY_SIZES,
+                         &path, project_description);
+    ReadArguments(&reader, &path, &project_description->executable_arguments);
+    DynamicBufferDeinit(&path);
+    free(prefixes);
+
+    // Trailing bytes are refused as well, they would mean that the encoder and the decoder disagree
+    if (reader.failed || reader.position != reader.size) {
+        ProjectDescriptionDeinit(project_description);
+        return 0;
+    }
+    return 1;
+}
+
+static void WriteVarint(DynamicBuffer* buffer, uint64_t value) {
+    uint8_t bytes[MAXIMAL_VARINT_SIZE];
+    size_t size = 0;
+    do {
+        bytes[size] = value & 0x7f;
+        value >>= 7;
+        if (value)
+            bytes[size] |= 0x80;
+        ++size;
+    } while (value);
+    DynamicBufferAppend(buffer, (const char*)bytes, size);
+}
+
+static void WriteByte(DynamicBuffer* buffer, uint8_t byte) { DynamicBufferAppend(buffer, (const char*)&byte, 1); }
+
+static void WriteString(DynamicBuffer* buffer, const char* string, size_t length) {
+    WriteVarint(buffer, length);
+    DynamicBufferAppend(buffer, string, length);
+}
+
+// Returns FALSE when the hash is not hexadecimal
+static int WriteDigest(DynamicBuffer* buffer, const char* hex) {
+    Digest digest;
+    if (hex[0] != '\0' && !DigestFromHex(hex, &digest))
+        return 0;
+    if (hex[0] == '\0')
+        DigestClear(&digest);
+    WriteByte(buffer, digest.size);
+    DynamicBufferAppend(buffer, (const char*)digest.bytes, digest.size);
+    return 1;
+}
+
+static void WriteFileSize(DynamicBuffer* buffer, long long size) { WriteVarint(buffer, size < 0 ? 0 : size + 1); }
+
+// The directory of a path, including the last '/'
+static size_t PrefixLength(const char* path) {
+    const char* last_separator = strrchr(path, '/');
+    return last_separator ? (size_t)(last_separator - path) + 1 : 0;
+}
+
+// Every path refers to the prefix table by index, the first path with a directory adds that directory to the table
+typedef struct {
+    DynamicStringArray directories; // The directory of every path, in the order of the paths
+    size_t* prefix_indexes;         // The index in the prefix table of every path
+    size_t* table;                  // The index in 'directories' of every prefix
+    size_t table_size;
+} PrefixTable;
+
+static void MakePrefixTable(PrefixTable* prefix_table, const ProjectDescription* project_description) {
+    const DynamicStringArray* dependencies = &project_description->link_dependencies_for_executable;
+    const size_t path_count = dependencies->size + 1;
+    DynamicStringArrayInit(&prefix_table->directories);
+    DynamicBuffer directory;
+    DynamicBufferInit(&directory);
+    for (size_t i = 0; i < path_count; ++i) {
+        const char* path = i == 0 ? project_description->executable_name : dependencies->data[i - 1];
+        DynamicBufferTrimLeft(&directory, directory.size);
+        DynamicBufferAppend(&directory, path, PrefixLength(path));
+        DynamicBufferAppend(&directory, "", 1);
+        DynamicStringArrayAppend(&prefix_table->directories, directory.data);
+    }
+    DynamicBufferDeinit(&directory);
+
+    // The directories don't move anymore, so they can be indexed
+    PathIndex index;
+    PathIndexInit(&index);
+    prefix_table->prefix_indexes = (size_t*)malloc(path_count * sizeof(size_t));
+    prefix_table->table = (size_t*)malloc(path_count * sizeof(size_t));
+    prefix_table->table_size = 0;
+    for (size_t i = 0; i < path_count; ++i) {
+        const size_t prefix_index = PathIndexFind(&index, prefix_table->directories.data[i]);
+        if (prefix_index != PATH_INDEX_NOT_FOUND) {
+            prefix_table->prefix_indexes[i] = prefix_index;
+            continue;
+        }
+        PathIndexInsert(&index, prefix_table->directories.data[i], prefix_table->table_size);
+        prefix_table->prefix_indexes[i] = prefix_table->table_size;
+        prefix_table->table[prefix_table->table_size++] = i;
+    }
+    PathIndexDeinit(&index);
+}
+
+static void FreePrefixTable(PrefixTable* prefix_table) {
+    DynamicStringArrayDeinit(&prefix_table->directories);
+    free(prefix_table->prefix_indexes);
+    free(prefix_table->table);
+}
+
+static void WritePath(DynamicBuffer* buffer, const PrefixTable* prefix_table, size_t path_index, const char* path) {
+    const size_t prefix_length = PrefixLength(path);
+    WriteVarint(buffer, prefix_table->prefix_indexes[path_index]);
+    WriteString(buffer, path + prefix_length, strlen(path + prefix_length));
+}
+
+int ProjectDescriptionDumpToBinary(const ProjectDescription* project_description, uint8_t** data, size_t* size) {
+    const DynamicStringArray* dependencies = &project_description->link_dependencies_for_executable;
+    const DynamicStringArray* hashes = &project_description->link_dependencies_for_executable_hashes;
+    const DynamicFileSizeArray* sizes = &project_description->link_dependencies_for_executable_sizes;
+    // The JSON allows fewer hashes than files, the binary format has a hash for every file
+    if (hashes->size != dependencies->size)
+        return 0;
+    const int with_sizes = sizes->size == dependencies->size && sizes->size > 0;
+
+    PrefixTable prefix_table;
+    MakePrefixTable(&prefix_table, project_description);
+
+    DynamicBuffer buffer;
+    DynamicBufferInit(&buffer);
+    WriteByte(&buffer, PROJECT_DESCRIPTION_BINARY_FORMAT_VERSION);
+    WriteByte(&buffer, (uint8_t)project_description->hash_algorithm);
+    WriteByte(&buffer, with_sizes ? PROJECT_DESCRIPTION_BINARY_FLAG_LINK_DEPENDENCY_SIZES : 0);
+
+    WriteVarint(&buffer, prefix_table.table_size);
+    for (size_t i = 0; i < prefix_table.table_size; ++i) {
+        const char* directory = prefix_table.directories.data[prefix_table.table[i]];
+        WriteString(&buffer, directory, strlen(directory));
+    }
+
+    WritePath(&buffer, &prefix_table, 0, project_description->executable_name);
+    int valid = WriteDigest(&buffer, project_description->executable_hash);
+    WriteFileSize(&buffer, project_description->executable_size);
+
+    WriteVarint(&buffer, dependencies->size);
+    for (size_t i = 0; i < dependencies->size && valid; ++i) {
+        WritePath(&buffer, &prefix_table, i + 1, dependencies->data[i]);
+        valid = WriteDigest(&buffer, hashes->data[i]);
+        if (with_sizes)
+            WriteFileSize(&buffer, sizes->data[i]);
+    }
+
+    const DynamicStringArray* arguments = &project_description->executable_arguments;
+    WriteVarint(&buffer, arguments->size);
+    for (size_t i = 0; i < arguments->size; ++i)
+        WriteString(&buffer, arguments->data[i], strlen(arguments->data[i]));
+    FreePrefixTable(&prefix_table);
+
+    if (!valid) {
+        DynamicBufferDeinit(&buffer);
+        return 0;
+    }
+    *size = buffer.size;
+    *data = (uint8_t*)malloc(buffer.size > 0 ? buffer.size : 1);
+    memcpy(*data, buffer.data, buffer.size);
+    DynamicBufferDeinit(&buffer);
+    return 1;
+}
+
+static void ReadUpsertedEntries(Reader* reader, DynamicBuffer* path, ProjectDescriptionDelta* delta) {
+    const size_t count = ReadCount(reader);
+    char hex[DIGEST_HEX_BUFFER_SIZE];
+    for (size_t i = 0; i < count && !reader->failed; ++i) {
+        ReadCString(reader, path);
+        ReadDigestAsHex(reader, hex);
+        DynamicStringArrayAppend(&delta->files, path->data);
+        DynamicStringArrayAppend(&delta->hashes, hex);
+        DynamicFileSizeArrayAppend(&delta->sizes, ReadFileSize(reader));
+    }
+}
+
+int ProjectDescriptionDeltaLoadFromBinary(ProjectDescriptionDeltaType type, const uint8_t* data, size_t size,
+                                          ProjectDescriptionDelta* delta) {
+    Reader reader = {data, size, 0, 0};
+    if (ReadByte(&reader) != PROJECT_DESCRIPTION_BINARY_FORMAT_VERSION)
+        return 0;
+    const uint64_t generation = ReadVarint(&reader);
+    if (reader.failed)
+        return 0;
+
+    ProjectDescriptionDeltaInit(delta, type, generation);
+    DynamicBuffer path;
+    DynamicBufferInit(&path);
+    switch (type) {
+    case PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES:
+        ReadUpsertedEntries(&reader, &path, delta);
+        break;
+    case PROJECT_DESCRIPTION_DELTA_REMOVE_ENTRIES:
+        ReadArguments(&reader, &path, &delta->files);
+        break;
+    case PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE: {
+        char executable_hash[DIGEST_HEX_BUFFER_SIZE];
+        ReadCString(&reader, &path);
+        ReadDigestAsHex(&reader, executable_hash);
+        const long long executable_size = ReadFileSize(&reader);
+        ProjectDescriptionDeltaSetExecutable(delta, path.data, executable_hash, executable_size);
+        ReadArguments(&reader, &path, &delta->executable_arguments);
+        break;
+    }
+    }
+    DynamicBufferDeinit(&path);
+
+    if (reader.failed || reader.position != reader.size) {
+        ProjectDescriptionDeltaDeinit(delta);
+        return 0;
+    }
+    return 1;
+}
+
+int ProjectDescriptionDeltaDumpToBinary(const ProjectDescriptionDelta* delta, uint8_t** data, size_t* size) {
+    DynamicBuffer buffer;
+    DynamicBufferInit(&buffer);
+    WriteByte(&buffer, PROJECT_DESCRIPTION_BINARY_FORMAT_VERSION);
+    WriteVarint(&buffer, delta->generation);
+
+    int valid = 1;
+    switch (delta->type) {
+    case PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES:
+        valid = delta->hashes.size == delta->files.size && delta->sizes.size == delta->files.size;
+        WriteVarint(&buffer, delta->files.size);
+        for (size_t i = 0; i < delta->files.size && valid; ++i) {
+            WriteString(&buffer, delta->files.data[i], strlen(delta->files.data[i]));
+            valid = WriteDigest(&buffer, delta->hashes.data[i]);
+            WriteFileSize(&buffer, delta->sizes.data[i]);
+        }
+        break;
+    case PROJECT_DESCRIPTION_DELTA_REMOVE_ENTRIES:
+        WriteVarint(&buffer, delta->files.size);
+        for (size_t i = 0; i < delta->files.size; ++i)
+            WriteString(&buffer, delta->files.data[i], strlen(delta->files.data[i]));
+        break;
+    case PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE:
+        valid = delta->executable_name != NULL && delta->executable_hash != NULL;
+        if (!valid)
+            break;
+        WriteString(&buffer, delta->executable_name, strlen(delta->executable_name));
+        valid = WriteDigest(&buffer, delta->executable_hash);
+        WriteFileSize(&buffer, delta->executable_size);
+        WriteVarint(&buffer, delta->executable_arguments.size);
+        for (size_t i = 0; i < delta->executable_arguments.size; ++i)
+            WriteString(&buffer, delta->executable_arguments.data[i], strlen(delta->executable_arguments.data[i]));
+        break;
+    }
+
+    if (!valid) {
+        DynamicBufferDeinit(&buffer);
+        return 0;
+    }
+    *size = buffer.size;
+    *data = (uint8_t*)malloc(buffer.size);
+    memcpy(*data, buffer.data, buffer.size);
+    DynamicBufferDeinit(&buffer);
+    return 1;
+}
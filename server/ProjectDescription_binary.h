@@ -0,0 +1,44 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ProjectDescriptionDelta.h"
+
+typedef struct ProjectDescription ProjectDescription;
+
+// A compact alternative to the JSON of a project description, for large projects
+// Integers are unsigned LEB128 varints, a string is a varint length followed by its bytes (no '\0')
+//
+//   format version (1 byte, PROJECT_DESCRIPTION_BINARY_FORMAT_VERSION), hash algorithm (1 byte), flags (1 byte)
+//   varint prefix count, that many strings: the directories that the paths start with
+//   executable: path, digest, size
+//   varint link dependency count, that many link dependencies: path, digest and size when the flag is set
+//   varint argument count, that many strings
+//
+// A path is the varint index of its prefix, followed by a string with the rest of the path
+// A digest is a byte with its size, followed by its bytes (0 for an empty hash)
+// A size is a varint of the size + 1, 0 for a size that is unknown
+//
+// A delta is the format version, the varint generation and then, depending on its type (known from the packet):
+//   upsert entries: varint count, that many entries of a string path, a digest and a size
+//   remove entries: varint count, that many string paths
+//   set executable: string path, digest, size, varint argument count, that many strings
+// Deltas are small, so their paths are whole strings instead of using a prefix table
+#define PROJECT_DESCRIPTION_BINARY_FORMAT_VERSION 1
+#define PROJECT_DESCRIPTION_BINARY_FLAG_LINK_DEPENDENCY_SIZES 0x1
+
+// The strings are appended to the arrays of the description as they are decoded, nothing is allocated per string
+// Returns FALSE when the data is not a complete project description, 'project_description' is then not initialized
+int ProjectDescriptionLoadFromBinary(const uint8_t* data, size_t size, ProjectDescription*);
+
+// Don't forget to free() the result
+// Returns FALSE when a hash is not hexadecimal, those can only be sent as JSON
+int ProjectDescriptionDumpToBinary(const ProjectDescription*, uint8_t** data, size_t* size);
+
+// Returns FALSE when the data is not a complete delta of the type, 'delta' is then not initialized
+int ProjectDescriptionDeltaLoadFromBinary(ProjectDescriptionDeltaType, const uint8_t* data, size_t size,
+                                          ProjectDescriptionDelta*);
+// Don't forget to free() the result
+// Returns FALSE when a hash is not hexadecimal, or when an upserted file lacks its hash or size
+int ProjectDescriptionDeltaDumpToBinary(const ProjectDescriptionDelta*, uint8_t** data, size_t* size);
@@ -1,5 +1,7 @@
 #include "ProjectDescription_json.h"
 
+#include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include <json.h>
@@ -15,9 +17,20 @@ static void ReadJSONArray(json_object* array, DynamicStringArray* dynamic_array)
     }
 }
 
-int ProjectDescriptionLoadFromJSON(const char* json_string, ProjectDescription* project_description) {
-    json_object* root = json_tokener_parse(json_string);
+// Sizes that are not a non-negative integer are unknown (-1), that way every size stays with its file
+static void ReadJSONSizeArray(json_object* array, DynamicFileSizeArray* dynamic_array) {
+    int array_length = json_object_array_length(array);
+    for (int i = 0; i < array_length; ++i) {
+        json_object* size = json_object_array_get_idx(array, i);
+        if (json_object_is_type(size, json_type_int) && json_object_get_int64(size) >= 0)
+            DynamicFileSizeArrayAppend(dynamic_array, json_object_get_int64(size));
+        else
+            DynamicFileSizeArrayAppend(dynamic_array, -1);
+    }
+}
 
+// 'root' is released
+static int LoadFromJSONObject(json_object* root, ProjectDescription* project_description) {
     json_object* executable_name_json = json_object_object_get(root, "executable_name");
     json_object* executable_hash_json = json_object_object_get(root, "executable_hash");
     json_object* link_dependencies_for_executable_json =
@@ -40,8 +53,34 @@ int ProjectDescriptionLoadFromJSON(const char* json_string, ProjectDescription*
     if (!json_object_is_type(link_dependencies_for_executable_hashes_json, json_type_array))
         return json_object_put(root), 0;
 
+    // Descriptions without an algorithm use SHA-1
+    HashAlgorithm hash_algorithm = HASH_ALGORITHM_SHA1;
+    json_object* hash_algorithm_json = json_object_object_get(root, "hash_algorithm");
+    if (hash_algorithm_json) {
+        if (!json_object_is_type(hash_algorithm_json, json_type_string))
+            return json_object_put(root), 0;
+        if (!HashAlgorithmFromName(json_object_get_string(hash_algorithm_json), &hash_algorithm))
+            return json_object_put(root), 0;
+    }
+
+    // Descriptions without sizes are checked by hash only
+    json_object* executable_size_json = json_object_object_get(root, "executable_size");
+    if (executable_size_json && !json_object_is_type(executable_size_json, json_type_int))
+        return json_object_put(root), 0;
+    json_object* link_dependencies_for_executable_sizes_json =
+        json_object_object_get(root, "link_dependencies_for_executable_sizes");
+    if (link_dependencies_for_executable_sizes_json &&
+        !json_object_is_type(link_dependencies_for_executable_sizes_json, json_type_array))
+        return json_object_put(root), 0;
+
     ProjectDescriptionInit(project_description, json_object_get_string(executable_name_json),
                            json_object_get_string(executable_hash_json));
+    project_description->hash_algorithm = hash_algorithm;
+    if (executable_size_json && json_object_get_int64(executable_size_json) >= 0)
+        project_description->executable_size = json_object_get_int64(executable_size_json);
+    if (link_dependencies_for_executable_sizes_json)
+        ReadJSONSizeArray(link_dependencies_for_executable_sizes_json,
+                          &project_description->link_dependencies_for_executable_sizes);
 
     ReadJSONArray(link_dependencies_for_executable_json, &project_description->link_dependencies_for_executable);
     ReadJSONArray(link_dependencies_for_executable_hashes_json,
@@ -55,6 +94,42 @@ int ProjectDescriptionLoadFromJSON(const char* json_string, ProjectDescription*
     return 1;
 }
 
+int ProjectDescriptionLoadFromJSON(const char* json_string, ProjectDescription* project_description) {
+    return LoadFromJSONObject(json_tokener_parse(json_string), project_description);
+}
+
+void ProjectDescriptionJSONStreamInit(ProjectDescriptionJSONStream* stream) {
+    stream->_tokener = json_tokener_new();
+    stream->_root = NULL;
+    stream->_failed = 0;
+}
+
+void ProjectDescriptionJSONStreamDeinit(ProjectDescriptionJSONStream* stream) {
+    json_object_put(stream->_root);
+    json_tokener_free(stream->_tokener);
+}
+
+int ProjectDescriptionJSONStreamFeed(ProjectDescriptionJSONStream* stream, const char* chunk, size_t size) {
+    // json-c takes the length as an int
+    while (size > 0 && !stream->_root && !stream->_failed) {
+        const int length = size > INT_MAX ? INT_MAX : (int)size;
+        stream->_root = json_tokener_parse_ex(stream->_tokener, chunk, length);
+        if (!stream->_root && json_tokener_get_error(stream->_tokener) != json_tokener_continue)
+            stream->_failed = 1;
+        chunk += length;
+        size -= length;
+    }
+    return !stream->_failed;
+}
+
+int ProjectDescriptionJSONStreamFinish(ProjectDescriptionJSONStream* stream, ProjectDescription* project_description) {
+    if (!stream->_root)
+        return 0;
+    json_object* root = stream->_root;
+    stream->_root = NULL;
+    return LoadFromJSONObject(root, project_description);
+}
+
 static void DumpIntoJSONArray(const DynamicStringArray* dynamic_array, json_object* array) {
     for (int i = 0; i < dynamic_array->size; ++i)
         json_object_array_add(array, json_object_new_string(dynamic_array->data[i]));
@@ -75,6 +150,21 @@ char* ProjectDescriptionDumpToJSON(ProjectDescription* const description) {
     DumpIntoJSONArray(&description->link_dependencies_for_executable_hashes,
                       link_dependencies_for_executable_hashes_json_array);
 
+    if (description->hash_algorithm != HASH_ALGORITHM_SHA1)
+        json_object_object_add(root, "hash_algorithm",
+                               json_object_new_string(HashAlgorithmName(description->hash_algorithm)));
+
+    if (description->executable_size >= 0)
+        json_object_object_add(root, "executable_size", json_object_new_int64(description->executable_size));
+    if (description->link_dependencies_for_executable_sizes.size > 0) {
+        json_object* link_dependencies_for_executable_sizes_json_array = json_object_new_array();
+        json_object_object_add(root, "link_dependencies_for_executable_sizes",
+                               link_dependencies_for_executable_sizes_json_array);
+        for (size_t i = 0; i < description->link_dependencies_for_executable_sizes.size; ++i)
+            json_object_array_add(link_dependencies_for_executable_sizes_json_array,
+                                  json_object_new_int64(description->link_dependencies_for_executable_sizes.data[i]));
+    }
+
     if (description->executable_arguments.size > 0) {
         json_object* executable_arguments_json_array = json_object_new_array();
         json_object_object_add(root, "executable_arguments", executable_arguments_json_array);
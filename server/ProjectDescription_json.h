@@ -2,7 +2,27 @@
 
 typedef struct ProjectDescription ProjectDescription;
 
+#include <stddef.h>
+
+struct json_tokener;
+struct json_object;
+
 int ProjectDescriptionLoadFromJSON(const char* json_string, ProjectDescription*);
 
+// Parses the JSON of a project description while its bytes arrive, only the parsed objects are kept and not the bytes
+typedef struct ProjectDescriptionJSONStream {
+    struct json_tokener* _tokener;
+    struct json_object* _root; // Set once the JSON is complete
+    int _failed;
+} ProjectDescriptionJSONStream;
+
+void ProjectDescriptionJSONStreamInit(ProjectDescriptionJSONStream*);
+void ProjectDescriptionJSONStreamDeinit(ProjectDescriptionJSONStream*);
+// The chunk can end anywhere, even within a token, what follows the complete JSON is ignored
+// Returns FALSE when the bytes fed so far can't be the start of JSON
+int ProjectDescriptionJSONStreamFeed(ProjectDescriptionJSONStream*, const char* chunk, size_t size);
+// Returns FALSE when the JSON is incomplete or not a project description, 'project_description' is then not initialized
+int ProjectDescriptionJSONStreamFinish(ProjectDescriptionJSONStream*, ProjectDescription*);
+
 // Don't forget to free() the result
 char* ProjectDescriptionDumpToJSON(ProjectDescription* const);
\ No newline at end of file
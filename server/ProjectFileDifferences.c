@@ -26,19 +26,9 @@ void ProjectFileDifferencesDeinit(ProjectFileDifferences* project_differences) {
     DynamicStringArrayDeinit(&project_differences->wanted_hashes);
 }
 
-static int DynamicStringArraysEqual(const DynamicStringArray* first, const DynamicStringArray* second) {
-    if (first->size != second->size)
-        return 0;
-
-    for (int i = 0; i < first->size; ++i)
-        if (strcmp(first->data[i], second->data[i]) != 0)
-            return 0;
-    return 1;
-}
-
 int ProjectFileDifferencesEqual(const ProjectFileDifferences* first, const ProjectFileDifferences* second) {
-    return DynamicStringArraysEqual(&first->existing, &second->existing) &&
-           DynamicStringArraysEqual(&first->missing, &second->missing) &&
-           DynamicStringArraysEqual(&first->actual_hashes, &second->actual_hashes) &&
-           DynamicStringArraysEqual(&first->wanted_hashes, &second->wanted_hashes);
+    return DynamicStringArrayEqual(&first->existing, &second->existing) &&
+           DynamicStringArrayEqual(&first->missing, &second->missing) &&
+           DynamicStringArrayEqual(&first->actual_hashes, &second->actual_hashes) &&
+           DynamicStringArrayEqual(&first->wanted_hashes, &second->wanted_hashes);
 }
\ No newline at end of file
@@ -0,0 +1,372 @@
+#include "ProjectFileWatcher.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include "DynamicStringArray.h"
+#include "PathIndex.h"
+#include "ProjectDescription.h"
+
+#define DIRECTORY_WATCH_MASK                                                                                           \
+    (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MODIFY | IN_ATTRIB | IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF |   \
+     IN_MOVE_SELF | IN_ONLYDIR)
+// A link that is created (ln, ln -s) only gives IN_CREATE, so creating a file starts its quiet window. Writes that
+// follow postpone it like they do for any pending file
+#define FILE_FINISHED_MASK (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE)
+#define FILE_ACTIVE_MASK (IN_MODIFY | IN_ATTRIB)
+#define FILE_REMOVED_MASK (IN_DELETE | IN_MOVED_FROM)
+#define DIRECTORY_LOST_MASK (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)
+
+#define EVENT_READ_BUFFER_SIZE 4096
+
+// Flags, a removal cancels the earlier events for the file and vice versa
+enum PendingEvent {
+    PENDING_EVENT_NONE = 0,
+    PENDING_EVENT_ACTIVE = 1 << 0,
+    PENDING_EVENT_FINISHED = 1 << 1,
+    PENDING_EVENT_REMOVED = 1 << 2
+};
+
+#define NO_FILE ((size_t)-1)
+
+// One inotify watch, shared by every directory path that resolves to it
+typedef struct {
+    int wd;            // -1 once the watch was lost
+    char wd_key[16];   // 'wd' as text, its key in 'watches_by_wd'
+    size_t position;   // In 'watches'
+    size_t references; // The directories that use the watch, it is removed when none is left
+    PathIndex files_by_name; // The first of the watched files with the name, see 'next_with_same_name'
+} DirectoryWatch;
+
+typedef struct {
+    char* path;
+    DirectoryWatch* watch; // NULL when the directory could not be watched
+} WatchedDirectory;
+
+typedef struct {
+    char* file;       // As it appears in the project description
+    const char* name; // Points into 'file', the part after the directory
+    size_t directory;
+    size_t next_with_same_name; // A description can list a file twice, NO_FILE for the last one
+    int pending_events;
+} WatchedFile;
+
+typedef struct {
+    WatchedFile* files;
+    size_t size;
+
+    WatchedDirectory* directories;
+    size_t directory_count;
+    PathIndex directories_by_path; // The paths are owned by 'directories'
+    size_t unwatched_directories;
+
+    DirectoryWatch** watches;
+    size_t watch_count, watch_capacity;
+    PathIndex watches_by_wd; // Position in 'watches'
+
+    size_t* pending_files; // The files with pending events, so reading events doesn't walk every file
+    size_t pending_count;
+} ProjectFileWatcherInternal;
+
+void ProjectFileWatcherInit(ProjectFileWatcher* watcher) {
+    errno = 0;
+    watcher->fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (watcher->fd < 0)
+        fprintf(stderr, "Unable to open an inotify fd, falling back to polling for file changes: %s\n",
+                strerror(errno));
+
+    ProjectFileWatcherInternal* internal = (ProjectFileWatcherInternal*)calloc(1, sizeof(ProjectFileWatcherInternal));
+    PathIndexInit(&internal->directories_by_path);
+    PathIndexInit(&internal->watches_by_wd);
+    watcher->_internal = internal;
+}
+
+static void FreeWatchedFiles(ProjectFileWatcherInternal* internal) {
+    for (size_t i = 0; i < internal->size; ++i)
+        free(internal->files[i].file);
+    free(internal->files);
+    internal->files = NULL;
+    internal->size = 0;
+    free(internal->pending_files);
+    internal->pending_files = NULL;
+    internal->pending_count = 0;
+}
+
+static void FreeWatchedDirectories(WatchedDirectory* directories, size_t directory_count) {
+    for (size_t i = 0; i < directory_count; ++i)
+        free(directories[i].path);
+    free(directories);
+}
+
+static void FreeDirectoryWatch(DirectoryWatch* watch) {
+    PathIndexDeinit(&watch->files_by_name);
+    free(watch);
+}
+
+void ProjectFileWatcherDeinit(ProjectFileWatcher* watcher) {
+    ProjectFileWatcherInternal* internal = (ProjectFileWatcherInternal*)watcher->_internal;
+    if (internal) {
+        FreeWatchedFiles(internal);
+        FreeWatchedDirectories(internal->directories, internal->directory_count);
+        PathIndexDeinit(&internal->directories_by_path);
+        for (size_t i = 0; i < internal->watch_count; ++i)
+            FreeDirectoryWatch(internal->watches[i]);
+        free(internal->watches);
+        PathIndexDeinit(&internal->watches_by_wd);
+        free(internal);
+        watcher->_internal = NULL;
+    }
+    if (watcher->fd >= 0)
+        close(watcher->fd);
+    watcher->fd = -1;
+}
+
+// Returns the length of the directory part of 'file', and points 'name' at the part after it
+static size_t SplitDirectory(const char* file, const char** name) {
+    const char* last_separator = strrchr(file, '/');
+    if (!last_separator) {
+        *name = file;
+        return 0;
+    }
+    *name = last_separator + 1;
+    return last_separator == file ? 1 : (size_t)(last_separator - file);
+}
+
+// Returns the position of the directory of 'file', it is added when it is new
+// The directories are allocated for one directory per file, so adding one never moves them
+static size_t FindOrAddDirectory(WatchedDirectory* directories, size_t* directory_count,
+                                 PathIndex* directories_by_path, const char* file, const char** name) {
+    const size_t directory_length = SplitDirectory(file, name);
+    char* path = (char*)malloc(directory_length > 0 ? directory_length + 1 : 2);
+    if (directory_length > 0) {
+        memcpy(path, file, directory_length);
+        path[directory_length] = '\0';
+    } else {
+        strcpy(path, ".");
+    }
+
+    const size_t found = PathIndexFind(directories_by_path, path);
+    if (found != PATH_INDEX_NOT_FOUND) {
+        free(path);
+        return found;
+    }
+    const size_t position = (*directory_count)++;
+    directories[position].path = path;
+    directories[position].watch = NULL;
+    PathIndexInsert(directories_by_path, path, position);
+    return position;
+}
+
+static DirectoryWatch* FindWatch(const ProjectFileWatcherInternal* internal, int wd) {
+    char wd_key[16];
+    snprintf(wd_key, sizeof(wd_key), "%d", wd);
+    const size_t position = PathIndexFind(&internal->watches_by_wd, wd_key);
+    return position == PATH_INDEX_NOT_FOUND ? NULL : internal->watches[position];
+}
+
+// Adding a watch for a directory that is already watched through another path gives back the same watch descriptor
+static DirectoryWatch* AddWatch(ProjectFileWatcher* watcher, const char* directory) {
+    ProjectFileWatcherInternal* internal = (ProjectFileWatcherInternal*)watcher->_internal;
+    const int wd = inotify_add_watch(watcher->fd, directory, DIRECTORY_WATCH_MASK);
+    if (wd < 0)
+        return NULL;
+    DirectoryWatch* watch = FindWatch(internal, wd);
+    if (watch)
+        return watch;
+
+    watch = (DirectoryWatch*)malloc(sizeof(DirectoryWatch));
+    watch->wd = wd;
+    snprintf(watch->wd_key, sizeof(watch->wd_key), "%d", wd);
+    watch->references = 0;
+    PathIndexInit(&watch->files_by_name);
+    if (internal->watch_count == internal->watch_capacity) {
+        internal->watch_capacity = internal->watch_capacity > 0 ? internal->watch_capacity * 2 : 16;
+        internal->watches =
+            (DirectoryWatch**)realloc(internal->watches, internal->watch_capacity * sizeof(DirectoryWatch*));
+    }
+    watch->position = internal->watch_count;
+    internal->watches[internal->watch_count] = watch;
+    PathIndexInsert(&internal->watches_by_wd, watch->wd_key, internal->watch_count);
+    ++internal->watch_count;
+    return watch;
+}
+
+// The watch stops reporting events, the directories that use it are not watched anymore
+static void LoseWatch(ProjectFileWatcherInternal* internal, DirectoryWatch* watch) {
+    if (watch->wd < 0)
+        return;
+    PathIndexErase(&internal->watches_by_wd, watch->wd_key);
+    watch->wd = -1;
+    internal->unwatched_directories += watch->references;
+}
+
+static void ReleaseWatch(ProjectFileWatcher* watcher, DirectoryWatch* watch) {
+    ProjectFileWatcherInternal* internal = (ProjectFileWatcherInternal*)watcher->_internal;
+    if (--watch->references > 0)
+        return;
+    if (watch->wd >= 0)
+        inotify_rm_watch(watcher->fd, watch->wd);
+    LoseWatch(internal, watch);
+    // The last watch takes the place of the erased one
+    DirectoryWatch* last_watch = internal->watches[--internal->watch_count];
+    internal->watches[watch->position] = last_watch;
+    last_watch->position = watch->position;
+    if (last_watch->wd >= 0)
+        PathIndexInsert(&internal->watches_by_wd, last_watch->wd_key, last_watch->position);
+    FreeDirectoryWatch(watch);
+}
+
+void ProjectFileWatcherWatch(ProjectFileWatcher* watcher, const ProjectDescription* description) {
+    ProjectFileWatcherInternal* internal = (ProjectFileWatcherInternal*)watcher->_internal;
+    if (!internal || watcher->fd < 0)
+        return;
+
+    const size_t new_size = 1 + description->link_dependencies_for_executable.size;
+    WatchedFile* new_files = (WatchedFile*)malloc(sizeof(WatchedFile) * new_size);
+    WatchedDirectory* new_directories = (WatchedDirectory*)malloc(sizeof(WatchedDirectory) * new_size);
+    size_t new_directory_count = 0;
+    PathIndex new_directories_by_path;
+    PathIndexInit(&new_directories_by_path);
+    for (size_t i = 0; i < new_size; ++i) {
+        const char* file =
+            i == 0 ? description->executable_name : description->link_dependencies_for_executable.data[i - 1];
+        WatchedFile* watched_file = &new_files[i];
+        const size_t file_length = strlen(file);
+        watched_file->file = (char*)malloc(file_length + 1);
+        memcpy(watched_file->file, file, file_length + 1);
+        watched_file->directory = FindOrAddDirectory(new_directories, &new_directory_count, &new_directories_by_path,
+                                                     watched_file->file, &watched_file->name);
+        watched_file->next_with_same_name = NO_FILE;
+        watched_file->pending_events = PENDING_EVENT_NONE;
+    }
+
+    // Every directory is watched once, a directory that was watched already keeps its watch. The references are taken
+    // before the old ones are released, so a watch that is still used is never removed in between
+    size_t unwatched_directories = 0;
+    for (size_t i = 0; i < new_directory_count; ++i) {
+        WatchedDirectory* directory = &new_directories[i];
+        const size_t old_position = PathIndexFind(&internal->directories_by_path, directory->path);
+        DirectoryWatch* old_watch =
+            old_position != PATH_INDEX_NOT_FOUND ? internal->directories[old_position].watch : NULL;
+        directory->watch = old_watch && old_watch->wd >= 0 ? old_watch : AddWatch(watcher, directory->path);
+        if (directory->watch)
+            ++directory->watch->references;
+        else
+            ++unwatched_directories;
+    }
+    for (size_t i = 0; i < internal->directory_count; ++i) {
+        if (internal->directories[i].watch)
+            ReleaseWatch(watcher, internal->directories[i].watch);
+    }
+
+    FreeWatchedFiles(internal);
+    FreeWatchedDirectories(internal->directories, internal->directory_count);
+    PathIndexDeinit(&internal->directories_by_path);
+    internal->files = new_files;
+    internal->size = new_size;
+    internal->directories = new_directories;
+    internal->directory_count = new_directory_count;
+    internal->directories_by_path = new_directories_by_path;
+    internal->unwatched_directories = unwatched_directories;
+    internal->pending_files = (size_t*)malloc(sizeof(size_t) * new_size);
+
+    // Events are matched with the files by the watch and the name
+    for (size_t i = 0; i < internal->watch_count; ++i)
+        PathIndexClear(&internal->watches[i]->files_by_name);
+    for (size_t i = new_size; i-- > 0;) {
+        WatchedFile* watched_file = &new_files[i];
+        DirectoryWatch* watch = new_directories[watched_file->directory].watch;
+        if (!watch)
+            continue;
+        const size_t same_name = PathIndexFind(&watch->files_by_name, watched_file->name);
+        watched_file->next_with_same_name = same_name != PATH_INDEX_NOT_FOUND ? same_name : NO_FILE;
+        PathIndexInsert(&watch->files_by_name, watched_file->name, i);
+    }
+}
+
+int ProjectFileWatcherIsComplete(const ProjectFileWatcher* watcher) {
+    const ProjectFileWatcherInternal* internal = (const ProjectFileWatcherInternal*)watcher->_internal;
+    if (!internal || watcher->fd < 0)
+        return 0;
+    return internal->unwatched_directories == 0;
+}
+
+static void AddPendingEvent(ProjectFileWatcherInternal* internal, WatchedFile* watched_file, int pending_events) {
+    if (watched_file->pending_events == PENDING_EVENT_NONE)
+        internal->pending_files[internal->pending_count++] = (size_t)(watched_file - internal->files);
+    watched_file->pending_events = pending_events;
+}
+
+// Returns FALSE when events were lost
+static int ApplyEvent(ProjectFileWatcherInternal* internal, const struct inotify_event* event) {
+    if (event->mask & IN_Q_OVERFLOW)
+        return 0;
+
+    // Events of a watch that was removed can still be queued
+    DirectoryWatch* watch = FindWatch(internal, event->wd);
+    if (!watch)
+        return 1;
+    if (event->mask & DIRECTORY_LOST_MASK) {
+        LoseWatch(internal, watch);
+        return 0;
+    }
+    if (event->len == 0)
+        return 1;
+
+    size_t i = PathIndexFind(&watch->files_by_name, event->name);
+    for (; i != PATH_INDEX_NOT_FOUND && i != NO_FILE; i = internal->files[i].next_with_same_name) {
+        WatchedFile* watched_file = &internal->files[i];
+        if (event->mask & FILE_REMOVED_MASK)
+            AddPendingEvent(internal, watched_file, PENDING_EVENT_REMOVED);
+        else if (event->mask & FILE_FINISHED_MASK)
+            AddPendingEvent(internal, watched_file,
+                            (watched_file->pending_events & ~PENDING_EVENT_REMOVED) | PENDING_EVENT_FINISHED);
+        else if (event->mask & FILE_ACTIVE_MASK)
+            AddPendingEvent(internal, watched_file,
+                            (watched_file->pending_events & ~PENDING_EVENT_REMOVED) | PENDING_EVENT_ACTIVE);
+    }
+    return 1;
+}
+
+int ProjectFileWatcherReadEvents(ProjectFileWatcher* watcher, DynamicStringArray* finished_files,
+                                 DynamicStringArray* active_files, DynamicStringArray* removed_files) {
+    ProjectFileWatcherInternal* internal = (ProjectFileWatcherInternal*)watcher->_internal;
+    if (!internal || watcher->fd < 0)
+        return 1;
+
+    int complete = 1;
+    char read_buffer[EVENT_READ_BUFFER_SIZE] __attribute__((aligned(__alignof__(struct inotify_event))));
+    for (;;) {
+        errno = 0;
+        const ssize_t read_length = read(watcher->fd, read_buffer, EVENT_READ_BUFFER_SIZE);
+        if (read_length <= 0) {
+            if (read_length < 0 && errno != EAGAIN)
+                fprintf(stderr, "Error reading inotify events: %s\n", strerror(errno));
+            break;
+        }
+
+        for (ssize_t i = 0; i < read_length;) {
+            const struct inotify_event* event = (const struct inotify_event*)&read_buffer[i];
+            if (!ApplyEvent(internal, event))
+                complete = 0;
+            i += sizeof(struct inotify_event) + event->len;
+        }
+    }
+
+    for (size_t i = 0; i < internal->pending_count; ++i) {
+        WatchedFile* watched_file = &internal->files[internal->pending_files[i]];
+        if (watched_file->pending_events & PENDING_EVENT_REMOVED)
+            DynamicStringArrayAppend(removed_files, watched_file->file);
+        else if (watched_file->pending_events & PENDING_EVENT_FINISHED)
+            DynamicStringArrayAppend(finished_files, watched_file->file);
+        else if (watched_file->pending_events & PENDING_EVENT_ACTIVE)
+            DynamicStringArrayAppend(active_files, watched_file->file);
+        watched_file->pending_events = PENDING_EVENT_NONE;
+    }
+    internal->pending_count = 0;
+    return complete;
+}
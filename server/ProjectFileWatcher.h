@@ -0,0 +1,32 @@
+#pragma once
+
+typedef struct ProjectDescription ProjectDescription;
+typedef struct DynamicStringArray DynamicStringArray;
+
+// Watches the parent directories of every file in a project description using inotify
+typedef struct ProjectFileWatcher {
+    int fd; // -1 when inotify is not available, the fd is non-blocking and can be polled for POLLIN
+    void* _internal;
+} ProjectFileWatcher;
+
+void ProjectFileWatcherInit(ProjectFileWatcher*);
+void ProjectFileWatcherDeinit(ProjectFileWatcher*);
+
+// Replaces the current watches by watches on the parent directories of the files in the given description
+// A directory that is watched already keeps its watch, every directory is watched once however many files it has
+void ProjectFileWatcherWatch(ProjectFileWatcher*, const ProjectDescription*);
+
+// Returns FALSE when inotify is unavailable, or when a directory could not be watched (for example because it does not
+// exist yet). In that case changes to some files will not be reported and they should be checked by other means.
+int ProjectFileWatcherIsComplete(const ProjectFileWatcher*);
+
+// Reads all pending events and reports the affected project files, each file is reported in at most one output
+// - finished_files: a writer is done with the file (closed after writing, or renamed into place), or it was created,
+//   which is all that happens for a link
+// - active_files: the file is being written to, a finishing event is likely to follow
+// - removed_files: the file was deleted or moved away
+// Output arguments must be initialized and will be owned by the caller
+// Returns FALSE when events were lost (queue overflow or a watched directory disappeared), every file should then be
+// checked again and the watches should be renewed
+int ProjectFileWatcherReadEvents(ProjectFileWatcher*, DynamicStringArray* finished_files,
+                                 DynamicStringArray* active_files, DynamicStringArray* removed_files);
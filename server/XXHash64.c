@@ -0,0 +1,132 @@
+#include "XXHash64.h"
+
+#include <string.h>
+
+#define PRIME64_1 0x9E3779B185EBCA87ULL
+#define PRIME64_2 0xC2B2AE3D27D4EB4FULL
+#define PRIME64_3 0x165667B19E3779F9ULL
+#define PRIME64_4 0x85EBCA77C2B2AE63ULL
+#define PRIME64_5 0x27D4EB2F165667C5ULL
+
+#define STRIPE_SIZE 32
+
+static uint64_t RotateLeft(uint64_t value, int bits) { return (value << bits) | (value >> (64 - bits)); }
+
+// The input is little endian, memcpy keeps unaligned reads well defined
+static uint64_t Read64(const unsigned char* data) {
+    uint64_t value;
+    memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+static uint32_t Read32(const unsigned char* data) {
+    uint32_t value;
+    memcpy(&value, data, sizeof(value));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static uint64_t Round(uint64_t accumulator, uint64_t input) {
+    accumulator += input * PRIME64_2;
+    accumulator = RotateLeft(accumulator, 31);
+    return accumulator * PRIME64_1;
+}
+
+static uint64_t MergeRound(uint64_t hash, uint64_t accumulator) {
+    hash ^= Round(0, accumulator);
+    return hash * PRIME64_1 + PRIME64_4;
+}
+
+// Returns the amount of bytes consumed, always a multiple of STRIPE_SIZE
+static size_t ConsumeStripes(uint64_t* accumulators, const unsigned char* data, size_t size) {
+    uint64_t v1 = accumulators[0], v2 = accumulators[1], v3 = accumulators[2], v4 = accumulators[3];
+    const unsigned char* position = data;
+    const unsigned char* const end = data + (size - size % STRIPE_SIZE);
+    while (position < end) {
+        v1 = Round(v1, Read64(position));
+        v2 = Round(v2, Read64(position + 8));
+        v3 = Round(v3, Read64(position + 16));
+        v4 = Round(v4, Read64(position + 24));
+        position += STRIPE_SIZE;
+    }
+    accumulators[0] = v1;
+    accumulators[1] = v2;
+    accumulators[2] = v3;
+    accumulators[3] = v4;
+    return position - data;
+}
+
+void XXH64Init(XXH64State* state, uint64_t seed) {
+    state->total_length = 0;
+    state->accumulators[0] = seed + PRIME64_1 + PRIME64_2;
+    state->accumulators[1] = seed + PRIME64_2;
+    state->accumulators[2] = seed;
+    state->accumulators[3] = seed - PRIME64_1;
+    state->buffered = 0;
+    state->seed = seed;
+}
+
+void XXH64Update(XXH64State* state, const void* data, size_t size) {
+    const unsigned char* input = (const unsigned char*)data;
+    state->total_length += size;
+
+    if (state->buffered > 0) {
+        const size_t missing = STRIPE_SIZE - state->buffered;
+        const size_t copied = size < missing ? size : missing;
+        memcpy(state->buffer + state->buffered, input, copied);
+        state->buffered += copied;
+        input += copied;
+        size -= copied;
+        if (state->buffered < STRIPE_SIZE)
+            return;
+        ConsumeStripes(state->accumulators, state->buffer, STRIPE_SIZE);
+        state->buffered = 0;
+    }
+
+    const size_t consumed = ConsumeStripes(state->accumulators, input, size);
+    memcpy(state->buffer, input + consumed, size - consumed);
+    state->buffered = size - consumed;
+}
+
+uint64_t XXH64Final(const XXH64State* state) {
+    uint64_t hash;
+    if (state->total_length >= STRIPE_SIZE) {
+        const uint64_t* v = state->accumulators;
+        hash = RotateLeft(v[0], 1) + RotateLeft(v[1], 7) + RotateLeft(v[2], 12) + RotateLeft(v[3], 18);
+        hash = MergeRound(hash, v[0]);
+        hash = MergeRound(hash, v[1]);
+        hash = MergeRound(hash, v[2]);
+        hash = MergeRound(hash, v[3]);
+    } else {
+        hash = state->seed + PRIME64_5;
+    }
+    hash += state->total_length;
+
+    const unsigned char* position = state->buffer;
+    const unsigned char* const end = state->buffer + state->buffered;
+    for (; position + 8 <= end; position += 8) {
+        hash ^= Round(0, Read64(position));
+        hash = RotateLeft(hash, 27) * PRIME64_1 + PRIME64_4;
+    }
+    if (position + 4 <= end) {
+        hash ^= (uint64_t)Read32(position) * PRIME64_1;
+        hash = RotateLeft(hash, 23) * PRIME64_2 + PRIME64_3;
+        position += 4;
+    }
+    for (; position < end; ++position) {
+        hash ^= (*position) * PRIME64_5;
+        hash = RotateLeft(hash, 11) * PRIME64_1;
+    }
+
+    hash ^= hash >> 33;
+    hash *= PRIME64_2;
+    hash ^= hash >> 29;
+    hash *= PRIME64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Streaming XXH64, produces the same values as the reference xxHash implementation
+typedef struct XXH64State {
+    uint64_t total_length;
+    uint64_t accumulators[4];
+    unsigned char buffer[32]; // Input that did not fill a whole 32 byte stripe yet
+    size_t buffered;
+    uint64_t seed;
+} XXH64State;
+
+void XXH64Init(XXH64State*, uint64_t seed);
+void XXH64Update(XXH64State*, const void* data, size_t size);
+uint64_t XXH64Final(const XXH64State*);
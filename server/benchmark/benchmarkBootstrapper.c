@@ -0,0 +1,98 @@
+// Measures how the Bootstrapper's file table scales with the amount of files in the project description
+// Usage: benchmarkBootstrapper [FILE_COUNT...], by default 10, 100, 1000, 10000 and 100000 files are used
+// Files are neither read nor hashed, the callbacks pretend that every file exists and matches
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "../Bootstrapper.h"
+#include "../Digest.h"
+#include "../DynamicStringArray.h"
+#include "../ProjectDescription.h"
+
+#define MINIMUM_SECONDS_PER_MEASUREMENT 0.5
+#define FILE_HASH "abcd"
+
+static int FakeStartGDBServer(void* userdata, char* executable, const DynamicStringArray* arguments) { return 1; }
+static int FakeStopGDBServer(void* userdata) { return 1; }
+static int FakeFileExists(const char* file, void* userdata) { return 1; }
+static int FakeCalculateHash(const char* file, Digest* digest, void* userdata) {
+    return DigestFromHex(FILE_HASH, digest);
+}
+
+static double MonotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void MakeDescription(ProjectDescription* description, long long file_count) {
+    ProjectDescriptionInit(description, "/project/bin/app", FILE_HASH);
+    char file[64];
+    for (long long i = 1; i < file_count; ++i) {
+        snprintf(file, sizeof(file), "/project/lib/lib%lld.so", i);
+        DynamicStringArrayAppend(&description->link_dependencies_for_executable, file);
+        DynamicStringArrayAppend(&description->link_dependencies_for_executable_hashes, FILE_HASH);
+    }
+}
+
+// Returns the average amount of seconds that a description takes to be received
+static double MeasureReceive(Bootstrapper* bootstrapper, ProjectDescription* description) {
+    int runs = 0;
+    const double start = MonotonicSeconds();
+    double elapsed;
+    do {
+        ReceiveNewProjectDescription(bootstrapper, description);
+        ++runs;
+        elapsed = MonotonicSeconds() - start;
+    } while (elapsed < MINIMUM_SECONDS_PER_MEASUREMENT);
+    return elapsed / runs;
+}
+
+// Returns the average amount of seconds that an update of every file of the description takes
+static double MeasureUpdate(Bootstrapper* bootstrapper, ProjectDescription* description) {
+    DynamicStringArray files;
+    DynamicStringArrayCopy(&description->link_dependencies_for_executable, &files);
+    DynamicStringArrayAppend(&files, description->executable_name);
+
+    int runs = 0;
+    const double start = MonotonicSeconds();
+    double elapsed;
+    do {
+        UpdateFileActualHashes(bootstrapper, &files);
+        ++runs;
+        elapsed = MonotonicSeconds() - start;
+    } while (elapsed < MINIMUM_SECONDS_PER_MEASUREMENT);
+    DynamicStringArrayDeinit(&files);
+    return elapsed / runs;
+}
+
+int main(int argc, char** argv) {
+    long long default_file_counts[] = {10, 100, 1000, 10000, 100000};
+    const int count = argc > 1 ? argc - 1 : (int)(sizeof(default_file_counts) / sizeof(default_file_counts[0]));
+
+    printf("%10s %16s %16s %16s %16s\n", "files", "receive (ms)", "update (ms)", "receive (ns/f)", "update (ns/f)");
+    for (int i = 0; i < count; ++i) {
+        const long long file_count = argc > 1 ? strtoll(argv[i + 1], NULL, 10) : default_file_counts[i];
+        if (file_count < 1) {
+            fprintf(stderr, "A project description has at least 1 file\n");
+            return 1;
+        }
+
+        Bootstrapper bootstrapper = {
+            NULL, &FakeStartGDBServer, &FakeStopGDBServer, &FakeFileExists, &FakeCalculateHash, NULL, NULL, NULL};
+        BootstrapperInit(&bootstrapper);
+        ProjectDescription description;
+        MakeDescription(&description, file_count);
+
+        const double receive = MeasureReceive(&bootstrapper, &description);
+        const double update = MeasureUpdate(&bootstrapper, &description);
+        printf("%10lld %16.3f %16.3f %16.1f %16.1f\n", file_count, receive * 1e3, update * 1e3,
+               receive * 1e9 / file_count, update * 1e9 / file_count);
+
+        ProjectDescriptionDeinit(&description);
+        BootstrapperDeinit(&bootstrapper);
+    }
+    return 0;
+}
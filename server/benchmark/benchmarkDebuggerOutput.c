@@ -0,0 +1,188 @@
+// Compares broadcasting every read of debugger output as its own message against batching the output by size and
+// delay, the way the event loop does
+// Usage: benchmarkDebuggerOutput DUMMY_DEBUGGER [LINES], by default 100000 lines are printed
+// DUMMY_DEBUGGER is extra/dummy_debugger/dummy_debugger.py. Its output is recorded once, read by read as it arrives,
+// after which the reads are replayed into both strategies. Every message is encoded like it is for a subscriber
+
+#include <errno.h>
+#include <poll.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "../BroadcastFrame.h"
+#include "../DynamicBuffer.h"
+#include "../DynamicStringArray.h"
+#include "../OutputBatcher.h"
+#include "../SubscriberUpdate.h"
+#include "../protocol/Protocol.h"
+
+#define READ_SIZE 4096
+#define BATCH_SIZE (64 * 1024)
+#define DELAY_MS 5
+#define MINIMUM_SECONDS_PER_MEASUREMENT 0.3
+
+typedef struct {
+    DynamicBuffer output;
+    size_t* read_sizes;
+    long long* read_times_ms; // Relative to the first read
+    size_t read_count, read_capacity;
+} RecordedOutput;
+
+typedef struct {
+    size_t messages, encoded_bytes;
+} Broadcasted;
+
+static double MonotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void RecordRead(RecordedOutput* recorded, const char* data, size_t size, long long time_ms) {
+    if (recorded->read_count == recorded->read_capacity) {
+        recorded->read_capacity = recorded->read_capacity > 0 ? recorded->read_capacity * 2 : 1024;
+        recorded->read_sizes = (size_t*)realloc(recorded->read_sizes, recorded->read_capacity * sizeof(size_t));
+        recorded->read_times_ms =
+            (long long*)realloc(recorded->read_times_ms, recorded->read_capacity * sizeof(long long));
+    }
+    DynamicBufferAppend(&recorded->output, data, size);
+    recorded->read_sizes[recorded->read_count] = size;
+    recorded->read_times_ms[recorded->read_count] = time_ms;
+    ++recorded->read_count;
+}
+
+// Returns FALSE when the dummy debugger could not be run
+static int RecordDummyDebugger(const char* dummy_debugger, const char* lines, RecordedOutput* recorded) {
+    int pipe_fds[2];
+    if (pipe(pipe_fds) != 0)
+        return 0;
+    const pid_t pid = fork();
+    if (pid == 0) {
+        dup2(pipe_fds[1], STDOUT_FILENO);
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+        // The dummy debugger only checks that the program to debug exists
+        execl(dummy_debugger, dummy_debugger, "--lines", lines, dummy_debugger, (char*)NULL);
+        _exit(127);
+    }
+    close(pipe_fds[1]);
+    if (pid < 0) {
+        close(pipe_fds[0]);
+        return 0;
+    }
+
+    const double start = MonotonicSeconds();
+    char buffer[READ_SIZE];
+    struct pollfd pfd = {pipe_fds[0], POLLIN, 0};
+    while (poll(&pfd, 1, -1) >= 0) {
+        const ssize_t bytes_read = read(pipe_fds[0], buffer, sizeof(buffer));
+        if (bytes_read < 0 && errno == EINTR)
+            continue;
+        if (bytes_read <= 0)
+            break;
+        RecordRead(recorded, buffer, (size_t)bytes_read, (long long)((MonotonicSeconds() - start) * 1e3));
+    }
+    close(pipe_fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static void EncodeMessage(const char* output, Broadcasted* broadcasted) {
+    char* message = EncodeSubscriberUpdateMessage("GDB stdout", output);
+    const size_t message_size = strlen(message) + 1;
+    uint8_t* header;
+    size_t header_size;
+    MakeSubscriptionResponsePacketHeader(2, message_size, &header, &header_size);
+    BroadcastFrame* frame = BroadcastFrameCreate(NULL, header, header_size, (const uint8_t*)message, message_size);
+    ++broadcasted->messages;
+    broadcasted->encoded_bytes += frame->size;
+    BroadcastFrameRelease(frame);
+    free(header);
+    free(message);
+}
+
+static void BroadcastEveryRead(const RecordedOutput* recorded, Broadcasted* broadcasted) {
+    const char* data = recorded->output.data;
+    for (size_t i = 0; i < recorded->read_count; ++i) {
+        char* output = (char*)malloc(recorded->read_sizes[i] + 1);
+        memcpy(output, data, recorded->read_sizes[i]);
+        output[recorded->read_sizes[i]] = '\0';
+        EncodeMessage(output, broadcasted);
+        free(output);
+        data += recorded->read_sizes[i];
+    }
+}
+
+static void EncodeBatches(DynamicStringArray* batches, Broadcasted* broadcasted) {
+    for (size_t i = 0; i < batches->size; ++i)
+        EncodeMessage(batches->data[i], broadcasted);
+    DynamicStringArrayClear(batches);
+}
+
+static void BroadcastBatches(const RecordedOutput* recorded, Broadcasted* broadcasted) {
+    OutputBatcher batcher;
+    OutputBatcherInit(&batcher, BATCH_SIZE, DELAY_MS);
+    DynamicStringArray batches;
+    DynamicStringArrayInit(&batches);
+    const char* data = recorded->output.data;
+    for (size_t i = 0; i < recorded->read_count; ++i) {
+        OutputBatcherAppend(&batcher, data, recorded->read_sizes[i], recorded->read_times_ms[i]);
+        OutputBatcherTakeDue(&batcher, recorded->read_times_ms[i], &batches);
+        EncodeBatches(&batches, broadcasted);
+        data += recorded->read_sizes[i];
+    }
+    OutputBatcherTakeAll(&batcher, &batches);
+    EncodeBatches(&batches, broadcasted);
+    DynamicStringArrayDeinit(&batches);
+    OutputBatcherDeinit(&batcher);
+}
+
+static void Measure(const char* strategy, void (*broadcast)(const RecordedOutput*, Broadcasted*),
+                    const RecordedOutput* recorded) {
+    Broadcasted broadcasted;
+    size_t repetitions = 0;
+    const double start = MonotonicSeconds();
+    double elapsed;
+    do {
+        broadcasted.messages = 0;
+        broadcasted.encoded_bytes = 0;
+        broadcast(recorded, &broadcasted);
+        ++repetitions;
+        elapsed = MonotonicSeconds() - start;
+    } while (elapsed < MINIMUM_SECONDS_PER_MEASUREMENT);
+
+    const double seconds = elapsed / repetitions;
+    printf("%10s %12zu %16zu %12.3f %16.1f\n", strategy, broadcasted.messages, broadcasted.encoded_bytes,
+           seconds * 1e3, recorded->output.size / seconds / (1024 * 1024));
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "Usage: %s DUMMY_DEBUGGER [LINES]\n", argv[0]);
+        return 1;
+    }
+    const char* lines = argc > 2 ? argv[2] : "100000";
+
+    RecordedOutput recorded;
+    memset(&recorded, 0, sizeof(recorded));
+    DynamicBufferInit(&recorded.output);
+    if (!RecordDummyDebugger(argv[1], lines, &recorded)) {
+        fprintf(stderr, "Running the dummy debugger '%s' failed\n", argv[1]);
+        return 1;
+    }
+    printf("Recorded %zu bytes of output in %zu reads\n", recorded.output.size, recorded.read_count);
+
+    printf("%10s %12s %16s %12s %16s\n", "strategy", "messages", "encoded bytes", "time (ms)", "output (MB/s)");
+    Measure("per read", &BroadcastEveryRead, &recorded);
+    Measure("batched", &BroadcastBatches, &recorded);
+
+    DynamicBufferDeinit(&recorded.output);
+    free(recorded.read_sizes);
+    free(recorded.read_times_ms);
+    return 0;
+}
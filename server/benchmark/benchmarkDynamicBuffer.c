@@ -0,0 +1,124 @@
+// Measures how long a slow subscriber takes to drain the backlog of its writing buffer, against the previous
+// implementation of DynamicBuffer, which moved the remaining bytes to the front on every trim
+// Usage: benchmarkDynamicBuffer [BACKLOG_MEGABYTES...], by default 1, 8 and 64 megabytes are used
+// The backlog is sent in partial writes of 64 KiB, while a new message of 1 KiB arrives after every write
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../DynamicBuffer.h"
+
+#define PARTIAL_WRITE_SIZE (64 * 1024)
+#define MESSAGE_SIZE 1024
+
+// The implementation before trimming moved a read offset
+typedef struct {
+    char* data;
+    size_t size, capacity;
+} LegacyBuffer;
+
+static void LegacyInit(LegacyBuffer* buffer) {
+    buffer->size = 0;
+    buffer->capacity = 16;
+    buffer->data = (char*)malloc(buffer->capacity);
+}
+
+static void LegacyDeinit(LegacyBuffer* buffer) { free(buffer->data); }
+
+static void LegacyAppend(LegacyBuffer* buffer, const char* new_data, size_t new_data_size) {
+    if (buffer->size + new_data_size >= buffer->capacity) {
+        buffer->capacity = (buffer->size + new_data_size) * 2;
+        buffer->data = (char*)realloc(buffer->data, buffer->capacity);
+    }
+    memcpy(buffer->data + buffer->size, new_data, new_data_size);
+    buffer->size += new_data_size;
+}
+
+static void LegacyTrimLeft(LegacyBuffer* buffer, size_t trim_amount) {
+    const size_t remainder = buffer->size - trim_amount;
+    for (size_t i = 0; i < remainder; ++i)
+        buffer->data[i] = buffer->data[i + trim_amount];
+    buffer->size -= trim_amount;
+}
+
+static double MonotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Stands in for send(), which takes at most a partial write from the front of the buffer
+static size_t sent_checksum = 0;
+
+static size_t Send(const char* data, size_t size) {
+    const size_t sent = size < PARTIAL_WRITE_SIZE ? size : PARTIAL_WRITE_SIZE;
+    sent_checksum += (unsigned char)data[0] + (unsigned char)data[sent - 1];
+    return sent;
+}
+
+// Returns the seconds it took to send the whole backlog, together with the messages that arrived meanwhile
+static double MeasureLegacy(size_t backlog_size, const char* message) {
+    LegacyBuffer buffer;
+    LegacyInit(&buffer);
+    while (buffer.size < backlog_size)
+        LegacyAppend(&buffer, message, MESSAGE_SIZE);
+
+    const double start = MonotonicSeconds();
+    size_t arriving = backlog_size / PARTIAL_WRITE_SIZE;
+    while (buffer.size > 0) {
+        LegacyTrimLeft(&buffer, Send(buffer.data, buffer.size));
+        if (arriving > 0) {
+            LegacyAppend(&buffer, message, MESSAGE_SIZE);
+            --arriving;
+        }
+    }
+    const double elapsed = MonotonicSeconds() - start;
+    LegacyDeinit(&buffer);
+    return elapsed;
+}
+
+static double Measure(size_t backlog_size, const char* message) {
+    DynamicBuffer buffer;
+    DynamicBufferInit(&buffer);
+    while (buffer.size < backlog_size)
+        DynamicBufferAppend(&buffer, message, MESSAGE_SIZE);
+
+    const double start = MonotonicSeconds();
+    size_t arriving = backlog_size / PARTIAL_WRITE_SIZE;
+    while (buffer.size > 0) {
+        DynamicBufferTrimLeft(&buffer, Send(buffer.data, buffer.size));
+        if (arriving > 0) {
+            DynamicBufferAppend(&buffer, message, MESSAGE_SIZE);
+            --arriving;
+        }
+    }
+    const double elapsed = MonotonicSeconds() - start;
+    DynamicBufferDeinit(&buffer);
+    return elapsed;
+}
+
+int main(int argc, char** argv) {
+    long long default_megabytes[] = {1, 8, 64};
+    const int count = argc > 1 ? argc - 1 : (int)(sizeof(default_megabytes) / sizeof(default_megabytes[0]));
+
+    char message[MESSAGE_SIZE];
+    for (size_t i = 0; i < MESSAGE_SIZE; ++i)
+        message[i] = (char)('a' + i % 26);
+
+    printf("%10s %16s %16s\n", "backlog", "legacy (ms)", "offset (ms)");
+    for (int i = 0; i < count; ++i) {
+        const long long megabytes = argc > 1 ? strtoll(argv[i + 1], NULL, 10) : default_megabytes[i];
+        if (megabytes < 1) {
+            fprintf(stderr, "The backlog has at least 1 megabyte\n");
+            return 1;
+        }
+        const size_t backlog_size = (size_t)megabytes * 1024 * 1024;
+
+        const double legacy = MeasureLegacy(backlog_size, message);
+        const double current = Measure(backlog_size, message);
+        printf("%8lldMB %16.3f %16.3f\n", megabytes, legacy * 1e3, current * 1e3);
+    }
+    return sent_checksum == 0;
+}
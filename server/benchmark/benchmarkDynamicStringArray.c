@@ -0,0 +1,179 @@
+// Counts the allocations of DynamicStringArray against the previous implementation, which allocated every string
+// separately, and measures how long they take
+// Usage: benchmarkDynamicStringArray [STRING_COUNT...], by default 10, 1000 and 100000 strings are used
+// Allocations are counted by replacing malloc, calloc and realloc, which only works with glibc
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../DynamicStringArray.h"
+
+#define MINIMUM_SECONDS_PER_MEASUREMENT 0.3
+
+static size_t allocations = 0;
+
+extern void* __libc_malloc(size_t);
+extern void* __libc_calloc(size_t, size_t);
+extern void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t size) {
+    ++allocations;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    ++allocations;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    ++allocations;
+    return __libc_realloc(pointer, size);
+}
+
+// The implementation before the strings were put in an arena
+typedef struct {
+    char** data;
+    size_t size, capacity;
+} LegacyStringArray;
+
+static void LegacyInit(LegacyStringArray* string_array) {
+    string_array->size = 0;
+    string_array->capacity = 16;
+    string_array->data = (char**)malloc(string_array->capacity * sizeof(char*));
+}
+
+static void LegacyClear(LegacyStringArray* string_array) {
+    for (size_t i = 0; i < string_array->size; ++i)
+        free(string_array->data[i]);
+    string_array->size = 0;
+}
+
+static void LegacyDeinit(LegacyStringArray* string_array) {
+    LegacyClear(string_array);
+    free(string_array->data);
+}
+
+static void LegacyAppend(LegacyStringArray* string_array, const char* item) {
+    if (string_array->size == string_array->capacity) {
+        string_array->capacity *= 2;
+        string_array->data = (char**)realloc(string_array->data, string_array->capacity * sizeof(char*));
+    }
+    const size_t item_length = strlen(item);
+    string_array->data[string_array->size] = (char*)malloc(item_length + 1);
+    memcpy(string_array->data[string_array->size], item, item_length + 1);
+    ++string_array->size;
+}
+
+static void LegacyCopy(const LegacyStringArray* source, LegacyStringArray* destination) {
+    destination->size = source->size;
+    destination->capacity = source->capacity;
+    destination->data = (char**)malloc(source->capacity * sizeof(char*));
+    for (size_t i = 0; i < destination->size; ++i) {
+        const size_t item_length = strlen(source->data[i]);
+        destination->data[i] = (char*)malloc(item_length + 1);
+        memcpy(destination->data[i], source->data[i], item_length + 1);
+    }
+}
+
+typedef struct {
+    LegacyStringArray legacy;
+    DynamicStringArray current;
+    long long count;
+} Arrays;
+
+typedef void (*Operation)(Arrays*);
+
+static void MakeFile(char* file, size_t file_size, long long i) {
+    snprintf(file, file_size, "/project/build/lib/lib%lld.so", i);
+}
+
+static void LegacyCopyOperation(Arrays* arrays) {
+    LegacyStringArray copy;
+    LegacyCopy(&arrays->legacy, &copy);
+    LegacyDeinit(&copy);
+}
+
+static void CopyOperation(Arrays* arrays) {
+    DynamicStringArray copy;
+    DynamicStringArrayCopy(&arrays->current, &copy);
+    DynamicStringArrayDeinit(&copy);
+}
+
+static void ShareOperation(Arrays* arrays) {
+    DynamicStringArray share;
+    DynamicStringArrayShare(&arrays->current, &share);
+    DynamicStringArrayDeinit(&share);
+}
+
+// Like a report of the Bootstrapper, which fills the same array again on every event loop iteration
+static void LegacyRefillOperation(Arrays* arrays) {
+    LegacyClear(&arrays->legacy);
+    char file[64];
+    for (long long i = 0; i < arrays->count; ++i) {
+        MakeFile(file, sizeof(file), i);
+        LegacyAppend(&arrays->legacy, file);
+    }
+}
+
+static void RefillOperation(Arrays* arrays) {
+    DynamicStringArrayClear(&arrays->current);
+    char file[64];
+    for (long long i = 0; i < arrays->count; ++i) {
+        MakeFile(file, sizeof(file), i);
+        DynamicStringArrayAppend(&arrays->current, file);
+    }
+}
+
+static double MonotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Prints the allocations of a single run and the average time of a run
+static void Measure(const char* name, Operation operation, Arrays* arrays) {
+    // Warms up, a refill reuses what the previous one allocated
+    operation(arrays);
+
+    const size_t allocations_before = allocations;
+    operation(arrays);
+    const size_t run_allocations = allocations - allocations_before;
+
+    int runs = 0;
+    const double start = MonotonicSeconds();
+    double elapsed;
+    do {
+        operation(arrays);
+        ++runs;
+        elapsed = MonotonicSeconds() - start;
+    } while (elapsed < MINIMUM_SECONDS_PER_MEASUREMENT);
+    printf("%10lld %16s %16lu %16.3f\n", arrays->count, name, run_allocations, elapsed / runs * 1e6);
+}
+
+int main(int argc, char** argv) {
+    long long default_counts[] = {10, 1000, 100000};
+    const int count = argc > 1 ? argc - 1 : (int)(sizeof(default_counts) / sizeof(default_counts[0]));
+
+    printf("%10s %16s %16s %16s\n", "strings", "operation", "allocations", "time (us)");
+    for (int i = 0; i < count; ++i) {
+        Arrays arrays;
+        arrays.count = argc > 1 ? strtoll(argv[i + 1], NULL, 10) : default_counts[i];
+        LegacyInit(&arrays.legacy);
+        DynamicStringArrayInit(&arrays.current);
+        LegacyRefillOperation(&arrays);
+        RefillOperation(&arrays);
+
+        Measure("legacy copy", &LegacyCopyOperation, &arrays);
+        Measure("copy", &CopyOperation, &arrays);
+        Measure("share", &ShareOperation, &arrays);
+        Measure("legacy refill", &LegacyRefillOperation, &arrays);
+        Measure("refill", &RefillOperation, &arrays);
+
+        LegacyDeinit(&arrays.legacy);
+        DynamicStringArrayDeinit(&arrays.current);
+    }
+    return 0;
+}
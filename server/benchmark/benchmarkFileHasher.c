@@ -0,0 +1,125 @@
+// Measures FileHasher_Do throughput against the previous 512-byte fread implementation, and XXH64 next to them
+// Usage: benchmarkFileHasher [SIZE_MB...], by default 1, 100 and 1024 MB files are hashed
+// The files are created in $TMPDIR (or /tmp) and are hashed while they are in the page cache
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <openssl/sha.h>
+
+#include "../FileHasher.h"
+
+#define MINIMUM_BYTES_PER_MEASUREMENT (2LL * 1024 * 1024 * 1024)
+#define MINIMUM_RUNS 3
+
+// The implementation before large reads were used, with its hexadecimal output
+static void LegacyFileHasher_Do(const char* file, char** hash, size_t* hash_length) {
+    FILE* file_handle = fopen(file, "rb");
+    if (!file_handle) {
+        *hash = "";
+        *hash_length = 0;
+        return;
+    }
+    unsigned char read_buffer[512];
+    SHA_CTX sha1_context;
+    SHA1_Init(&sha1_context);
+    size_t bytes_read;
+    while ((bytes_read = fread(read_buffer, sizeof(char), 512, file_handle)) > 0) {
+        SHA1_Update(&sha1_context, read_buffer, bytes_read);
+    }
+
+    unsigned char hash_buffer[SHA_DIGEST_LENGTH];
+    SHA1_Final(hash_buffer, &sha1_context);
+
+    *hash_length = SHA_DIGEST_LENGTH * 2;
+    *hash = (char*)malloc(*hash_length + 1);
+    for (int i = 0; i < SHA_DIGEST_LENGTH; ++i)
+        sprintf(&(*hash)[i * 2], "%x", hash_buffer[i]);
+
+    fclose(file_handle);
+}
+
+// Measure takes the current signature, the legacy hex string is freed right away like its callers used to
+static int LegacyFileHasher_DoDigest(const char* file, Digest* digest) {
+    char* hash;
+    size_t hash_length;
+    LegacyFileHasher_Do(file, &hash, &hash_length);
+    DigestClear(digest);
+    if (hash_length == 0)
+        return 0;
+    free(hash);
+    return 1;
+}
+
+static double MonotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Returns FALSE when the file could not be written
+static int CreateFile(const char* file, long long size) {
+    FILE* file_handle = fopen(file, "wb");
+    if (!file_handle)
+        return 0;
+
+    const size_t block_size = 1024 * 1024;
+    unsigned char* block = (unsigned char*)malloc(block_size);
+    for (size_t i = 0; i < block_size; ++i)
+        block[i] = (unsigned char)rand();
+
+    int written = 1;
+    for (long long remaining = size; remaining > 0 && written; remaining -= block_size) {
+        const size_t write_size = remaining < (long long)block_size ? (size_t)remaining : block_size;
+        written = fwrite(block, 1, write_size, file_handle) == write_size;
+    }
+    free(block);
+    return fclose(file_handle) == 0 && written;
+}
+
+// Returns the throughput in GB/s
+static double Measure(FileHasherFunction hashFile, const char* file, long long size) {
+    Digest digest;
+
+    // Warms up the page cache
+    hashFile(file, &digest);
+
+    int runs = 0;
+    const double start = MonotonicSeconds();
+    while (runs < MINIMUM_RUNS || (long long)runs * size < MINIMUM_BYTES_PER_MEASUREMENT) {
+        hashFile(file, &digest);
+        ++runs;
+    }
+    const double elapsed = MonotonicSeconds() - start;
+    return (double)size * runs / elapsed / 1e9;
+}
+
+int main(int argc, char** argv) {
+    long long default_sizes_mb[] = {1, 100, 1024};
+    const int size_count = argc > 1 ? argc - 1 : (int)(sizeof(default_sizes_mb) / sizeof(default_sizes_mb[0]));
+
+    const char* temporary_directory = getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+    char file[4096];
+    snprintf(file, sizeof(file), "%s/benchmarkFileHasher.%d", temporary_directory, (int)getpid());
+
+    printf("%10s %16s %16s %16s\n", "size (MB)", "legacy (GB/s)", "current (GB/s)", "xxh64 (GB/s)");
+    for (int i = 0; i < size_count; ++i) {
+        const long long size_mb = argc > 1 ? strtoll(argv[i + 1], NULL, 10) : default_sizes_mb[i];
+        const long long size = size_mb * 1024 * 1024;
+        if (!CreateFile(file, size)) {
+            fprintf(stderr, "Unable to create a %lld MB file at %s\n", size_mb, file);
+            remove(file);
+            return 1;
+        }
+
+        const double legacy = Measure(&LegacyFileHasher_DoDigest, file, size);
+        const double current = Measure(&FileHasher_Do, file, size);
+        const double xxh64 = Measure(&FileHasher_DoXXH64, file, size);
+        printf("%10lld %16.3f %16.3f %16.3f\n", size_mb, legacy, current, xxh64);
+        remove(file);
+    }
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Compares the JSON and the binary encoding of a project description: their size, how many allocations loading
+// takes and how long dumping and loading take
+// Usage: benchmarkProjectDescription [FILE_COUNT...], by default 10, 1000 and 10000 files are used
+// Allocations are counted by replacing malloc, calloc and realloc, which only works with glibc
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../ProjectDescription.h"
+#include "../ProjectDescription_binary.h"
+#include "../ProjectDescription_json.h"
+
+#define MINIMUM_SECONDS_PER_MEASUREMENT 0.3
+#define FILE_HASH "da39a3ee5e6b4b0d3255bfef95601890afd80709"
+
+static size_t allocations = 0;
+
+extern void* __libc_malloc(size_t);
+extern void* __libc_calloc(size_t, size_t);
+extern void* __libc_realloc(void*, size_t);
+
+void* malloc(size_t size) {
+    ++allocations;
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) {
+    ++allocations;
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* pointer, size_t size) {
+    ++allocations;
+    return __libc_realloc(pointer, size);
+}
+
+typedef struct {
+    ProjectDescription description;
+    char* json;
+    uint8_t* binary;
+    size_t binary_size;
+} Encodings;
+
+typedef void (*Operation)(Encodings*);
+
+static void MakeDescription(ProjectDescription* description, long long file_count) {
+    ProjectDescriptionInit(description, "/home/user/project/build/bin/app", FILE_HASH);
+    char file[96];
+    for (long long i = 1; i < file_count; ++i) {
+        snprintf(file, sizeof(file), "/home/user/project/build/lib/component%lld/libcomponent%lld.so", i % 50, i);
+        DynamicStringArrayAppend(&description->link_dependencies_for_executable, file);
+        DynamicStringArrayAppend(&description->link_dependencies_for_executable_hashes, FILE_HASH);
+        DynamicFileSizeArrayAppend(&description->link_dependencies_for_executable_sizes, 100000 + i);
+    }
+}
+
+static void DumpJSONOperation(Encodings* encodings) { free(ProjectDescriptionDumpToJSON(&encodings->description)); }
+
+static void DumpBinaryOperation(Encodings* encodings) {
+    uint8_t* binary;
+    size_t binary_size;
+    if (ProjectDescriptionDumpToBinary(&encodings->description, &binary, &binary_size))
+        free(binary);
+}
+
+static void LoadJSONOperation(Encodings* encodings) {
+    ProjectDescription description;
+    if (ProjectDescriptionLoadFromJSON(encodings->json, &description))
+        ProjectDescriptionDeinit(&description);
+}
+
+static void LoadBinaryOperation(Encodings* encodings) {
+    ProjectDescription description;
+    if (ProjectDescriptionLoadFromBinary(encodings->binary, encodings->binary_size, &description))
+        ProjectDescriptionDeinit(&description);
+}
+
+static double MonotonicSeconds() {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Prints the allocations of a single run and the average time of a run
+static void Measure(long long file_count, const char* name, Operation operation, Encodings* encodings) {
+    const size_t allocations_before = allocations;
+    operation(encodings);
+    const size_t run_allocations = allocations - allocations_before;
+
+    int runs = 0;
+    const double start = MonotonicSeconds();
+    double elapsed;
+    do {
+        operation(encodings);
+        ++runs;
+        elapsed = MonotonicSeconds() - start;
+    } while (elapsed < MINIMUM_SECONDS_PER_MEASUREMENT);
+    printf("%10lld %16s %16lu %16.3f\n", file_count, name, run_allocations, elapsed / runs * 1e3);
+}
+
+int main(int argc, char** argv) {
+    long long default_file_counts[] = {10, 1000, 10000};
+    const int count = argc > 1 ? argc - 1 : (int)(sizeof(default_file_counts) / sizeof(default_file_counts[0]));
+
+    printf("%10s %16s %16s %16s\n", "files", "operation", "allocations", "time (ms)");
+    for (int i = 0; i < count; ++i) {
+        const long long file_count = argc > 1 ? strtoll(argv[i + 1], NULL, 10) : default_file_counts[i];
+        if (file_count < 1) {
+            fprintf(stderr, "A project description has at least 1 file\n");
+            return 1;
+        }
+
+        Encodings encodings;
+        MakeDescription(&encodings.description, file_count);
+        encodings.json = ProjectDescriptionDumpToJSON(&encodings.description);
+        if (!ProjectDescriptionDumpToBinary(&encodings.description, &encodings.binary, &encodings.binary_size)) {
+            fprintf(stderr, "The description can't be dumped to binary\n");
+            return 1;
+        }
+        printf("%10lld %16s %16s %16s (JSON %zu bytes, binary %zu bytes)\n", file_count, "", "", "",
+               strlen(encodings.json) + 1, encodings.binary_size);
+
+        Measure(file_count, "dump JSON", &DumpJSONOperation, &encodings);
+        Measure(file_count, "dump binary", &DumpBinaryOperation, &encodings);
+        Measure(file_count, "load JSON", &LoadJSONOperation, &encodings);
+        Measure(file_count, "load binary", &LoadBinaryOperation, &encodings);
+
+        free(encodings.json);
+        free(encodings.binary);
+        ProjectDescriptionDeinit(&encodings.description);
+    }
+    return 0;
+}
@@ -1,4 +1,5 @@
 #include <argp.h>
+#include <limits.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,17 +15,42 @@ static char doc[] = "DebuggerBootstrap -- Automatically runs GDBServer when the
 
 static char args_doc[] = "[-p PORT] [--gdbserver-binary PATH]";
 
+// Keys for options that only have a long name
+enum { OPTION_SETTLE_TIME = 0x100, OPTION_HASH_THREADS, OPTION_HASH_INDEX, OPTION_POLL, OPTION_BACKLOG,
+       OPTION_SUBSCRIBER_BUDGET, OPTION_SUBSCRIBER_FRAMES, OPTION_DISCONNECT_SLOW_SUBSCRIBERS,
+       OPTION_OUTPUT_BATCH, OPTION_OUTPUT_DELAY };
+
 static struct argp_option options[] = {{"verbose", 'v', 0, 0, "Produce verbose output"},
                                        {"quiet", 'q', 0, 0, "Don't produce any output"},
                                        {"silent", 's', 0, OPTION_ALIAS},
                                        {"port", 'p', "PORT", 0, "Run DebuggerBootstrap at the given PORT"},
                                        {"gdbserver-binary", 'g', "PATH", 0, "Use the GDBServer located at PATH"},
+                                       {"settle-time", OPTION_SETTLE_TIME, "MS", 0,
+                                        "Check a changed project file only after MS milliseconds without writes"},
+                                       {"hash-threads", OPTION_HASH_THREADS, "N", 0,
+                                        "Hash changed project files on N threads, 0 hashes them on the main thread"},
+                                       {"hash-index", OPTION_HASH_INDEX, "PATH", 0,
+                                        "Remember file hashes across restarts in the index file at PATH"},
+                                       {"poll", OPTION_POLL, 0, 0, "Wait for events with poll() instead of epoll"},
+                                       {"backlog", OPTION_BACKLOG, "N", 0,
+                                        "Let up to N connections wait to be accepted"},
+                                       {"subscriber-budget", OPTION_SUBSCRIBER_BUDGET, "BYTES", 0,
+                                        "Let up to BYTES bytes wait to be sent to a subscriber"},
+                                       {"subscriber-frames", OPTION_SUBSCRIBER_FRAMES, "N", 0,
+                                        "Let up to N messages wait to be sent to a subscriber"},
+                                       {"disconnect-slow-subscribers", OPTION_DISCONNECT_SLOW_SUBSCRIBERS, 0, 0,
+                                        "Disconnect a subscriber over budget instead of dropping its debugger output"},
+                                       {"output-batch", OPTION_OUTPUT_BATCH, "BYTES", 0,
+                                        "Broadcast debugger output in messages of up to BYTES bytes"},
+                                       {"output-delay", OPTION_OUTPUT_DELAY, "MS", 0,
+                                        "Broadcast debugger output at most MS milliseconds after it was printed"},
                                        {0}};
 
 struct arguments {
     char* gdbserver_binary;
     int port;
     int verbose, silent;
+    EventDispatchOptions event_dispatch_options;
 };
 
 static error_t parse_opt(int key, char* arg, struct argp_state* state) {
@@ -49,6 +75,66 @@ static error_t parse_opt(int key, char* arg, struct argp_state* state) {
         if (errno != 0)
             // The port could not be parsed as int
             argp_usage(state);
+        break;
+    }
+    case OPTION_SETTLE_TIME: {
+        errno = 0;
+        arguments->event_dispatch_options.file_settle_time_ms = strtoll(arg, NULL, 10);
+        if (errno != 0 || arguments->event_dispatch_options.file_settle_time_ms < 0)
+            argp_usage(state);
+        break;
+    }
+    case OPTION_HASH_THREADS: {
+        errno = 0;
+        const long long hash_threads = strtoll(arg, NULL, 10);
+        if (errno != 0 || hash_threads < 0)
+            argp_usage(state);
+        arguments->event_dispatch_options.hash_threads = (size_t)hash_threads;
+        break;
+    }
+    case OPTION_HASH_INDEX:
+        arguments->event_dispatch_options.hash_index_path = arg;
+        break;
+    case OPTION_POLL:
+        arguments->event_dispatch_options.use_poll = 1;
+        break;
+    case OPTION_BACKLOG: {
+        errno = 0;
+        const long long backlog = strtoll(arg, NULL, 10);
+        if (errno != 0 || backlog <= 0 || backlog > INT_MAX)
+            argp_usage(state);
+        arguments->event_dispatch_options.listen_backlog = (int)backlog;
+        break;
+    }
+    case OPTION_SUBSCRIBER_BUDGET:
+    case OPTION_SUBSCRIBER_FRAMES: {
+        errno = 0;
+        const long long budget = strtoll(arg, NULL, 10);
+        if (errno != 0 || budget <= 0)
+            argp_usage(state);
+        if (key == OPTION_SUBSCRIBER_BUDGET)
+            arguments->event_dispatch_options.subscriber_budget_bytes = (size_t)budget;
+        else
+            arguments->event_dispatch_options.subscriber_budget_frames = (size_t)budget;
+        break;
+    }
+    case OPTION_DISCONNECT_SLOW_SUBSCRIBERS:
+        arguments->event_dispatch_options.subscriber_overflow_policy = SUBSCRIBER_OVERFLOW_DISCONNECT;
+        break;
+    case OPTION_OUTPUT_BATCH: {
+        errno = 0;
+        const long long batch_size = strtoll(arg, NULL, 10);
+        if (errno != 0 || batch_size <= 0)
+            argp_usage(state);
+        arguments->event_dispatch_options.debugger_output_batch_size = (size_t)batch_size;
+        break;
+    }
+    case OPTION_OUTPUT_DELAY: {
+        errno = 0;
+        arguments->event_dispatch_options.debugger_output_delay_ms = strtoll(arg, NULL, 10);
+        if (errno != 0 || arguments->event_dispatch_options.debugger_output_delay_ms < 0)
+            argp_usage(state);
+        break;
     }
 
     case ARGP_KEY_ARG:
@@ -71,6 +157,7 @@ void SetDefaults(struct arguments* arguments) {
     arguments->port = 0;
     arguments->silent = 0;
     arguments->verbose = 0;
+    EventDispatchOptionsSetDefaults(&arguments->event_dispatch_options);
 }
 
 static void RetrieveArguments(int argc, char** argv, struct arguments* arguments) {
@@ -118,7 +205,7 @@ int main(int argc, char** argv) {
     RetrieveArguments(argc, argv, &arguments);
     debugger_arguments.debugger_path = arguments.gdbserver_binary;
 
-    StartEventDispatch(arguments.port, &debugger_arguments);
+    StartEventDispatch(arguments.port, &debugger_arguments, &arguments.event_dispatch_options);
 
     DynamicStringArrayDeinit(&debugger_arguments.debugger_args);
     return 0;
@@ -5,46 +5,164 @@
 
 #include "../ProjectDescription.h"
 
-void MakeProjectDescriptionPacket(const char* project_description_json_string, uint8_t** packet, size_t* packet_size) {
-    const uint8_t version = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION;
+static void WriteHeader(uint8_t* header, DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type, uint16_t flags,
+                        size_t payload_size) {
+    header[0] = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION;
+    header[1] = type;
+    header[2] = flags & 0xff;
+    header[3] = flags >> 8;
+    for (int i = 0; i < 4; ++i)
+        header[4 + i] = (payload_size >> (8 * i)) & 0xff;
+}
 
+void MakeProjectDescriptionPacket(const char* project_description_json_string, uint8_t** packet, size_t* packet_size) {
     size_t json_length = strlen(project_description_json_string) + 1;
     *packet_size = PACKET_HEADER_SIZE * sizeof(uint8_t) + json_length;
 
     *packet = (uint8_t*)malloc(*packet_size);
     uint8_t* packet_content = *packet;
-    packet_content[0] = version;
-    packet_content[1] = DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION;
+    WriteHeader(packet_content, DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION, 0, json_length);
     memcpy(packet_content + PACKET_HEADER_SIZE, project_description_json_string, json_length);
 }
 
+static void MakeBinaryPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type, const uint8_t* binary, size_t binary_size,
+                             uint8_t** packet, size_t* packet_size) {
+    *packet_size = PACKET_HEADER_SIZE + binary_size;
+    *packet = (uint8_t*)malloc(*packet_size);
+    WriteHeader(*packet, type, 0, binary_size);
+    memcpy(*packet + PACKET_HEADER_SIZE, binary, binary_size);
+}
+
+void MakeBinaryProjectDescriptionPacket(const uint8_t* binary_project_description, size_t binary_size,
+                                        uint8_t** packet, size_t* packet_size) {
+    MakeBinaryPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_BINARY_PROJECT_DESCRIPTION, binary_project_description,
+                     binary_size, packet, packet_size);
+}
+
+void MakeProjectDescriptionDeltaPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type, const uint8_t* binary_delta,
+                                       size_t binary_size, uint8_t** packet, size_t* packet_size) {
+    MakeBinaryPacket(type, binary_delta, binary_size, packet, packet_size);
+}
+
+static int HasPayload(uint8_t type) {
+    return type == DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION ||
+           type == DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE;
+}
+
+static DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodeFrameV1(const uint8_t* packet, size_t packet_size,
+                                                             PacketFrame* frame, int complete) {
+    const uint8_t type = packet[1];
+    // The packet types from the binary project description on were added with version 2, binary content can't be
+    // ended with a '\0'
+    if (type >= DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_BINARY_PROJECT_DESCRIPTION)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN;
+    frame->version = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1;
+    frame->flags = 0;
+    frame->payload_offset = PACKET_HEADER_SIZE_V1;
+    frame->payload_size = 0;
+    frame->packet_size = PACKET_HEADER_SIZE_V1;
+    if (!HasPayload(type))
+        return type;
+
+    size_t null_terminator_index;
+    if (!FindNullTerminator(&packet[PACKET_HEADER_SIZE_V1], packet_size - PACKET_HEADER_SIZE_V1,
+                            &null_terminator_index)) {
+        if (complete)
+            return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
+        frame->payload_size = PACKET_PAYLOAD_SIZE_UNKNOWN;
+        frame->packet_size = PACKET_PAYLOAD_SIZE_UNKNOWN;
+        return type;
+    }
+    frame->payload_size = null_terminator_index + 1;
+    frame->packet_size = PACKET_HEADER_SIZE_V1 + null_terminator_index + 1;
+    return type;
+}
+
+// With 'complete', a packet whose payload hasn't fully arrived yet is INCOMPLETE
+static DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodeFrameV2(const uint8_t* packet, size_t packet_size,
+                                                             PacketFrame* frame, int complete) {
+    if (packet_size < PACKET_HEADER_SIZE)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
+    size_t payload_size = 0;
+    for (int i = 0; i < 4; ++i)
+        payload_size |= (size_t)packet[4 + i] << (8 * i);
+    if (payload_size > PACKET_MAXIMAL_PAYLOAD_SIZE)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN;
+    if (complete && packet_size - PACKET_HEADER_SIZE < payload_size)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
+
+    frame->version = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION;
+    frame->flags = packet[2] | (uint16_t)(packet[3] << 8);
+    frame->payload_offset = PACKET_HEADER_SIZE;
+    frame->payload_size = payload_size;
+    frame->packet_size = PACKET_HEADER_SIZE + payload_size;
+    return packet[1];
+}
+
+static DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodeFrame(const uint8_t* packet, size_t packet_size,
+                                                           PacketFrame* frame, int complete) {
+    if (packet_size < PACKET_HEADER_SIZE_V1)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
+    if (packet[1] == 0 || packet[1] >= DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN;
+    switch (packet[0]) {
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1:
+        return DecodeFrameV1(packet, packet_size, frame, complete);
+    case DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION:
+        return DecodeFrameV2(packet, packet_size, frame, complete);
+    }
+    return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN;
+}
+
+DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacketFrame(const uint8_t* packet, size_t packet_size,
+                                                          PacketFrame* frame) {
+    return DecodeFrame(packet, packet_size, frame, 1);
+}
+
+DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacketHeader(const uint8_t* packet, size_t packet_size,
+                                                           PacketFrame* frame) {
+    return DecodeFrame(packet, packet_size, frame, 0);
+}
+
 DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacket(const uint8_t* packet, size_t packet_size,
                                                      size_t* json_part_offset) {
-    if (packet_size < PACKET_HEADER_SIZE)
+    if (packet_size < PACKET_HEADER_SIZE_V1)
         return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
-    if (packet[0] != DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION)
+    if (packet[0] == DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1)
+        *json_part_offset = PACKET_HEADER_SIZE_V1;
+    else if (packet[0] == DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION)
+        *json_part_offset = PACKET_HEADER_SIZE;
+    else
         return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN;
-    *json_part_offset = PACKET_HEADER_SIZE;
+    if (packet_size < *json_part_offset)
+        return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
     if (packet[1] >= DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN)
         return DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN;
     return packet[1];
 }
 
 static void MakeHeaderOnlyPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type, uint8_t** packet, size_t* packet_size) {
-    const uint8_t version = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION;
     *packet_size = PACKET_HEADER_SIZE;
     *packet = (uint8_t*)malloc(*packet_size);
-    uint8_t* packet_content = *packet;
-    packet_content[0] = version;
-    packet_content[1] = type;
+    WriteHeader(*packet, type, 0, 0);
 }
 
 void MakeRequestSubscriptionPacket(uint8_t** packet, size_t* packet_size) {
     MakeHeaderOnlyPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_REQUEST, packet, packet_size);
 }
 
-void MakeSubscriptionResponsePacketHeader(uint8_t** packet, size_t* packet_size) {
-    MakeHeaderOnlyPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE, packet, packet_size);
+void MakeSubscriptionResponsePacketHeader(uint8_t version, size_t message_size, uint8_t** packet,
+                                          size_t* packet_size) {
+    if (version == DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1) {
+        *packet_size = PACKET_HEADER_SIZE_V1;
+        *packet = (uint8_t*)malloc(*packet_size);
+        (*packet)[0] = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1;
+        (*packet)[1] = DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE;
+        return;
+    }
+    *packet_size = PACKET_HEADER_SIZE;
+    *packet = (uint8_t*)malloc(*packet_size);
+    WriteHeader(*packet, DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE, 0, message_size);
 }
 
 void MakeForceStartDebuggerPacket(uint8_t** packet, size_t* packet_size) {
@@ -55,12 +173,14 @@ void MakeForceStopDebuggerPacket(uint8_t** packet, size_t* packet_size) {
     MakeHeaderOnlyPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_STOP, packet, packet_size);
 }
 
+void MakeProjectResyncRequestPacket(uint8_t** packet, size_t* packet_size) {
+    MakeHeaderOnlyPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_RESYNC_REQUEST, packet, packet_size);
+}
+
 int FindNullTerminator(const uint8_t* packet, size_t packet_size, size_t* position) {
-    for (size_t i = 0; i < packet_size; ++i) {
-        if (packet[i] == '\0') {
-            *position = i;
-            return 1;
-        }
-    }
-    return 0;
-}
\ No newline at end of file
+    const uint8_t* null_terminator = (const uint8_t*)memchr(packet, '\0', packet_size);
+    if (!null_terminator)
+        return 0;
+    *position = null_terminator - packet;
+    return 1;
+}
@@ -5,10 +5,22 @@
 
 struct ProjectDescription;
 
-#define DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION 0x1
-#define PACKET_HEADER_SIZE 2
+// Packets are made with version 2, packets of version 1 are still decoded
+// Version 1: a header of [version, type], a packet with content ends at the first '\0'
+// Version 2: a header of [version, type, flags (2 bytes), payload size (4 bytes)], sizes are little endian
+// The payload of a version 2 packet still ends with a '\0', so that it can be used as a string in place
+#define DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION 0x2
+#define DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1 0x1
+#define PACKET_HEADER_SIZE 8
+#define PACKET_HEADER_SIZE_V1 2
+// A larger payload size is taken for garbage rather than waited for
+#define PACKET_MAXIMAL_PAYLOAD_SIZE (256u * 1024u * 1024u)
 
 void MakeProjectDescriptionPacket(const char* project_description_json_string, uint8_t** packet, size_t* packet_size);
+// The payload is a project description in the binary format of ProjectDescription_binary.h, this packet type only
+// exists in version 2
+void MakeBinaryProjectDescriptionPacket(const uint8_t* binary_project_description, size_t binary_size,
+                                        uint8_t** packet, size_t* packet_size);
 
 typedef enum _DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE {
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION = 1,
@@ -16,20 +28,53 @@ typedef enum _DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE {
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE,
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_START,
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_FORCE_DEBUGGER_STOP,
+    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_BINARY_PROJECT_DESCRIPTION,
+    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UPSERT_PROJECT_ENTRIES,
+    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_REMOVE_PROJECT_ENTRIES,
+    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SET_PROJECT_EXECUTABLE,
+    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_RESYNC_REQUEST,
 
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE,
     DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN
 } DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE;
 
+typedef struct {
+    uint8_t version;
+    uint16_t flags; // None are defined yet, so they are ignored
+    size_t payload_offset, payload_size;
+    size_t packet_size; // The header and the payload, the amount of bytes to drop once the packet is handled
+} PacketFrame;
+
+// Only fills in 'frame' for a complete packet
+// A version 2 packet is known to be complete from its header, only version 1 packets are scanned for their '\0'
+DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacketFrame(const uint8_t* packet, size_t packet_size,
+                                                          PacketFrame* frame);
+// Fills in 'frame' as soon as the header is complete, so that a payload can be handled while it arrives
+// The payload of a version 1 packet ends at its first '\0', until that arrived its payload size and packet size are
+// PACKET_PAYLOAD_SIZE_UNKNOWN
+#define PACKET_PAYLOAD_SIZE_UNKNOWN ((size_t)-1)
+DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacketHeader(const uint8_t* packet, size_t packet_size,
+                                                           PacketFrame* frame);
+// Only decodes the header, a packet with content might not be complete yet when its type is returned
 DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE DecodePacket(const uint8_t* packet, size_t packet_size,
                                                      size_t* json_part_offset);
 
 void MakeRequestSubscriptionPacket(uint8_t** packet, size_t* packet_size);
-// This is just a header, any human readable utf-8 content may be appended to the output stream after putting this
-// packet in the outputstream, a '\0' indicates the end of the packet
-void MakeSubscriptionResponsePacketHeader(uint8_t** packet, size_t* packet_size);
+// This is just a header, the 'message_size' bytes of human readable utf-8 content are put in the output stream after
+// this header, the content ends with a '\0' which is included in 'message_size'
+// A subscriber that requested with version 1 gets version 1 headers, which don't mention the size
+void MakeSubscriptionResponsePacketHeader(uint8_t version, size_t message_size, uint8_t** packet,
+                                          size_t* packet_size);
 
 void MakeForceStartDebuggerPacket(uint8_t** packet, size_t* packet_size);
 void MakeForceStopDebuggerPacket(uint8_t** packet, size_t* packet_size);
 
-int FindNullTerminator(const uint8_t* packet, size_t packet_size, size_t* position);
\ No newline at end of file
+// 'type' is one of the UPSERT_PROJECT_ENTRIES, REMOVE_PROJECT_ENTRIES and SET_PROJECT_EXECUTABLE types, the payload is
+// a delta in the binary format of ProjectDescription_binary.h, these packet types only exist in version 2
+void MakeProjectDescriptionDeltaPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE type, const uint8_t* binary_delta,
+                                       size_t binary_size, uint8_t** packet, size_t* packet_size);
+// Sent by the server to a client whose delta doesn't follow the current generation, or arrives before any project
+// description, the client answers with a full project description
+void MakeProjectResyncRequestPacket(uint8_t** packet, size_t* packet_size);
+
+int FindNullTerminator(const uint8_t* packet, size_t packet_size, size_t* position);
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+// An empty file in /tmp that is removed again when the test is done
+struct TemporaryFile {
+    explicit TemporaryFile(const char* prefix) {
+        std::string name_template = std::string("/tmp/") + prefix + "XXXXXX";
+        const int fd = mkstemp(&name_template[0]);
+        close(fd);
+        name = name_template;
+    }
+    ~TemporaryFile() { remove(name.c_str()); }
+
+    void Write(const std::string& content) const { std::ofstream(name, std::ios::binary) << content; }
+    off_t Size() const {
+        struct stat file_stat;
+        stat(name.c_str(), &file_stat);
+        return file_stat.st_size;
+    }
+
+    std::string name;
+};
@@ -1,19 +1,35 @@
 #include <gtest/gtest.h>
 
+#include <random>
 #include <unordered_map>
+#include <vector>
 
 extern "C" {
 #include "../Bootstrapper.h"
+#include "../Digest.h"
 #include "../ProjectDescription.h"
 }
 
 struct FakeUserdata {
     std::set<std::string> existing_files;
     std::unordered_map<std::string, std::string> hashes;
+    std::vector<std::string> requested_hashes;
+    std::unordered_map<std::string, long long> sizes;
+    std::vector<std::string> calculated_hashes;
+    int starts = 0, stops = 0;
+    int size_requests = 0;
 };
 
 static int FakeStartGDBServer(void*, char*, const DynamicStringArray*) { return 1; }
 static int FakeStopGDBServer(void*) { return 1; }
+static int CountingStartGDBServer(void* userdata, char*, const DynamicStringArray*) {
+    ++static_cast<FakeUserdata*>(userdata)->starts;
+    return 1;
+}
+static int CountingStopGDBServer(void* userdata) {
+    ++static_cast<FakeUserdata*>(userdata)->stops;
+    return 1;
+}
 static int FakeFileExists(const char* file_name, void* userdata) {
     if (userdata) {
         const auto* fake_userdata = static_cast<FakeUserdata*>(userdata);
@@ -21,15 +37,45 @@ static int FakeFileExists(const char* file_name, void* userdata) {
     }
     return 1;
 }
-static void FakeCalculateHash(const char* file_name, char** hash, size_t* hash_size, void* userdata) {
-    if (userdata) {
-        const auto* fake_userdata = static_cast<FakeUserdata*>(userdata);
-        const auto hashIt = fake_userdata->hashes.find(file_name);
-        ASSERT_NE(hashIt, fake_userdata->hashes.end()) << "Forgot to add a hash for file '" << file_name << "'?";
-        *hash_size = hashIt->second.size();
-        *hash = (char*)malloc(hashIt->second.size() + 1);
-        strcpy(*hash, hashIt->second.c_str());
-    }
+static int FakeCalculateHash(const char* file_name, Digest* digest, void* userdata) {
+    DigestClear(digest);
+    if (!userdata)
+        return 0;
+    auto* fake_userdata = static_cast<FakeUserdata*>(userdata);
+    fake_userdata->calculated_hashes.push_back(file_name);
+    const auto hashIt = fake_userdata->hashes.find(file_name);
+    EXPECT_NE(hashIt, fake_userdata->hashes.end()) << "Forgot to add a hash for file '" << file_name << "'?";
+    if (hashIt == fake_userdata->hashes.end())
+        return 0;
+    EXPECT_TRUE(DigestFromHex(hashIt->second.c_str(), digest)) << "The hash of '" << file_name << "' is not hex";
+    return !DigestIsEmpty(digest);
+}
+
+// Every hash arrives later through ReceiveFileHash
+static int FakeRequestHash(const char* file_name, Digest*, void* userdata) {
+    static_cast<FakeUserdata*>(userdata)->requested_hashes.push_back(file_name);
+    return 0;
+}
+
+static long long FakeFileSize(const char* file_name, void* userdata) {
+    auto* fake_userdata = static_cast<FakeUserdata*>(userdata);
+    ++fake_userdata->size_requests;
+    const auto sizeIt = fake_userdata->sizes.find(file_name);
+    return sizeIt == fake_userdata->sizes.end() ? -1 : sizeIt->second;
+}
+
+static Digest DigestOf(const char* hex) {
+    Digest digest;
+    DigestFromHex(hex, &digest);
+    return digest;
+}
+
+// Returns the amount of files that were hashed after the start decision was known
+static int HashAllDeferredFiles(Bootstrapper* bootstrapper) {
+    int hashed_files = 0;
+    while (HashDeferredFile(bootstrapper))
+        ++hashed_files;
+    return hashed_files;
 }
 
 TEST(testBootstrapper, Init) {
@@ -101,7 +147,7 @@ TEST(testBootstrapper, ReceiveNewProjectDescriptionTwice) {
 
 TEST(testBootstrapper, ReportMissingFiles) {
     FakeUserdata given_userdata{{"LightSpeedFileExplorer", "freetype.so"},
-                                {{"LightSpeedFileExplorer", "abcd"}, {"freetype.so", "efgh"}}};
+                                {{"LightSpeedFileExplorer", "abcd"}, {"freetype.so", "ef01"}}};
 
     struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
                                               &FakeStartGDBServer,
@@ -115,9 +161,9 @@ TEST(testBootstrapper, ReportMissingFiles) {
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "zlib.so");
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "libpng.so");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "efgh");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ijkl");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "mnop");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ef01");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "5678");
 
     ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
 
@@ -145,7 +191,7 @@ TEST(testBootstrapper, ReportMissingFiles) {
 TEST(testBootstrapper, ReportWantedVsActualHashes) {
     FakeUserdata given_userdata{
         {"LightSpeedFileExplorer", "freetype.so", "zlib.so", "libpng.so"},
-        {{"LightSpeedFileExplorer", "mnop"}, {"freetype.so", "ijkl"}, {"zlib.so", "efgh"}, {"libpng.so", "abcd"}}};
+        {{"LightSpeedFileExplorer", "5678"}, {"freetype.so", "1234"}, {"zlib.so", "ef01"}, {"libpng.so", "abcd"}}};
 
     struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
                                               &FakeStartGDBServer,
@@ -160,11 +206,15 @@ TEST(testBootstrapper, ReportWantedVsActualHashes) {
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "zlib.so");
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "libpng.so");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "efgh");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ijkl");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "mnop");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ef01");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "5678");
 
     ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    // Only the first file that was hashed is known to mismatch, the other files are hashed afterwards
+    EXPECT_EQ(1u, given_userdata.calculated_hashes.size());
+    EXPECT_EQ(3, HashAllDeferredFiles(&given_bootstrapper));
+    EXPECT_FALSE(HasDeferredHashes(&given_bootstrapper));
 
     struct DynamicStringArray created_files, created_actual_hashes, created_wanted_hashes;
     DynamicStringArrayInit(&created_files);
@@ -181,15 +231,15 @@ TEST(testBootstrapper, ReportWantedVsActualHashes) {
     EXPECT_EQ(std::string("zlib.so"), created_files.data[2]);
     EXPECT_EQ(std::string("libpng.so"), created_files.data[3]);
 
-    EXPECT_EQ(std::string("mnop"), created_actual_hashes.data[0]);
-    EXPECT_EQ(std::string("ijkl"), created_actual_hashes.data[1]);
-    EXPECT_EQ(std::string("efgh"), created_actual_hashes.data[2]);
+    EXPECT_EQ(std::string("5678"), created_actual_hashes.data[0]);
+    EXPECT_EQ(std::string("1234"), created_actual_hashes.data[1]);
+    EXPECT_EQ(std::string("ef01"), created_actual_hashes.data[2]);
     EXPECT_EQ(std::string("abcd"), created_actual_hashes.data[3]);
 
     EXPECT_EQ(std::string("abcd"), created_wanted_hashes.data[0]);
-    EXPECT_EQ(std::string("efgh"), created_wanted_hashes.data[1]);
-    EXPECT_EQ(std::string("ijkl"), created_wanted_hashes.data[2]);
-    EXPECT_EQ(std::string("mnop"), created_wanted_hashes.data[3]);
+    EXPECT_EQ(std::string("ef01"), created_wanted_hashes.data[1]);
+    EXPECT_EQ(std::string("1234"), created_wanted_hashes.data[2]);
+    EXPECT_EQ(std::string("5678"), created_wanted_hashes.data[3]);
 
     DynamicStringArrayDeinit(&created_files);
     DynamicStringArrayDeinit(&created_actual_hashes);
@@ -210,7 +260,7 @@ TEST(testBootstrapper, ReportWantedVsActualHashes_OnlyOneExecutable) {
 
     BootstrapperInit(&given_bootstrapper);
     struct ProjectDescription given_description;
-    ProjectDescriptionInit(&given_description, "test_exe", "abc");
+    ProjectDescriptionInit(&given_description, "test_exe", "abc0");
 
     ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
 
@@ -224,10 +274,15 @@ TEST(testBootstrapper, ReportWantedVsActualHashes_OnlyOneExecutable) {
     ASSERT_EQ(0, created_actual_hashes.size);
     ASSERT_EQ(0, created_wanted_hashes.size);
 
-    given_userdata = {{"test_exe"}, {{"test_exe", "def"}}};
+    given_userdata = {{"test_exe"}, {{"test_exe", "de0f"}}};
 
+    // The same description again doesn't check the files again, the change has to be reported
     ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
     ReportWantedVsActualHashes(&given_bootstrapper, &created_files, &created_actual_hashes, &created_wanted_hashes);
+    ASSERT_EQ(0, created_files.size);
+
+    UpdateFileActualHash(&given_bootstrapper, "test_exe");
+    ReportWantedVsActualHashes(&given_bootstrapper, &created_files, &created_actual_hashes, &created_wanted_hashes);
 
     ASSERT_EQ(1, created_files.size);
     ASSERT_EQ(1, created_actual_hashes.size);
@@ -235,9 +290,9 @@ TEST(testBootstrapper, ReportWantedVsActualHashes_OnlyOneExecutable) {
 
     EXPECT_EQ(std::string("test_exe"), created_files.data[0]);
 
-    EXPECT_EQ(std::string("def"), created_actual_hashes.data[0]);
+    EXPECT_EQ(std::string("de0f"), created_actual_hashes.data[0]);
 
-    EXPECT_EQ(std::string("abc"), created_wanted_hashes.data[0]);
+    EXPECT_EQ(std::string("abc0"), created_wanted_hashes.data[0]);
 
     DynamicStringArrayDeinit(&created_files);
     DynamicStringArrayDeinit(&created_actual_hashes);
@@ -249,7 +304,7 @@ TEST(testBootstrapper, ReportWantedVsActualHashes_OnlyOneExecutable) {
 TEST(testBootstrapper, UpdateFileActualHash) {
     FakeUserdata given_userdata{
         {"LightSpeedFileExplorer", "freetype.so", "zlib.so", "libpng.so"},
-        {{"LightSpeedFileExplorer", "mnop"}, {"freetype.so", "ijkl"}, {"zlib.so", "efgh"}, {"libpng.so", "abcd"}}};
+        {{"LightSpeedFileExplorer", "5678"}, {"freetype.so", "1234"}, {"zlib.so", "ef01"}, {"libpng.so", "abcd"}}};
 
     struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
                                               &FakeStartGDBServer,
@@ -264,9 +319,9 @@ TEST(testBootstrapper, UpdateFileActualHash) {
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "zlib.so");
     DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "libpng.so");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "efgh");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ijkl");
-    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "mnop");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ef01");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "5678");
 
     ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
 
@@ -274,11 +329,11 @@ TEST(testBootstrapper, UpdateFileActualHash) {
 
     given_userdata.hashes["LightSpeedFileExplorer"] = "abcd";
     UpdateFileActualHash(&given_bootstrapper, "LightSpeedFileExplorer");
-    given_userdata.hashes["freetype.so"] = "efgh";
+    given_userdata.hashes["freetype.so"] = "ef01";
     UpdateFileActualHash(&given_bootstrapper, "freetype.so");
-    given_userdata.hashes["zlib.so"] = "ijkl";
+    given_userdata.hashes["zlib.so"] = "1234";
     UpdateFileActualHash(&given_bootstrapper, "zlib.so");
-    given_userdata.hashes["libpng.so"] = "mnop";
+    given_userdata.hashes["libpng.so"] = "5678";
     UpdateFileActualHash(&given_bootstrapper, "libpng.so");
 
     EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
@@ -375,4 +430,473 @@ TEST(testBootstrapper, IndicateDebuggerStopped) {
 
     ProjectDescriptionDeinit(&given_description);
     BootstrapperDeinit(&given_bootstrapper);
-}
\ No newline at end of file
+}
+
+TEST(testBootstrapper, ReceiveFileHash) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer"}, {}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              &FakeRequestHash,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    const Digest given_digest = DigestOf("abcd");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+
+    ASSERT_EQ(1u, given_userdata.requested_hashes.size());
+    EXPECT_TRUE(HasPendingHashes(&given_bootstrapper));
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+
+    ReceiveFileHash(&given_bootstrapper, "LightSpeedFileExplorer", &given_digest);
+
+    EXPECT_FALSE(HasPendingHashes(&given_bootstrapper));
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, ReceiveFileHash_ChangedWhilePending) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer"}, {}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              &FakeRequestHash,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    const Digest given_digest = DigestOf("abcd");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    UpdateFileActualHash(&given_bootstrapper, "LightSpeedFileExplorer");
+    ASSERT_EQ(1u, given_userdata.requested_hashes.size());
+
+    // The first hash might be of the old content, so it is requested again
+    ReceiveFileHash(&given_bootstrapper, "LightSpeedFileExplorer", &given_digest);
+    ASSERT_EQ(2u, given_userdata.requested_hashes.size());
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+
+    ReceiveFileHash(&given_bootstrapper, "LightSpeedFileExplorer", &given_digest);
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, SizeMismatchIsNotHashed) {
+    // There is no hash for the executable, the test fails when it is calculated
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer"}, {}, {}, {{"LightSpeedFileExplorer", 100}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              &FakeFileSize,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    given_description.executable_size = 200;
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+
+    given_userdata.sizes["LightSpeedFileExplorer"] = 200;
+    given_userdata.hashes["LightSpeedFileExplorer"] = "abcd";
+    UpdateFileActualHash(&given_bootstrapper, "LightSpeedFileExplorer");
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, SizeMismatchWhileHashIsPending) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer"}, {}, {}, {{"LightSpeedFileExplorer", 200}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              &FakeRequestHash,
+                                              &FakeFileSize,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    given_description.executable_size = 200;
+    const Digest given_digest = DigestOf("abcd");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    ASSERT_EQ(1u, given_userdata.requested_hashes.size());
+
+    // The file is being rewritten while it is hashed, the hash that arrives is not of the current content
+    given_userdata.sizes["LightSpeedFileExplorer"] = 100;
+    UpdateFileActualHash(&given_bootstrapper, "LightSpeedFileExplorer");
+    ReceiveFileHash(&given_bootstrapper, "LightSpeedFileExplorer", &given_digest);
+    EXPECT_EQ(1u, given_userdata.requested_hashes.size());
+    EXPECT_FALSE(HasPendingHashes(&given_bootstrapper));
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, SmallestFileIsHashedFirst) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer", "freetype.so", "zlib.so"},
+                                {{"LightSpeedFileExplorer", "abcd"}, {"freetype.so", "1234"}, {"zlib.so", "5678"}},
+                                {},
+                                {{"LightSpeedFileExplorer", 300}, {"freetype.so", 200}, {"zlib.so", 100}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              &FakeFileSize,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "zlib.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ef01");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+    ASSERT_EQ(1u, given_userdata.calculated_hashes.size());
+    EXPECT_EQ("zlib.so", given_userdata.calculated_hashes[0]);
+    EXPECT_TRUE(HasDeferredHashes(&given_bootstrapper));
+
+    EXPECT_EQ(2, HashAllDeferredFiles(&given_bootstrapper));
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+
+    given_userdata.hashes["zlib.so"] = "ef01";
+    UpdateFileActualHash(&given_bootstrapper, "zlib.so");
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, MissingFileIsDecidedWithoutHashing) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer"}, {{"LightSpeedFileExplorer", "abcd"}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              NULL,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_TRUE(given_userdata.calculated_hashes.empty());
+
+    given_userdata.existing_files.insert("freetype.so");
+    given_userdata.hashes["freetype.so"] = "1234";
+    UpdateFileActualHash(&given_bootstrapper, "freetype.so");
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_EQ(2u, given_userdata.calculated_hashes.size());
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, RecheckWhileStartIsRuledOut) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer", "zlib.so"},
+                                {{"LightSpeedFileExplorer", "abcd"}, {"zlib.so", "5678"}},
+                                {},
+                                {{"LightSpeedFileExplorer", 300}, {"zlib.so", 100}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              &FakeFileSize,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "zlib.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "ef01");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+
+    // The missing file rules out the start, nothing is looked at until the deferred files are hashed
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_EQ(0, given_userdata.size_requests);
+    EXPECT_EQ(2, HashAllDeferredFiles(&given_bootstrapper));
+    UpdateFileActualHash(&given_bootstrapper, "LightSpeedFileExplorer");
+    EXPECT_EQ(2, given_userdata.size_requests);
+    EXPECT_EQ(1, HashAllDeferredFiles(&given_bootstrapper));
+
+    // Only the mismatching file is checked again
+    RecheckProjectFiles(&given_bootstrapper);
+    EXPECT_EQ(1, HashAllDeferredFiles(&given_bootstrapper));
+    ASSERT_EQ(4u, given_userdata.calculated_hashes.size());
+    EXPECT_EQ("zlib.so", given_userdata.calculated_hashes[3]);
+
+    // Once the known mismatches match, the other files are checked as well before the debugger starts
+    given_userdata.existing_files.insert("freetype.so");
+    given_userdata.hashes["freetype.so"] = "ef01";
+    given_userdata.hashes["zlib.so"] = "1234";
+    RecheckProjectFiles(&given_bootstrapper);
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_FALSE(HasDeferredHashes(&given_bootstrapper));
+    EXPECT_EQ(9u, given_userdata.calculated_hashes.size());
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+namespace {
+// Applies random file changes to the fake file system, every change is reported to the bootstrapper right away
+struct RandomFileEvents {
+    RandomFileEvents(FakeUserdata* userdata, unsigned seed) : userdata(userdata), random(seed) {
+        for (int i = 0; i < 12; ++i) {
+            const std::string file = "lib" + std::to_string(i) + ".so";
+            files.push_back(file);
+            wanted_hashes.push_back(RandomHash());
+            userdata->existing_files.insert(file);
+            userdata->hashes[file] = wanted_hashes.back();
+        }
+    }
+
+    // Only a few hashes, so that files often match again after changing
+    std::string RandomHash() { return std::vector<std::string>{"abcd", "1234", "ef01"}[random() % 3]; }
+
+    void DescribeProject(ProjectDescription* description) {
+        ProjectDescriptionInit(description, files[0].c_str(), wanted_hashes[0].c_str());
+        for (size_t i = 1; i < files.size(); ++i) {
+            DynamicStringArrayAppend(&description->link_dependencies_for_executable, files[i].c_str());
+            DynamicStringArrayAppend(&description->link_dependencies_for_executable_hashes, wanted_hashes[i].c_str());
+        }
+    }
+
+    void Apply(Bootstrapper* bootstrapper) {
+        const std::string& file = files[random() % files.size()];
+        switch (random() % 4) {
+        case 0:
+            userdata->existing_files.erase(file);
+            IndicateRemovedFile(bootstrapper, file.c_str());
+            break;
+        case 1:
+            HashDeferredFile(bootstrapper);
+            break;
+        default:
+            userdata->existing_files.insert(file);
+            userdata->hashes[file] = RandomHash();
+            UpdateFileActualHash(bootstrapper, file.c_str());
+        }
+    }
+
+    bool ProjectMatches() const {
+        for (size_t i = 0; i < files.size(); ++i) {
+            if (!userdata->existing_files.count(files[i]) || userdata->hashes.at(files[i]) != wanted_hashes[i])
+                return false;
+        }
+        return true;
+    }
+
+    FakeUserdata* userdata;
+    std::mt19937 random;
+    std::vector<std::string> files, wanted_hashes;
+};
+} // namespace
+
+TEST(testBootstrapper, RandomEventsDecideLikeAFullCheck) {
+    FakeUserdata given_userdata;
+    RandomFileEvents given_events(&given_userdata, 1234);
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              NULL,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    given_events.DescribeProject(&given_description);
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+
+    for (int i = 0; i < 20000; ++i) {
+        given_events.Apply(&given_bootstrapper);
+        ASSERT_EQ(given_events.ProjectMatches(), IsGDBServerUp(&given_bootstrapper)) << "after event " << i;
+    }
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, RandomEventsWithPendingHashes) {
+    FakeUserdata given_userdata;
+    RandomFileEvents given_events(&given_userdata, 5678);
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &FakeStartGDBServer,
+                                              &FakeStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              &FakeRequestHash,
+                                              NULL,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    given_events.DescribeProject(&given_description);
+
+    // A requested hash is calculated from the content at the time of the request, like the hash worker pool does
+    std::vector<std::pair<std::string, std::string>> calculations;
+    const auto take_requests = [&] {
+        for (const std::string& file : given_userdata.requested_hashes)
+            calculations.emplace_back(file, given_userdata.hashes[file]);
+        given_userdata.requested_hashes.clear();
+    };
+    const auto complete_calculation = [&](size_t at) {
+        const auto calculation = calculations[at];
+        calculations.erase(calculations.begin() + at);
+        const Digest given_digest = DigestOf(calculation.second.c_str());
+        ReceiveFileHash(&given_bootstrapper, calculation.first.c_str(), &given_digest);
+        take_requests();
+    };
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    take_requests();
+    for (int i = 0; i < 20000; ++i) {
+        if (!calculations.empty() && given_events.random() % 2)
+            complete_calculation(given_events.random() % calculations.size());
+        else
+            given_events.Apply(&given_bootstrapper);
+        take_requests();
+
+        // A stale hash must never start the debugger
+        if (IsGDBServerUp(&given_bootstrapper))
+            ASSERT_TRUE(given_events.ProjectMatches()) << "after event " << i;
+    }
+
+    // Once every file is hashed, the decision is the same as that of a full check
+    while (HashDeferredFile(&given_bootstrapper) || !calculations.empty()) {
+        take_requests();
+        while (!calculations.empty())
+            complete_calculation(0);
+    }
+    EXPECT_FALSE(HasPendingHashes(&given_bootstrapper));
+    EXPECT_EQ(given_events.ProjectMatches(), IsGDBServerUp(&given_bootstrapper));
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, ReceiveNewProjectDescription_OnlyChangesAreChecked) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer", "freetype.so", "zlib.so"},
+                                {{"LightSpeedFileExplorer", "abcd"}, {"freetype.so", "1234"}, {"zlib.so", "5678"}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &CountingStartGDBServer,
+                                              &CountingStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              NULL,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "freetype.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_EQ(1, given_userdata.starts);
+    EXPECT_EQ(2u, given_userdata.calculated_hashes.size());
+
+    // A reconnecting client sends the same description
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_EQ(1, given_userdata.starts);
+    EXPECT_EQ(0, given_userdata.stops);
+    EXPECT_EQ(2u, given_userdata.calculated_hashes.size());
+
+    // Only the added file is hashed, the debugger keeps running
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "zlib.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "5678");
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_EQ(1, given_userdata.starts);
+    EXPECT_EQ(0, given_userdata.stops);
+    ASSERT_EQ(3u, given_userdata.calculated_hashes.size());
+    EXPECT_EQ("zlib.so", given_userdata.calculated_hashes[2]);
+
+    // Another wanted hash is compared with the digest that is already known
+    DynamicStringArrayReplace(&given_description.link_dependencies_for_executable_hashes, 0, "ef01");
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_FALSE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_EQ(1, given_userdata.stops);
+    EXPECT_EQ(3u, given_userdata.calculated_hashes.size());
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
+
+TEST(testBootstrapper, ReceiveNewProjectDescription_OtherArgumentsRestart) {
+    FakeUserdata given_userdata{{"LightSpeedFileExplorer"}, {{"LightSpeedFileExplorer", "abcd"}}};
+
+    struct Bootstrapper given_bootstrapper = {static_cast<void*>(&given_userdata),
+                                              &CountingStartGDBServer,
+                                              &CountingStopGDBServer,
+                                              &FakeFileExists,
+                                              &FakeCalculateHash,
+                                              NULL,
+                                              NULL,
+                                              NULL};
+
+    BootstrapperInit(&given_bootstrapper);
+    struct ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "LightSpeedFileExplorer", "abcd");
+
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    DynamicStringArrayAppend(&given_description.executable_arguments, "--verbose");
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+    EXPECT_TRUE(IsGDBServerUp(&given_bootstrapper));
+    EXPECT_EQ(2, given_userdata.starts);
+    EXPECT_EQ(1, given_userdata.stops);
+    EXPECT_EQ(1u, given_userdata.calculated_hashes.size());
+
+    ProjectDescriptionDeinit(&given_description);
+    BootstrapperDeinit(&given_bootstrapper);
+}
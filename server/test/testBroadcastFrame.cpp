@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <sys/uio.h>
+
+extern "C" {
+#include "../BroadcastFrame.h"
+}
+
+namespace {
+struct BroadcastFrameQueueRAII {
+    BroadcastFrameQueueRAII() { BroadcastFrameQueueInit(&queue); }
+    ~BroadcastFrameQueueRAII() { BroadcastFrameQueueDeinit(&queue); }
+
+    BroadcastFrameQueue queue;
+};
+
+BroadcastFrame* MakeFrame(const std::string& header, const std::string& payload, const char* subject = nullptr) {
+    return BroadcastFrameCreate(subject, reinterpret_cast<const uint8_t*>(header.data()), header.size(),
+                                reinterpret_cast<const uint8_t*>(payload.data()), payload.size());
+}
+
+void Push(BroadcastFrameQueue* queue, const std::string& payload, const char* subject = nullptr) {
+    BroadcastFrame* frame = MakeFrame("", payload, subject);
+    BroadcastFrameQueuePush(queue, frame);
+    BroadcastFrameRelease(frame);
+}
+
+std::string Gathered(const BroadcastFrameQueue& queue) {
+    iovec iov[16];
+    const size_t count = BroadcastFrameQueueGather(&queue, iov, 16);
+    std::string gathered;
+    for (size_t i = 0; i < count; ++i)
+        gathered.append(static_cast<const char*>(iov[i].iov_base), iov[i].iov_len);
+    return gathered;
+}
+} // namespace
+
+TEST(testBroadcastFrame, Create) {
+    BroadcastFrame* created = MakeFrame("hd", "message");
+    EXPECT_EQ(1u, created->references);
+    EXPECT_EQ(std::string("hdmessage"), std::string(reinterpret_cast<char*>(created->data), created->size));
+    EXPECT_EQ(nullptr, created->subject);
+    BroadcastFrameRelease(created);
+
+    created = MakeFrame("hd", "message", "/file");
+    EXPECT_STREQ("/file", created->subject);
+    EXPECT_EQ(9u, created->size);
+    BroadcastFrameRelease(created);
+}
+
+TEST(testBroadcastFrame, QueuesShareTheFrame) {
+    BroadcastFrame* given_frame = MakeFrame("h", "shared");
+    {
+        BroadcastFrameQueueRAII first, second;
+        BroadcastFrameQueuePush(&first.queue, given_frame);
+        BroadcastFrameQueuePush(&second.queue, given_frame);
+        EXPECT_EQ(3u, given_frame->references);
+        EXPECT_EQ(given_frame->data, first.queue.frames[first.queue.first]->data);
+
+        BroadcastFrameQueueConsume(&first.queue, given_frame->size);
+        EXPECT_EQ(0u, first.queue.size);
+        EXPECT_EQ(2u, given_frame->references);
+    }
+    EXPECT_EQ(1u, given_frame->references);
+    BroadcastFrameRelease(given_frame);
+}
+
+TEST(testBroadcastFrame, ConsumePartially) {
+    BroadcastFrameQueueRAII created;
+    const char* given_messages[] = {"first", "second", "third"};
+    for (const char* given_message : given_messages) {
+        BroadcastFrame* frame = MakeFrame("#", given_message);
+        BroadcastFrameQueuePush(&created.queue, frame);
+        BroadcastFrameRelease(frame);
+    }
+    EXPECT_EQ(std::string("#first#second#third"), Gathered(created.queue));
+    EXPECT_EQ(19u, created.queue.bytes);
+
+    // Halfway into the second frame
+    BroadcastFrameQueueConsume(&created.queue, 9);
+    EXPECT_EQ(2u, created.queue.size);
+    EXPECT_EQ(10u, created.queue.bytes);
+    EXPECT_EQ(std::string("cond#third"), Gathered(created.queue));
+
+    BroadcastFrameQueueConsume(&created.queue, 10);
+    EXPECT_EQ(0u, created.queue.size);
+    EXPECT_EQ(0u, created.queue.bytes);
+    EXPECT_EQ(std::string(), Gathered(created.queue));
+}
+
+TEST(testBroadcastFrame, GatherIsLimitedToMaxIov) {
+    BroadcastFrameQueueRAII created;
+    for (int i = 0; i < 3; ++i) {
+        BroadcastFrame* frame = MakeFrame("", std::to_string(i));
+        BroadcastFrameQueuePush(&created.queue, frame);
+        BroadcastFrameRelease(frame);
+    }
+    iovec iov[2];
+    EXPECT_EQ(2u, BroadcastFrameQueueGather(&created.queue, iov, 2));
+}
+
+TEST(testBroadcastFrame, KeepsOrderWhileTheRingWrapsAndGrows) {
+    BroadcastFrameQueueRAII created;
+    std::string expected;
+    for (int i = 0; i < 40; ++i) {
+        BroadcastFrame* frame = MakeFrame("", std::to_string(i % 10));
+        BroadcastFrameQueuePush(&created.queue, frame);
+        BroadcastFrameRelease(frame);
+        expected += std::to_string(i % 10);
+        // Every third frame one is sent, so the first frame moves through the ring
+        if (i % 3 == 0) {
+            BroadcastFrameQueueConsume(&created.queue, 1);
+            expected.erase(0, 1);
+        }
+    }
+    EXPECT_EQ(expected.substr(0, 16), Gathered(created.queue));
+    EXPECT_EQ(expected.size(), created.queue.bytes);
+}
+
+TEST(testBroadcastFrame, CoalesceKeepsTheLatestFrameOfEverySubject) {
+    BroadcastFrameQueueRAII created;
+    Push(&created.queue, "a1", "/a");
+    Push(&created.queue, "out1");
+    Push(&created.queue, "b1", "/b");
+    Push(&created.queue, "a2", "/a");
+    Push(&created.queue, "out2");
+    Push(&created.queue, "a3", "/a");
+
+    EXPECT_EQ(4u, BroadcastFrameQueueCoalesce(&created.queue));
+    EXPECT_EQ(std::string("out1b1out2a3"), Gathered(created.queue));
+    EXPECT_EQ(12u, created.queue.bytes);
+    EXPECT_EQ(0u, BroadcastFrameQueueCoalesce(&created.queue));
+}
+
+TEST(testBroadcastFrame, DropOutputKeepsFramesWithASubject) {
+    BroadcastFrameQueueRAII created;
+    Push(&created.queue, "out1");
+    Push(&created.queue, "a1", "/a");
+    Push(&created.queue, "out2");
+
+    EXPECT_EQ(8u, BroadcastFrameQueueDropOutput(&created.queue));
+    EXPECT_EQ(std::string("a1"), Gathered(created.queue));
+    EXPECT_EQ(2u, created.queue.bytes);
+
+    // The queue still works after its frames were moved
+    Push(&created.queue, "out3");
+    EXPECT_EQ(std::string("a1out3"), Gathered(created.queue));
+}
+
+TEST(testBroadcastFrame, PartiallySentFrameIsNeverRemoved) {
+    BroadcastFrameQueueRAII created;
+    Push(&created.queue, "out1");
+    Push(&created.queue, "a1", "/a");
+    Push(&created.queue, "a2", "/a");
+    Push(&created.queue, "out2");
+    BroadcastFrameQueueConsume(&created.queue, 2);
+
+    EXPECT_EQ(4u, BroadcastFrameQueueDropOutput(&created.queue));
+    EXPECT_EQ(std::string("t1a1a2"), Gathered(created.queue));
+
+    BroadcastFrameQueueConsume(&created.queue, 3);
+    EXPECT_EQ(0u, BroadcastFrameQueueCoalesce(&created.queue));
+    EXPECT_EQ(std::string("1a2"), Gathered(created.queue));
+}
@@ -0,0 +1,51 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+extern "C" {
+#include "../Digest.h"
+}
+
+namespace {
+std::string Hex(const Digest& digest) {
+    char hex[DIGEST_HEX_BUFFER_SIZE];
+    DigestToHex(&digest, hex);
+    return hex;
+}
+} // namespace
+
+TEST(testDigest, HexRoundTripKeepsLeadingZeros) {
+    Digest created_digest;
+    ASSERT_TRUE(DigestFromHex("000102a0ff", &created_digest));
+    EXPECT_EQ(5u, created_digest.size);
+    EXPECT_EQ("000102a0ff", Hex(created_digest));
+}
+
+TEST(testDigest, UppercaseHexIsEqual) {
+    Digest created_lowercase, created_uppercase;
+    ASSERT_TRUE(DigestFromHex("7f9000257a4918d7072655ea468540cdcbd42e0c", &created_lowercase));
+    ASSERT_TRUE(DigestFromHex("7F9000257A4918D7072655EA468540CDCBD42E0C", &created_uppercase));
+    EXPECT_TRUE(DigestEqual(&created_lowercase, &created_uppercase));
+    EXPECT_EQ("7f9000257a4918d7072655ea468540cdcbd42e0c", Hex(created_uppercase));
+}
+
+TEST(testDigest, InvalidHex) {
+    Digest created_digest;
+    EXPECT_FALSE(DigestFromHex("", &created_digest));
+    EXPECT_FALSE(DigestFromHex("abc", &created_digest));
+    EXPECT_FALSE(DigestFromHex("zz", &created_digest));
+    EXPECT_FALSE(DigestFromHex(std::string(DIGEST_MAX_SIZE * 2 + 2, 'a').c_str(), &created_digest));
+    EXPECT_TRUE(DigestIsEmpty(&created_digest));
+    EXPECT_EQ("", Hex(created_digest));
+}
+
+TEST(testDigest, EmptyDigestsAreNeverEqual) {
+    Digest created_first, created_second;
+    DigestClear(&created_first);
+    DigestClear(&created_second);
+    EXPECT_FALSE(DigestEqual(&created_first, &created_second));
+
+    ASSERT_TRUE(DigestFromHex("abcd", &created_first));
+    ASSERT_TRUE(DigestFromHex("abcd00", &created_second));
+    EXPECT_FALSE(DigestEqual(&created_first, &created_second));
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+
+extern "C" {
+#include "../DynamicBuffer.h"
+}
+
+namespace {
+struct BufferRAII {
+    BufferRAII() { DynamicBufferInit(&buffer); }
+    ~BufferRAII() { DynamicBufferDeinit(&buffer); }
+
+    std::string Content() const { return std::string(buffer.data, buffer.size); }
+
+    DynamicBuffer buffer;
+};
+} // namespace
+
+TEST(testDynamicBuffer, AppendAndTrim) {
+    BufferRAII created;
+    DynamicBufferAppend(&created.buffer, "hello ", 6);
+    DynamicBufferAppend(&created.buffer, "world", 5);
+    EXPECT_EQ("hello world", created.Content());
+
+    DynamicBufferTrimLeft(&created.buffer, 6);
+    EXPECT_EQ("world", created.Content());
+    DynamicBufferAppend(&created.buffer, "!", 1);
+    EXPECT_EQ("world!", created.Content());
+
+    DynamicBufferTrimLeft(&created.buffer, 6);
+    EXPECT_EQ(0u, created.buffer.size);
+}
+
+TEST(testDynamicBuffer, TrimmedBytesAreReused) {
+    BufferRAII created;
+    const std::string given_chunk(100, 'x');
+    std::string expected;
+    for (int i = 0; i < 1000; ++i) {
+        DynamicBufferAppend(&created.buffer, given_chunk.c_str(), given_chunk.size());
+        DynamicBufferTrimLeft(&created.buffer, i % 2 ? 160 : 40);
+    }
+    // A buffer that is drained about as fast as it is filled doesn't keep growing
+    EXPECT_LT(created.buffer.capacity, 4096u);
+    EXPECT_EQ(std::string(created.buffer.size, 'x'), created.Content());
+}
+
+TEST(testDynamicBuffer, ReserveAndCommit) {
+    BufferRAII created;
+    DynamicBufferAppend(&created.buffer, "abc", 3);
+    DynamicBufferTrimLeft(&created.buffer, 1);
+
+    char* tail = DynamicBufferReserve(&created.buffer, 1000);
+    EXPECT_EQ(created.buffer.data + created.buffer.size, tail);
+    EXPECT_GE(created.buffer._allocation + created.buffer.capacity, tail + 1000);
+    memcpy(tail, "def", 3);
+    DynamicBufferCommit(&created.buffer, 3);
+    EXPECT_EQ("bcdef", created.Content());
+
+    // Reserved bytes that were not committed are not part of the data
+    DynamicBufferReserve(&created.buffer, 10);
+    EXPECT_EQ("bcdef", created.Content());
+}
@@ -0,0 +1,108 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "../DynamicStringArray.h"
+}
+
+namespace {
+struct StringArrayRAII {
+    StringArrayRAII() { DynamicStringArrayInit(&array); }
+    ~StringArrayRAII() { DynamicStringArrayDeinit(&array); }
+
+    DynamicStringArray array;
+};
+
+std::vector<std::string> Strings(const DynamicStringArray& array) {
+    return std::vector<std::string>(array.data, array.data + array.size);
+}
+} // namespace
+
+TEST(testDynamicStringArray, AppendManyStrings) {
+    StringArrayRAII created;
+    std::vector<std::string> expected;
+    for (int i = 0; i < 1000; ++i) {
+        expected.push_back("/usr/lib/lib" + std::to_string(i) + ".so");
+        DynamicStringArrayAppend(&created.array, expected.back().c_str());
+    }
+    EXPECT_EQ(expected, Strings(created.array));
+}
+
+TEST(testDynamicStringArray, AppendOwnString) {
+    StringArrayRAII created;
+    DynamicStringArrayAppend(&created.array, "app");
+    // Moves the strings to a larger arena while the appended string is in the old one
+    for (int i = 0; i < 300; ++i)
+        DynamicStringArrayAppend(&created.array, created.array.data[i]);
+    EXPECT_EQ(301u, created.array.size);
+    EXPECT_EQ(std::string("app"), created.array.data[300]);
+
+    DynamicStringArrayAppendArray(&created.array, &created.array);
+    EXPECT_EQ(602u, created.array.size);
+    EXPECT_EQ(std::string("app"), created.array.data[601]);
+}
+
+TEST(testDynamicStringArray, EraseAndCopy) {
+    StringArrayRAII created, created_copy;
+    for (const char* item : {"a", "b", "c", "d", "e"})
+        DynamicStringArrayAppend(&created.array, item);
+
+    DynamicStringArrayErase(&created.array, 1);
+    EXPECT_EQ((std::vector<std::string>{"a", "c", "d", "e"}), Strings(created.array));
+    DynamicStringArrayEraseUnordered(&created.array, 0);
+    EXPECT_EQ((std::vector<std::string>{"e", "c", "d"}), Strings(created.array));
+    DynamicStringArrayEraseUnordered(&created.array, 2);
+    EXPECT_EQ((std::vector<std::string>{"e", "c"}), Strings(created.array));
+
+    DynamicStringArrayDeinit(&created_copy.array);
+    DynamicStringArrayCopy(&created.array, &created_copy.array);
+    EXPECT_EQ(Strings(created.array), Strings(created_copy.array));
+    EXPECT_NE(created.array.data[0], created_copy.array.data[0]);
+
+    DynamicStringArrayClear(&created.array);
+    DynamicStringArrayAppend(&created.array, "f");
+    EXPECT_EQ((std::vector<std::string>{"f"}), Strings(created.array));
+    EXPECT_EQ((std::vector<std::string>{"e", "c"}), Strings(created_copy.array));
+}
+
+TEST(testDynamicStringArray, Replace) {
+    StringArrayRAII created, created_share;
+    for (const char* item : {"app", "libpng.so", "zlib.so"})
+        DynamicStringArrayAppend(&created.array, item);
+    DynamicStringArrayDeinit(&created_share.array);
+    DynamicStringArrayShare(&created.array, &created_share.array);
+
+    DynamicStringArrayReplace(&created.array, 1, "libjpeg.so");
+    DynamicStringArrayReplace(&created.array, 2, created.array.data[0]);
+    EXPECT_EQ((std::vector<std::string>{"app", "libjpeg.so", "app"}), Strings(created.array));
+    EXPECT_EQ((std::vector<std::string>{"app", "libpng.so", "zlib.so"}), Strings(created_share.array));
+
+    // The replaced strings are left behind when the strings are copied
+    StringArrayRAII created_copy;
+    DynamicStringArrayDeinit(&created_copy.array);
+    DynamicStringArrayCopy(&created.array, &created_copy.array);
+    DynamicStringArrayErase(&created.array, 0);
+    EXPECT_EQ((std::vector<std::string>{"app", "libjpeg.so", "app"}), Strings(created_copy.array));
+    EXPECT_EQ((std::vector<std::string>{"libjpeg.so", "app"}), Strings(created.array));
+}
+
+TEST(testDynamicStringArray, SharedStringsAreCopiedOnWrite) {
+    StringArrayRAII created, created_share;
+    DynamicStringArrayAppend(&created.array, "app");
+    DynamicStringArrayAppend(&created.array, "libpng.so");
+
+    DynamicStringArrayDeinit(&created_share.array);
+    DynamicStringArrayShare(&created.array, &created_share.array);
+    EXPECT_EQ(created.array.data[0], created_share.array.data[0]);
+
+    DynamicStringArrayAppend(&created_share.array, "zlib.so");
+    EXPECT_EQ((std::vector<std::string>{"app", "libpng.so"}), Strings(created.array));
+    EXPECT_EQ((std::vector<std::string>{"app", "libpng.so", "zlib.so"}), Strings(created_share.array));
+
+    DynamicStringArrayErase(&created.array, 0);
+    DynamicStringArrayClear(&created_share.array);
+    EXPECT_EQ((std::vector<std::string>{"libpng.so"}), Strings(created.array));
+    EXPECT_TRUE(Strings(created_share.array).empty());
+}
@@ -5,7 +5,14 @@
 #include "../DynamicBuffer.h"
 
 extern "C" {
+#include "../Bootstrapper.h"
+#include "../Digest.h"
+#include "../ProjectDescription.h"
+#include "../ProjectFileWatcher.h"
+
 DynamicBuffer* CombineMessageForFileMismatch(const char* file, const char* wanted_hash, const char* actual_hash);
+long long TimeUntilFileChangesArePolled(const ProjectFileWatcher* file_watcher, int file_watcher_lost_events,
+                                        const Bootstrapper* bootstrapper, long long polled_ms, long long now_ms);
 }
 
 TEST(testEventDispatch, CombineMessageForFileMismatch) {
@@ -13,4 +20,51 @@ TEST(testEventDispatch, CombineMessageForFileMismatch) {
     EXPECT_EQ(std::string("file: \"testFile\" wanted hash: \"abc\" actual hash: \"def\""),
               std::string(createdDynamicBuffer->data));
     free(createdDynamicBuffer);
-}
\ No newline at end of file
+}
+
+static int StartGDBServer(void*, char*, const DynamicStringArray*) { return 1; }
+static int StopGDBServer(void*) { return 1; }
+// Only the executable exists, the dependency is in a directory that doesn't exist
+static int ExecutableExists(const char* file_name, void*) { return std::string(file_name) == "/tmp/app"; }
+static int CountingCalculateHash(const char*, Digest* digest, void* userdata) {
+    ++*static_cast<int*>(userdata);
+    return DigestFromHex("abcd", digest);
+}
+
+TEST(testEventDispatch, IncompleteWatcherIsPolledOncePerTimeout) {
+    ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "/tmp/app", "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, "/nonexistent/lib.so");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "1234");
+
+    ProjectFileWatcher given_watcher;
+    ProjectFileWatcherInit(&given_watcher);
+    ProjectFileWatcherWatch(&given_watcher, &given_description);
+    ASSERT_FALSE(ProjectFileWatcherIsComplete(&given_watcher));
+
+    int calculated_hashes = 0;
+    struct Bootstrapper given_bootstrapper = {
+        &calculated_hashes, &StartGDBServer, &StopGDBServer, &ExecutableExists, &CountingCalculateHash, NULL, NULL,
+        NULL};
+    BootstrapperInit(&given_bootstrapper);
+    ReceiveNewProjectDescription(&given_bootstrapper, &given_description);
+
+    // The deferred executable is hashed first
+    EXPECT_EQ(-1, TimeUntilFileChangesArePolled(&given_watcher, 0, &given_bootstrapper, 5000, 7000));
+    EXPECT_TRUE(HashDeferredFile(&given_bootstrapper));
+    EXPECT_EQ(1, calculated_hashes);
+
+    EXPECT_EQ(1000, TimeUntilFileChangesArePolled(&given_watcher, 0, &given_bootstrapper, 5000, 5000));
+    EXPECT_EQ(600, TimeUntilFileChangesArePolled(&given_watcher, 0, &given_bootstrapper, 5000, 5400));
+    EXPECT_EQ(0, TimeUntilFileChangesArePolled(&given_watcher, 0, &given_bootstrapper, 5000, 6000));
+
+    // Checking again while the dependency is missing leaves the matching executable alone, so the next check waits
+    RecheckProjectFiles(&given_bootstrapper);
+    EXPECT_FALSE(HasDeferredHashes(&given_bootstrapper));
+    EXPECT_EQ(1, calculated_hashes);
+    EXPECT_EQ(1000, TimeUntilFileChangesArePolled(&given_watcher, 0, &given_bootstrapper, 6000, 6000));
+
+    BootstrapperDeinit(&given_bootstrapper);
+    ProjectFileWatcherDeinit(&given_watcher);
+    ProjectDescriptionDeinit(&given_description);
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+extern "C" {
+#include "../EventPoller.h"
+}
+
+namespace {
+struct EventPollerRAII {
+    explicit EventPollerRAII(EventPollerBackend backend) { EventPollerInit(&poller, backend); }
+    ~EventPollerRAII() { EventPollerDeinit(&poller); }
+
+    EventPoller poller;
+};
+
+struct PipeRAII {
+    PipeRAII() { EXPECT_EQ(0, pipe(fds)); }
+    ~PipeRAII() {
+        close(fds[0]);
+        close(fds[1]);
+    }
+
+    int fds[2];
+};
+
+class testEventPoller : public ::testing::TestWithParam<EventPollerBackend> {};
+} // namespace
+
+TEST_P(testEventPoller, ReportsReadyFdsWithTheirId) {
+    EventPollerRAII created(GetParam());
+    EXPECT_EQ(GetParam(), created.poller.backend);
+    PipeRAII given_pipe;
+    PipeRAII given_idle_pipe;
+    EventPollerAdd(&created.poller, given_idle_pipe.fds[0], 7, EVENT_POLLER_READABLE);
+    EventPollerAdd(&created.poller, given_pipe.fds[0], 42, EVENT_POLLER_READABLE);
+    EXPECT_EQ(0, EventPollerWait(&created.poller, 0));
+
+    ASSERT_EQ(1, write(given_pipe.fds[1], "x", 1));
+    ASSERT_EQ(1, EventPollerWait(&created.poller, 1000));
+    EXPECT_EQ(42u, created.poller.events[0].id);
+    EXPECT_EQ(EVENT_POLLER_READABLE, created.poller.events[0].events);
+}
+
+TEST_P(testEventPoller, ModifyAndRemove) {
+    EventPollerRAII created(GetParam());
+    PipeRAII given_pipe;
+    EventPollerAdd(&created.poller, given_pipe.fds[1], 1, 0);
+    EXPECT_EQ(0, EventPollerWait(&created.poller, 0));
+
+    // The id changes along with the events
+    EventPollerModify(&created.poller, given_pipe.fds[1], 2, EVENT_POLLER_WRITABLE);
+    ASSERT_EQ(1, EventPollerWait(&created.poller, 1000));
+    EXPECT_EQ(2u, created.poller.events[0].id);
+    EXPECT_EQ(EVENT_POLLER_WRITABLE, created.poller.events[0].events);
+
+    EventPollerRemove(&created.poller, given_pipe.fds[1]);
+    EXPECT_EQ(0, EventPollerWait(&created.poller, 0));
+}
+
+TEST_P(testEventPoller, ReportsHangup) {
+    EventPollerRAII created(GetParam());
+    int given_fds[2];
+    ASSERT_EQ(0, pipe(given_fds));
+    EventPollerAdd(&created.poller, given_fds[0], 3, EVENT_POLLER_READABLE);
+    close(given_fds[1]);
+
+    ASSERT_EQ(1, EventPollerWait(&created.poller, 1000));
+    EXPECT_EQ(3u, created.poller.events[0].id);
+    EXPECT_TRUE(created.poller.events[0].events & EVENT_POLLER_HANGUP);
+    EventPollerRemove(&created.poller, given_fds[0]);
+    close(given_fds[0]);
+}
+
+TEST_P(testEventPoller, ManyFds) {
+    EventPollerRAII created(GetParam());
+    PipeRAII given_pipes[20];
+    for (uint64_t i = 0; i < 20; ++i)
+        EventPollerAdd(&created.poller, given_pipes[i].fds[0], i, EVENT_POLLER_READABLE);
+    // Removing from the middle keeps the others watched
+    for (uint64_t i = 0; i < 20; i += 2)
+        EventPollerRemove(&created.poller, given_pipes[i].fds[0]);
+    for (PipeRAII& given_pipe : given_pipes)
+        ASSERT_EQ(1, write(given_pipe.fds[1], "x", 1));
+
+    ASSERT_EQ(10, EventPollerWait(&created.poller, 1000));
+    uint64_t reported_ids = 0;
+    for (int i = 0; i < 10; ++i)
+        reported_ids |= 1ull << created.poller.events[i].id;
+    EXPECT_EQ(0xaaaaaull, reported_ids);
+}
+
+INSTANTIATE_TEST_SUITE_P(Backends, testEventPoller,
+                         ::testing::Values(EVENT_POLLER_BACKEND_EPOLL, EVENT_POLLER_BACKEND_POLL));
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+extern "C" {
+#include "../DynamicStringArray.h"
+#include "../FileChangeSettler.h"
+}
+
+namespace {
+struct SettlerRAII {
+    SettlerRAII(long long quiet_window_ms) {
+        FileChangeSettlerInit(&settler, quiet_window_ms);
+        DynamicStringArrayInit(&settled_files);
+    }
+    ~SettlerRAII() {
+        FileChangeSettlerDeinit(&settler);
+        DynamicStringArrayDeinit(&settled_files);
+    }
+
+    FileChangeSettler settler;
+    DynamicStringArray settled_files;
+};
+} // namespace
+
+TEST(testFileChangeSettler, SettlesAfterQuietWindow) {
+    SettlerRAII created(100);
+    EXPECT_EQ(-1, FileChangeSettlerTimeUntilNextSettle(&created.settler, 0));
+
+    FileChangeSettlerNotifyFinished(&created.settler, "app", 0);
+    EXPECT_EQ(100, FileChangeSettlerTimeUntilNextSettle(&created.settler, 0));
+
+    FileChangeSettlerTakeSettled(&created.settler, 99, &created.settled_files);
+    EXPECT_EQ(0u, created.settled_files.size);
+
+    FileChangeSettlerTakeSettled(&created.settler, 100, &created.settled_files);
+    ASSERT_EQ(1u, created.settled_files.size);
+    EXPECT_EQ(std::string("app"), created.settled_files.data[0]);
+    EXPECT_EQ(-1, FileChangeSettlerTimeUntilNextSettle(&created.settler, 100));
+}
+
+TEST(testFileChangeSettler, BurstIsCoalesced) {
+    SettlerRAII created(100);
+
+    for (long long now_ms = 0; now_ms < 1000; now_ms += 50) {
+        FileChangeSettlerNotifyFinished(&created.settler, "lib.so", now_ms);
+        FileChangeSettlerTakeSettled(&created.settler, now_ms, &created.settled_files);
+    }
+    EXPECT_EQ(0u, created.settled_files.size);
+
+    FileChangeSettlerTakeSettled(&created.settler, 1050, &created.settled_files);
+    EXPECT_EQ(1u, created.settled_files.size);
+}
+
+TEST(testFileChangeSettler, ActivityPostponesPendingFilesOnly) {
+    SettlerRAII created(100);
+
+    FileChangeSettlerNotifyActivity(&created.settler, "app", 0);
+    EXPECT_EQ(-1, FileChangeSettlerTimeUntilNextSettle(&created.settler, 0));
+
+    FileChangeSettlerNotifyFinished(&created.settler, "app", 0);
+    FileChangeSettlerNotifyActivity(&created.settler, "app", 80);
+    FileChangeSettlerTakeSettled(&created.settler, 150, &created.settled_files);
+    EXPECT_EQ(0u, created.settled_files.size);
+
+    FileChangeSettlerTakeSettled(&created.settler, 180, &created.settled_files);
+    EXPECT_EQ(1u, created.settled_files.size);
+}
+
+TEST(testFileChangeSettler, ForgottenFileDoesNotSettle) {
+    SettlerRAII created(100);
+
+    FileChangeSettlerNotifyFinished(&created.settler, "app", 0);
+    FileChangeSettlerNotifyFinished(&created.settler, "lib.so", 0);
+    FileChangeSettlerForget(&created.settler, "app");
+
+    FileChangeSettlerTakeSettled(&created.settler, 100, &created.settled_files);
+    ASSERT_EQ(1u, created.settled_files.size);
+    EXPECT_EQ(std::string("lib.so"), created.settled_files.data[0]);
+}
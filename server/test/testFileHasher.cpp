@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <string>
+
+#include "TemporaryFile.h"
+
+extern "C" {
+#include "../FileHasher.h"
+#include "../XXHash64.h"
+}
+
+namespace {
+uint64_t XXH64InPieces(const std::string& data, size_t piece_size) {
+    XXH64State state;
+    XXH64Init(&state, 0);
+    for (size_t position = 0; position < data.size(); position += piece_size)
+        XXH64Update(&state, data.data() + position, std::min(piece_size, data.size() - position));
+    return XXH64Final(&state);
+}
+
+std::string HashFile(FileHasherFunction hashFile, const std::string& file) {
+    Digest digest;
+    if (!hashFile(file.c_str(), &digest))
+        return "";
+    char hex[DIGEST_HEX_BUFFER_SIZE];
+    DigestToHex(&digest, hex);
+    return hex;
+}
+} // namespace
+
+TEST(testFileHasher, XXH64KnownValues) {
+    EXPECT_EQ(0xef46db3751d8e999ULL, XXH64InPieces("", 1));
+    EXPECT_EQ(0x44bc2cf5ad770999ULL, XXH64InPieces("abc", 1));
+    EXPECT_EQ(0x375041e8b1decfb3ULL, XXH64InPieces(std::string(100, 'a'), 100));
+}
+
+TEST(testFileHasher, XXH64PiecesDontMatter) {
+    std::string given_data;
+    for (int i = 0; i < 1000; ++i)
+        given_data.push_back(static_cast<char>(i * 131 + 7));
+
+    const uint64_t expected_hash = XXH64InPieces(given_data, given_data.size());
+    for (size_t piece_size : {1, 7, 31, 32, 33, 100})
+        EXPECT_EQ(expected_hash, XXH64InPieces(given_data, piece_size)) << "piece size " << piece_size;
+}
+
+TEST(testFileHasher, HashFileWithAlgorithm) {
+    TemporaryFile given_file("testFileHasher");
+    given_file.Write(std::string(100, 'a'));
+
+    EXPECT_EQ("375041e8b1decfb3", HashFile(FileHasherForAlgorithm(HASH_ALGORITHM_XXH64), given_file.name));
+    EXPECT_EQ("7f9000257a4918d7072655ea468540cdcbd42e0c",
+              HashFile(FileHasherForAlgorithm(HASH_ALGORITHM_SHA1), given_file.name));
+
+    remove(given_file.name.c_str());
+    EXPECT_EQ("", HashFile(&FileHasher_DoXXH64, given_file.name));
+}
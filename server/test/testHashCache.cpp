@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include "TemporaryFile.h"
+
+extern "C" {
+#include "../Digest.h"
+#include "../HashCache.h"
+}
+
+namespace {
+size_t hash_calls = 0;
+
+// The n-th call results in the digest "0n"
+int FakeHashFile(const char* file, Digest* digest) {
+    ++hash_calls;
+    digest->size = 1;
+    digest->bytes[0] = (unsigned char)hash_calls;
+    return 1;
+}
+
+std::string Hex(const Digest& digest) {
+    char hex[DIGEST_HEX_BUFFER_SIZE];
+    DigestToHex(&digest, hex);
+    return hex;
+}
+} // namespace
+
+TEST(testHashCache, CalculateTwiceHashesOnce) {
+    hash_calls = 0;
+    TemporaryFile given_file("testHashCache");
+    given_file.Write("content");
+
+    HashCache created_cache;
+    HashCacheInit(&created_cache, &FakeHashFile);
+
+    Digest digest;
+    EXPECT_TRUE(HashCacheCalculate(&created_cache, given_file.name.c_str(), &digest));
+    EXPECT_EQ("01", Hex(digest));
+
+    EXPECT_TRUE(HashCacheCalculate(&created_cache, given_file.name.c_str(), &digest));
+    EXPECT_EQ("01", Hex(digest));
+
+    EXPECT_EQ(1u, hash_calls);
+    EXPECT_EQ(1u, created_cache.hits);
+    EXPECT_EQ(1u, created_cache.misses);
+
+    HashCacheDeinit(&created_cache);
+}
+
+TEST(testHashCache, ChangedFileIsHashedAgain) {
+    hash_calls = 0;
+    TemporaryFile given_file("testHashCache");
+    given_file.Write("content");
+
+    HashCache created_cache;
+    HashCacheInit(&created_cache, &FakeHashFile);
+
+    Digest digest;
+    HashCacheCalculate(&created_cache, given_file.name.c_str(), &digest);
+
+    given_file.Write("other content");
+    HashCacheCalculate(&created_cache, given_file.name.c_str(), &digest);
+    EXPECT_EQ("02", Hex(digest));
+
+    EXPECT_EQ(0u, created_cache.hits);
+    EXPECT_EQ(2u, created_cache.misses);
+
+    HashCacheDeinit(&created_cache);
+}
+
+TEST(testHashCache, MissingFile) {
+    hash_calls = 0;
+    HashCache created_cache;
+    HashCacheInit(&created_cache, &FakeHashFile);
+
+    Digest digest;
+    EXPECT_FALSE(HashCacheCalculate(&created_cache, "/tmp/testHashCacheDoesNotExist", &digest));
+    EXPECT_TRUE(DigestIsEmpty(&digest));
+    EXPECT_EQ(0u, hash_calls);
+
+    HashCacheDeinit(&created_cache);
+}
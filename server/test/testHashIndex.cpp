@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+
+#include "TemporaryFile.h"
+
+extern "C" {
+#include "../HashIndex.h"
+}
+
+namespace {
+size_t hash_calls = 0;
+
+int FakeHashFile(const char* file, Digest* digest) {
+    ++hash_calls;
+    return DigestFromHex("abcdef", digest);
+}
+
+// Writes a record for 'file' as if it was hashed with FakeHashFile
+void AppendFakeRecord(const std::string& index_file, const std::string& file, HashAlgorithm algorithm) {
+    HashIndex created_index;
+    ASSERT_TRUE(HashIndexOpen(&created_index, index_file.c_str()));
+    FileStatIdentity identity;
+    ASSERT_TRUE(FileStatIdentityRead(file.c_str(), &identity));
+    Digest digest;
+    DigestFromHex("abcdef", &digest);
+    EXPECT_TRUE(HashIndexAppend(&created_index, algorithm, file.c_str(), &identity, &digest));
+    HashIndexClose(&created_index);
+}
+
+// Returns the amount of loaded records, 'hashed' is TRUE when the cache had to hash the file
+size_t LoadAndCalculate(const std::string& index_file, const std::string& file, HashAlgorithm algorithm,
+                        int* hashed) {
+    hash_calls = 0;
+    HashIndex created_index;
+    EXPECT_TRUE(HashIndexOpen(&created_index, index_file.c_str()));
+    HashCache created_cache;
+    HashCacheInit(&created_cache, &FakeHashFile);
+    const size_t loaded = HashIndexLoad(&created_index, algorithm, &created_cache);
+
+    Digest digest;
+    EXPECT_TRUE(HashCacheCalculate(&created_cache, file.c_str(), &digest));
+    *hashed = hash_calls > 0;
+
+    HashCacheDeinit(&created_cache);
+    HashIndexClose(&created_index);
+    return loaded;
+}
+} // namespace
+
+TEST(testHashIndex, DigestsSurviveAReopen) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_SHA1);
+
+    int hashed;
+    EXPECT_EQ(1u, LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed));
+    EXPECT_FALSE(hashed);
+}
+
+TEST(testHashIndex, OtherAlgorithmIsNotLoaded) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_XXH64);
+
+    int hashed;
+    EXPECT_EQ(0u, LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed));
+    EXPECT_TRUE(hashed);
+}
+
+TEST(testHashIndex, StaleRecordIsNotUsed) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_SHA1);
+    given_file.Write("other content");
+
+    int hashed;
+    LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed);
+    EXPECT_TRUE(hashed);
+}
+
+TEST(testHashIndex, IncompleteRecordIsTruncated) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_SHA1);
+    const off_t intact_size = given_index.Size();
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_SHA1);
+    ASSERT_EQ(0, truncate(given_index.name.c_str(), given_index.Size() - 3));
+
+    int hashed;
+    EXPECT_EQ(1u, LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed));
+    EXPECT_FALSE(hashed);
+    EXPECT_EQ(intact_size, given_index.Size());
+}
+
+TEST(testHashIndex, CorruptRecordIsIgnored) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_SHA1);
+    {
+        // Flips a bit of the path
+        std::fstream index_stream(given_index.name, std::ios::in | std::ios::out | std::ios::binary);
+        index_stream.seekg(-1, std::ios::end);
+        const char last = static_cast<char>(index_stream.get());
+        index_stream.seekp(-1, std::ios::end);
+        index_stream.put(static_cast<char>(last ^ 1));
+    }
+
+    int hashed;
+    EXPECT_EQ(0u, LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed));
+    EXPECT_TRUE(hashed);
+}
+
+TEST(testHashIndex, UnknownFileIsStartedOver) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+    given_index.Write("this is not a hash index at all");
+
+    AppendFakeRecord(given_index.name, given_file.name, HASH_ALGORITHM_SHA1);
+
+    int hashed;
+    EXPECT_EQ(1u, LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed));
+    EXPECT_FALSE(hashed);
+}
+
+TEST(testHashIndex, SecondWriterIsRefused) {
+    TemporaryFile given_index("testHashIndex");
+
+    HashIndex created_index, created_second_index;
+    ASSERT_TRUE(HashIndexOpen(&created_index, given_index.name.c_str()));
+    EXPECT_FALSE(HashIndexOpen(&created_second_index, given_index.name.c_str()));
+    EXPECT_EQ(-1, created_second_index.fd);
+    HashIndexClose(&created_second_index);
+
+    HashIndexClose(&created_index);
+    EXPECT_TRUE(HashIndexOpen(&created_second_index, given_index.name.c_str()));
+    HashIndexClose(&created_second_index);
+}
+
+TEST(testHashIndex, AppendingKeepsTheIndexBounded) {
+    TemporaryFile given_index("testHashIndex"), given_file("testHashIndexFile");
+    given_file.Write("content");
+    FileStatIdentity given_identity;
+    ASSERT_TRUE(FileStatIdentityRead(given_file.name.c_str(), &given_identity));
+    Digest given_digest;
+    DigestFromHex("abcdef", &given_digest);
+
+    HashIndex created_index;
+    ASSERT_TRUE(HashIndexOpen(&created_index, given_index.name.c_str()));
+    HashCache created_cache;
+    HashCacheInit(&created_cache, &FakeHashFile);
+    HashCacheStore(&created_cache, given_file.name.c_str(), &given_identity, &given_digest);
+
+    // The same file over and over, like a library that is rebuilt while the server runs
+    int compacted = 0;
+    for (int i = 0; i < 10000; ++i) {
+        EXPECT_TRUE(HashIndexAppend(&created_index, HASH_ALGORITHM_SHA1, given_file.name.c_str(), &given_identity,
+                                    &given_digest));
+        compacted += HashIndexCompactIfMostlyReplaced(&created_index, HASH_ALGORITHM_SHA1, &created_cache);
+    }
+    EXPECT_EQ(2, compacted);
+    EXPECT_GE(4097u, created_index.record_count);
+    HashCacheDeinit(&created_cache);
+    HashIndexClose(&created_index);
+
+    int hashed;
+    EXPECT_EQ(created_index.record_count,
+              LoadAndCalculate(given_index.name, given_file.name, HASH_ALGORITHM_SHA1, &hashed));
+    EXPECT_FALSE(hashed);
+}
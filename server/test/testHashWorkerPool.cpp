@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+
+#include <map>
+#include <string>
+
+#include <poll.h>
+
+extern "C" {
+#include "../HashWorkerPool.h"
+}
+
+namespace {
+// The digest is the length of the file name
+int FakeHashFile(const char* file, Digest* digest) {
+    DigestClear(digest);
+    if (std::string(file) == "unreadable")
+        return 0;
+    digest->size = 1;
+    digest->bytes[0] = (unsigned char)strlen(file);
+    return 1;
+}
+
+// Collects completed jobs until 'expected_count' results arrived, or until polling times out
+std::map<std::string, std::string> WaitForResults(HashWorkerPool* pool, size_t expected_count) {
+    std::map<std::string, std::string> results;
+    while (results.size() < expected_count) {
+        struct pollfd pfd = {pool->fd, POLLIN, 0};
+        if (poll(&pfd, 1, 5000) <= 0)
+            break;
+
+        HashJobResult* completed = HashWorkerPoolTakeCompleted(pool);
+        for (HashJobResult* result = completed; result; result = result->next) {
+            char hex[DIGEST_HEX_BUFFER_SIZE];
+            DigestToHex(&result->digest, hex);
+            results[result->file] = hex;
+        }
+        HashJobResultFree(completed);
+    }
+    return results;
+}
+} // namespace
+
+TEST(testHashWorkerPool, HashesSubmittedFiles) {
+    HashWorkerPool created_pool;
+    ASSERT_TRUE(HashWorkerPoolInit(&created_pool, 4));
+
+    HashWorkerPoolSubmit(&created_pool, "app", &FakeHashFile);
+    HashWorkerPoolSubmit(&created_pool, "lib.so", &FakeHashFile);
+    HashWorkerPoolSubmit(&created_pool, "unreadable", &FakeHashFile);
+
+    const auto results = WaitForResults(&created_pool, 3);
+    ASSERT_EQ(3u, results.size());
+    EXPECT_EQ("03", results.at("app"));
+    EXPECT_EQ("06", results.at("lib.so"));
+    EXPECT_EQ("", results.at("unreadable"));
+
+    EXPECT_EQ(nullptr, HashWorkerPoolTakeCompleted(&created_pool));
+
+    HashWorkerPoolDeinit(&created_pool);
+}
+
+TEST(testHashWorkerPool, DeinitWithQueuedJobs) {
+    HashWorkerPool created_pool;
+    ASSERT_TRUE(HashWorkerPoolInit(&created_pool, 1));
+
+    for (int i = 0; i < 100; ++i)
+        HashWorkerPoolSubmit(&created_pool, std::to_string(i).c_str(), &FakeHashFile);
+
+    HashWorkerPoolDeinit(&created_pool);
+    EXPECT_EQ(-1, created_pool.fd);
+}
@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+extern "C" {
+#include "../DynamicStringArray.h"
+#include "../OutputBatcher.h"
+}
+
+namespace {
+struct OutputBatcherRAII {
+    OutputBatcherRAII(size_t batch_size, long long delay_ms) {
+        OutputBatcherInit(&batcher, batch_size, delay_ms);
+        DynamicStringArrayInit(&batches);
+    }
+    ~OutputBatcherRAII() {
+        OutputBatcherDeinit(&batcher);
+        DynamicStringArrayDeinit(&batches);
+    }
+
+    void Append(const std::string& data, long long now_ms) {
+        OutputBatcherAppend(&batcher, data.data(), data.size(), now_ms);
+    }
+
+    OutputBatcher batcher;
+    DynamicStringArray batches;
+};
+} // namespace
+
+TEST(testOutputBatcher, DueAfterDelay) {
+    OutputBatcherRAII created(1024, 5);
+    EXPECT_EQ(-1, OutputBatcherTimeUntilDue(&created.batcher, 0));
+
+    created.Append("first ", 10);
+    created.Append("second", 13);
+    EXPECT_EQ(2, OutputBatcherTimeUntilDue(&created.batcher, 13));
+    OutputBatcherTakeDue(&created.batcher, 14, &created.batches);
+    EXPECT_EQ(0u, created.batches.size);
+
+    // Counted from the oldest byte
+    OutputBatcherTakeDue(&created.batcher, 15, &created.batches);
+    ASSERT_EQ(1u, created.batches.size);
+    EXPECT_EQ(std::string("first second"), created.batches.data[0]);
+    EXPECT_EQ(-1, OutputBatcherTimeUntilDue(&created.batcher, 15));
+}
+
+TEST(testOutputBatcher, FullBatchEndsAfterLastLine) {
+    OutputBatcherRAII created(10, 1000);
+    created.Append("abc\ndef\nghijk", 0);
+    EXPECT_EQ(0, OutputBatcherTimeUntilDue(&created.batcher, 0));
+
+    OutputBatcherTakeDue(&created.batcher, 0, &created.batches);
+    ASSERT_EQ(1u, created.batches.size);
+    EXPECT_EQ(std::string("abc\ndef\n"), created.batches.data[0]);
+    EXPECT_EQ(std::string("ghijk"), std::string(created.batcher.pending.data, created.batcher.pending.size));
+    EXPECT_EQ(1000, OutputBatcherTimeUntilDue(&created.batcher, 0));
+}
+
+TEST(testOutputBatcher, LongLineIsSplit) {
+    OutputBatcherRAII created(4, 1000);
+    created.Append("0123456789\n", 0);
+
+    OutputBatcherTakeDue(&created.batcher, 0, &created.batches);
+    ASSERT_EQ(2u, created.batches.size);
+    EXPECT_EQ(std::string("0123"), created.batches.data[0]);
+    EXPECT_EQ(std::string("4567"), created.batches.data[1]);
+
+    OutputBatcherTakeAll(&created.batcher, &created.batches);
+    ASSERT_EQ(3u, created.batches.size);
+    EXPECT_EQ(std::string("89\n"), created.batches.data[2]);
+    EXPECT_EQ(0u, created.batcher.pending.size);
+}
+
+TEST(testOutputBatcher, ZeroDelayTakesEverything) {
+    OutputBatcherRAII created(1024, 0);
+    created.Append("partial", 7);
+    EXPECT_EQ(0, OutputBatcherTimeUntilDue(&created.batcher, 7));
+
+    OutputBatcherTakeDue(&created.batcher, 7, &created.batches);
+    ASSERT_EQ(1u, created.batches.size);
+    EXPECT_EQ(std::string("partial"), created.batches.data[0]);
+}
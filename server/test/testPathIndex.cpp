@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "../PathIndex.h"
+}
+
+namespace {
+struct PathIndexRAII {
+    PathIndexRAII() { PathIndexInit(&index); }
+    ~PathIndexRAII() { PathIndexDeinit(&index); }
+
+    PathIndex index;
+};
+} // namespace
+
+TEST(testPathIndex, InsertAndFind) {
+    PathIndexRAII created;
+    EXPECT_EQ(PATH_INDEX_NOT_FOUND, PathIndexFind(&created.index, "app"));
+
+    PathIndexInsert(&created.index, "app", 0);
+    PathIndexInsert(&created.index, "libpng.so", 1);
+    EXPECT_EQ(0u, PathIndexFind(&created.index, "app"));
+    EXPECT_EQ(1u, PathIndexFind(&created.index, "libpng.so"));
+    EXPECT_EQ(PATH_INDEX_NOT_FOUND, PathIndexFind(&created.index, "zlib.so"));
+
+    PathIndexInsert(&created.index, "app", 5);
+    EXPECT_EQ(5u, PathIndexFind(&created.index, "app"));
+    EXPECT_EQ(2u, created.index.size);
+
+    PathIndexClear(&created.index);
+    EXPECT_EQ(PATH_INDEX_NOT_FOUND, PathIndexFind(&created.index, "app"));
+    EXPECT_EQ(0u, created.index.size);
+}
+
+TEST(testPathIndex, ManyPathsWithErase) {
+    PathIndexRAII created;
+    std::vector<std::string> given_paths;
+    for (int i = 0; i < 5000; ++i)
+        given_paths.push_back("/usr/lib/lib" + std::to_string(i) + ".so");
+    for (size_t i = 0; i < given_paths.size(); ++i)
+        PathIndexInsert(&created.index, given_paths[i].c_str(), i);
+
+    // Erasing every third path must not hide the paths that were probed past them
+    for (size_t i = 0; i < given_paths.size(); i += 3)
+        PathIndexErase(&created.index, given_paths[i].c_str());
+    PathIndexErase(&created.index, "/usr/lib/unknown.so");
+
+    for (size_t i = 0; i < given_paths.size(); ++i) {
+        const size_t expected = i % 3 == 0 ? PATH_INDEX_NOT_FOUND : i;
+        EXPECT_EQ(expected, PathIndexFind(&created.index, given_paths[i].c_str())) << given_paths[i];
+    }
+    EXPECT_EQ(given_paths.size() - (given_paths.size() + 2) / 3, created.index.size);
+}
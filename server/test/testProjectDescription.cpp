@@ -1,9 +1,12 @@
 #include <optional>
+#include <string>
+#include <vector>
 
 #include <gtest/gtest.h>
 
 extern "C" {
 #include "../ProjectDescription.h"
+#include "../ProjectDescription_binary.h"
 #include "../ProjectDescription_json.h"
 }
 
@@ -81,6 +84,87 @@ TEST(testProjectDescription, LoadFromJSONWithWrongTypes) {
                                                 &created_description));
 }
 
+TEST(testProjectDescription, LoadFromJSON_HashAlgorithm) {
+    ProjectDescriptionRAII created_description;
+
+    const char* json_string = "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+                              "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": "
+                              "[], \"hash_algorithm\": \"xxh64\"}";
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(json_string, &created_description.description));
+
+    EXPECT_EQ(HASH_ALGORITHM_XXH64, created_description.description.hash_algorithm);
+}
+
+TEST(testProjectDescription, LoadFromJSON_WithoutHashAlgorithmIsSHA1) {
+    ProjectDescriptionRAII created_description;
+
+    const char* json_string = "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+                              "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": "
+                              "[]}";
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(json_string, &created_description.description));
+
+    EXPECT_EQ(HASH_ALGORITHM_SHA1, created_description.description.hash_algorithm);
+}
+
+TEST(testProjectDescription, LoadFromJSON_UnknownHashAlgorithm) {
+    ProjectDescription created_description;
+
+    ASSERT_FALSE(ProjectDescriptionLoadFromJSON(
+        "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+        "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": [], "
+        "\"hash_algorithm\": \"md4\"}",
+        &created_description));
+
+    ASSERT_FALSE(ProjectDescriptionLoadFromJSON(
+        "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+        "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": [], "
+        "\"hash_algorithm\": 1}",
+        &created_description));
+}
+
+TEST(testProjectDescription, LoadFromJSON_Sizes) {
+    ProjectDescriptionRAII created_description;
+
+    const char* json_string = "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+                              "\"link_dependencies_for_executable\": [\"freetype.so\", \"libpng.so\"], "
+                              "\"link_dependencies_for_executable_hashes\": [\"abcd\", \"efgh\"], "
+                              "\"executable_size\": 1234, \"link_dependencies_for_executable_sizes\": [56, \"78\"]}";
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(json_string, &created_description.description));
+
+    EXPECT_EQ(1234, created_description.description.executable_size);
+    ASSERT_EQ(2u, created_description.description.link_dependencies_for_executable_sizes.size);
+    EXPECT_EQ(56, created_description.description.link_dependencies_for_executable_sizes.data[0]);
+    EXPECT_EQ(-1, created_description.description.link_dependencies_for_executable_sizes.data[1]);
+}
+
+TEST(testProjectDescription, LoadFromJSON_WithoutSizes) {
+    ProjectDescriptionRAII created_description;
+
+    const char* json_string = "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+                              "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": "
+                              "[]}";
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(json_string, &created_description.description));
+
+    EXPECT_EQ(-1, created_description.description.executable_size);
+    EXPECT_EQ(0u, created_description.description.link_dependencies_for_executable_sizes.size);
+}
+
+TEST(testProjectDescription, LoadFromJSON_InvalidSizes) {
+    ProjectDescription created_description;
+
+    ASSERT_FALSE(ProjectDescriptionLoadFromJSON(
+        "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+        "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": [], "
+        "\"executable_size\": \"1234\"}",
+        &created_description));
+
+    ASSERT_FALSE(ProjectDescriptionLoadFromJSON(
+        "{\"executable_name\": \"LightSpeedFileExplorer\",\"executable_hash\": \"hijk\", "
+        "\"link_dependencies_for_executable\": [], \"link_dependencies_for_executable_hashes\": [], "
+        "\"link_dependencies_for_executable_sizes\": 5}",
+        &created_description));
+}
+
 TEST(testProjectDescription, LoadFromJSON_NoLinkTimeDeps) {
     ProjectDescriptionRAII created_description;
 
@@ -103,6 +187,50 @@ static std::optional<std::tuple<size_t, char, char>> FindFirstDifferentElement(c
     return {};
 }
 
+TEST(testProjectDescription, LoadFromJSONStream_OneByteAtATime) {
+    const std::string given_json = "{\"executable_name\": \"app\", \"executable_hash\": \"abcd\", "
+                                   "\"link_dependencies_for_executable\": [\"first.so\", \"second.so\"], "
+                                   "\"link_dependencies_for_executable_hashes\": [\"01\", \"02\"], "
+                                   "\"link_dependencies_for_executable_sizes\": [12345, 6]}";
+    ProjectDescriptionRAII expected_description;
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(given_json.c_str(), &expected_description.description));
+
+    ProjectDescriptionJSONStream given_stream;
+    ProjectDescriptionJSONStreamInit(&given_stream);
+    for (size_t i = 0; i < given_json.size(); ++i)
+        ASSERT_TRUE(ProjectDescriptionJSONStreamFeed(&given_stream, &given_json[i], 1)) << i;
+    // What follows the JSON is ignored
+    ASSERT_TRUE(ProjectDescriptionJSONStreamFeed(&given_stream, " }", 2));
+    ProjectDescriptionRAII created_description;
+    ASSERT_TRUE(ProjectDescriptionJSONStreamFinish(&given_stream, &created_description.description));
+    ProjectDescriptionJSONStreamDeinit(&given_stream);
+
+    EXPECT_TRUE(ProjectDescriptionEqual(&expected_description.description, &created_description.description));
+}
+
+TEST(testProjectDescription, LoadFromJSONStream_IncompleteOrInvalid) {
+    ProjectDescriptionJSONStream given_stream;
+    ProjectDescription created_description;
+
+    ProjectDescriptionJSONStreamInit(&given_stream);
+    EXPECT_TRUE(ProjectDescriptionJSONStreamFeed(&given_stream, "{\"executable_name\": ", 20));
+    EXPECT_FALSE(ProjectDescriptionJSONStreamFinish(&given_stream, &created_description));
+    ProjectDescriptionJSONStreamDeinit(&given_stream);
+
+    // Invalid JSON is noticed right away, not once the packet ends
+    ProjectDescriptionJSONStreamInit(&given_stream);
+    EXPECT_FALSE(ProjectDescriptionJSONStreamFeed(&given_stream, "{]", 2));
+    EXPECT_FALSE(ProjectDescriptionJSONStreamFeed(&given_stream, "}", 1));
+    EXPECT_FALSE(ProjectDescriptionJSONStreamFinish(&given_stream, &created_description));
+    ProjectDescriptionJSONStreamDeinit(&given_stream);
+
+    // Complete JSON that is not a project description
+    ProjectDescriptionJSONStreamInit(&given_stream);
+    EXPECT_TRUE(ProjectDescriptionJSONStreamFeed(&given_stream, "{\"a\": 1}", 8));
+    EXPECT_FALSE(ProjectDescriptionJSONStreamFinish(&given_stream, &created_description));
+    ProjectDescriptionJSONStreamDeinit(&given_stream);
+}
+
 TEST(testProjectDescription, DumpToJSON) {
     ProjectDescriptionRAII given_description;
 
@@ -126,4 +254,142 @@ TEST(testProjectDescription, DumpToJSON) {
     EXPECT_EQ(expected_json_dump, created_json_dump)
         << "Different character at: " << std::get<0>(*FindFirstDifferentElement(expected_json_dump, created_json_dump));
     free(created_json_dump);
-}
\ No newline at end of file
+}
+
+TEST(testProjectDescription, DumpToJSON_HashAlgorithm) {
+    ProjectDescriptionRAII given_description;
+
+    ProjectDescriptionInit(&given_description.description, "DebuggerBootstrap", "mnop");
+    given_description.description.hash_algorithm = HASH_ALGORITHM_XXH64;
+
+    char* created_json_dump = ProjectDescriptionDumpToJSON(&given_description.description);
+    ProjectDescriptionRAII created_description;
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(created_json_dump, &created_description.description));
+    EXPECT_EQ(HASH_ALGORITHM_XXH64, created_description.description.hash_algorithm);
+    free(created_json_dump);
+}
+
+TEST(testProjectDescription, DumpToJSON_Sizes) {
+    ProjectDescriptionRAII given_description;
+
+    ProjectDescriptionInit(&given_description.description, "DebuggerBootstrap", "mnop");
+    DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable, "libpng.so");
+    DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable_hashes, "abcd");
+    given_description.description.executable_size = 4096;
+    DynamicFileSizeArrayAppend(&given_description.description.link_dependencies_for_executable_sizes, 512);
+
+    char* created_json_dump = ProjectDescriptionDumpToJSON(&given_description.description);
+    ProjectDescriptionRAII created_description;
+    ASSERT_TRUE(ProjectDescriptionLoadFromJSON(created_json_dump, &created_description.description));
+    EXPECT_EQ(4096, created_description.description.executable_size);
+    ASSERT_EQ(1u, created_description.description.link_dependencies_for_executable_sizes.size);
+    EXPECT_EQ(512, created_description.description.link_dependencies_for_executable_sizes.data[0]);
+    free(created_json_dump);
+}
+
+TEST(testProjectDescription, DumpAndLoadBinary) {
+    ProjectDescriptionRAII given_description;
+
+    ProjectDescriptionInit(&given_description.description, "/project/bin/app", "0123456789abcdef");
+    given_description.description.hash_algorithm = HASH_ALGORITHM_XXH64;
+    given_description.description.executable_size = 4096;
+    const char* given_files[] = {"/project/lib/libpng.so", "/project/lib/libz.so", "/usr/lib/libc.so", "plain.so"};
+    for (const char* file : given_files) {
+        DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable, file);
+        DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable_hashes, "ABCD");
+    }
+    DynamicFileSizeArrayAppend(&given_description.description.link_dependencies_for_executable_sizes, 0);
+    DynamicFileSizeArrayAppend(&given_description.description.link_dependencies_for_executable_sizes, -1);
+    DynamicFileSizeArrayAppend(&given_description.description.link_dependencies_for_executable_sizes, 300);
+    DynamicFileSizeArrayAppend(&given_description.description.link_dependencies_for_executable_sizes, 1LL << 40);
+    DynamicStringArrayAppend(&given_description.description.executable_arguments, "--port");
+    DynamicStringArrayAppend(&given_description.description.executable_arguments, "");
+
+    uint8_t* created_binary;
+    size_t created_binary_size;
+    ASSERT_TRUE(
+        ProjectDescriptionDumpToBinary(&given_description.description, &created_binary, &created_binary_size));
+    ProjectDescriptionRAII created_description;
+    ASSERT_TRUE(ProjectDescriptionLoadFromBinary(created_binary, created_binary_size, &created_description.description));
+    free(created_binary);
+
+    // Hashes are stored as bytes, so they come back in lowercase
+    DynamicStringArrayClear(&given_description.description.link_dependencies_for_executable_hashes);
+    for (size_t i = 0; i < 4; ++i)
+        DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable_hashes, "abcd");
+    EXPECT_TRUE(ProjectDescriptionEqual(&given_description.description, &created_description.description));
+    EXPECT_EQ(HASH_ALGORITHM_XXH64, created_description.description.hash_algorithm);
+    EXPECT_EQ(std::string("/usr/lib/libc.so"),
+              created_description.description.link_dependencies_for_executable.data[2]);
+}
+
+TEST(testProjectDescription, DumpToBinary_SharesPrefixes) {
+    ProjectDescriptionRAII given_description;
+
+    ProjectDescriptionInit(&given_description.description, "/a/very/long/project/directory/app", "");
+    for (int i = 0; i < 100; ++i) {
+        const std::string file = "/a/very/long/project/directory/lib" + std::to_string(i) + ".so";
+        DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable, file.c_str());
+        DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable_hashes, "");
+    }
+
+    uint8_t* created_binary;
+    size_t created_binary_size;
+    ASSERT_TRUE(
+        ProjectDescriptionDumpToBinary(&given_description.description, &created_binary, &created_binary_size));
+    // The directory is written once, every file takes its index, its name and an empty digest
+    EXPECT_LT(created_binary_size, 100u * 12u);
+
+    ProjectDescriptionRAII created_description;
+    ASSERT_TRUE(ProjectDescriptionLoadFromBinary(created_binary, created_binary_size, &created_description.description));
+    EXPECT_TRUE(ProjectDescriptionEqual(&given_description.description, &created_description.description));
+    free(created_binary);
+}
+
+TEST(testProjectDescription, DumpToBinary_HashThatIsNotHexadecimal) {
+    ProjectDescriptionRAII given_description;
+    ProjectDescriptionInit(&given_description.description, "app", "hijk");
+
+    uint8_t* created_binary;
+    size_t created_binary_size;
+    EXPECT_FALSE(
+        ProjectDescriptionDumpToBinary(&given_description.description, &created_binary, &created_binary_size));
+}
+
+TEST(testProjectDescription, LoadFromTruncatedOrCorruptBinary) {
+    ProjectDescriptionRAII given_description;
+    ProjectDescriptionInit(&given_description.description, "/project/app", "abcd");
+    DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable, "/project/lib.so");
+    DynamicStringArrayAppend(&given_description.description.link_dependencies_for_executable_hashes, "ef01");
+    DynamicStringArrayAppend(&given_description.description.executable_arguments, "-v");
+
+    uint8_t* given_binary;
+    size_t given_binary_size;
+    ASSERT_TRUE(ProjectDescriptionDumpToBinary(&given_description.description, &given_binary, &given_binary_size));
+
+    ProjectDescription created_description;
+    for (size_t size = 0; size < given_binary_size; ++size)
+        EXPECT_FALSE(ProjectDescriptionLoadFromBinary(given_binary, size, &created_description)) << size;
+
+    std::vector<uint8_t> given_corrupt(given_binary, given_binary + given_binary_size);
+    given_corrupt.push_back(0);
+    EXPECT_FALSE(ProjectDescriptionLoadFromBinary(given_corrupt.data(), given_corrupt.size(), &created_description));
+
+    // Every byte is changed in turn, which must never be read out of bounds
+    for (size_t i = 0; i < given_binary_size; ++i) {
+        given_corrupt.assign(given_binary, given_binary + given_binary_size);
+        given_corrupt[i] ^= 0xff;
+        if (ProjectDescriptionLoadFromBinary(given_corrupt.data(), given_corrupt.size(), &created_description))
+            ProjectDescriptionDeinit(&created_description);
+    }
+
+    // The second byte is the hash algorithm
+    given_corrupt.assign(given_binary, given_binary + given_binary_size);
+    given_corrupt[1] = HASH_ALGORITHM_COUNT;
+    EXPECT_FALSE(ProjectDescriptionLoadFromBinary(given_corrupt.data(), given_corrupt.size(), &created_description));
+    given_corrupt[1] = HASH_ALGORITHM_COUNT - 1;
+    ASSERT_TRUE(ProjectDescriptionLoadFromBinary(given_corrupt.data(), given_corrupt.size(), &created_description));
+    EXPECT_EQ(HASH_ALGORITHM_COUNT - 1, created_description.hash_algorithm);
+    ProjectDescriptionDeinit(&created_description);
+    free(given_binary);
+}
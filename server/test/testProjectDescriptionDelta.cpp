@@ -0,0 +1,195 @@
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+extern "C" {
+#include "../ProjectDescription.h"
+#include "../ProjectDescriptionDelta.h"
+#include "../ProjectDescription_binary.h"
+}
+
+namespace {
+struct ProjectDescriptionRAII {
+    ~ProjectDescriptionRAII() { ProjectDescriptionDeinit(&description); }
+
+    ProjectDescription description;
+};
+
+struct ProjectDescriptionDeltaRAII {
+    ProjectDescriptionDeltaRAII(ProjectDescriptionDeltaType type, unsigned long long generation) {
+        ProjectDescriptionDeltaInit(&delta, type, generation);
+    }
+    ~ProjectDescriptionDeltaRAII() { ProjectDescriptionDeltaDeinit(&delta); }
+
+    ProjectDescriptionDelta delta;
+};
+
+void MakeBaseDescription(ProjectDescription* description) {
+    ProjectDescriptionInit(description, "/project/app", "aa");
+    const char* files[] = {"/project/liba.so", "/project/libb.so", "/project/libc.so"};
+    const char* hashes[] = {"01", "02", "03"};
+    for (int i = 0; i < 3; ++i) {
+        DynamicStringArrayAppend(&description->link_dependencies_for_executable, files[i]);
+        DynamicStringArrayAppend(&description->link_dependencies_for_executable_hashes, hashes[i]);
+        DynamicFileSizeArrayAppend(&description->link_dependencies_for_executable_sizes, 100 + i);
+    }
+    DynamicStringArrayAppend(&description->executable_arguments, "--verbose");
+}
+
+std::vector<std::string> Strings(const DynamicStringArray& array) {
+    return std::vector<std::string>(array.data, array.data + array.size);
+}
+
+std::vector<long long> Sizes(const DynamicFileSizeArray& array) {
+    return std::vector<long long>(array.data, array.data + array.size);
+}
+} // namespace
+
+TEST(testProjectDescriptionDelta, UpsertReplacesAndAppends) {
+    ProjectDescriptionRAII given_base;
+    MakeBaseDescription(&given_base.description);
+    ProjectDescriptionDeltaRAII given_delta(PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES, 1);
+    DynamicStringArrayAppend(&given_delta.delta.files, "/project/libd.so");
+    DynamicStringArrayAppend(&given_delta.delta.hashes, "04");
+    DynamicFileSizeArrayAppend(&given_delta.delta.sizes, 200);
+    DynamicStringArrayAppend(&given_delta.delta.files, "/project/libb.so");
+    DynamicStringArrayAppend(&given_delta.delta.hashes, "22");
+    DynamicFileSizeArrayAppend(&given_delta.delta.sizes, -1);
+
+    ProjectDescriptionRAII created_description;
+    ProjectDescriptionApplyDelta(&given_base.description, &given_delta.delta, &created_description.description);
+
+    const ProjectDescription& created = created_description.description;
+    EXPECT_EQ(std::string("/project/app"), created.executable_name);
+    EXPECT_EQ(std::vector<std::string>({"--verbose"}), Strings(created.executable_arguments));
+    EXPECT_EQ(
+        std::vector<std::string>({"/project/liba.so", "/project/libb.so", "/project/libc.so", "/project/libd.so"}),
+        Strings(created.link_dependencies_for_executable));
+    EXPECT_EQ(std::vector<std::string>({"01", "22", "03", "04"}),
+              Strings(created.link_dependencies_for_executable_hashes));
+    EXPECT_EQ(std::vector<long long>({100, -1, 102, 200}), Sizes(created.link_dependencies_for_executable_sizes));
+}
+
+TEST(testProjectDescriptionDelta, UpsertSameFileTwiceKeepsTheLast) {
+    ProjectDescriptionRAII given_base;
+    MakeBaseDescription(&given_base.description);
+    ProjectDescriptionDeltaRAII given_delta(PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES, 1);
+    const char* given_hashes[] = {"05", "06"};
+    for (const char* hash : given_hashes) {
+        DynamicStringArrayAppend(&given_delta.delta.files, "/project/libe.so");
+        DynamicStringArrayAppend(&given_delta.delta.hashes, hash);
+        DynamicFileSizeArrayAppend(&given_delta.delta.sizes, 1);
+    }
+
+    ProjectDescriptionRAII created_description;
+    ProjectDescriptionApplyDelta(&given_base.description, &given_delta.delta, &created_description.description);
+
+    ASSERT_EQ(4u, created_description.description.link_dependencies_for_executable.size);
+    EXPECT_EQ(std::string("06"), created_description.description.link_dependencies_for_executable_hashes.data[3]);
+}
+
+TEST(testProjectDescriptionDelta, UpsertWithSizesIntoDescriptionWithoutSizes) {
+    ProjectDescriptionRAII given_base;
+    ProjectDescriptionInit(&given_base.description, "app", "");
+    DynamicStringArrayAppend(&given_base.description.link_dependencies_for_executable, "first.so");
+    DynamicStringArrayAppend(&given_base.description.link_dependencies_for_executable_hashes, "01");
+    ProjectDescriptionDeltaRAII given_delta(PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES, 1);
+    DynamicStringArrayAppend(&given_delta.delta.files, "second.so");
+    DynamicStringArrayAppend(&given_delta.delta.hashes, "02");
+    DynamicFileSizeArrayAppend(&given_delta.delta.sizes, 42);
+
+    ProjectDescriptionRAII created_description;
+    ProjectDescriptionApplyDelta(&given_base.description, &given_delta.delta, &created_description.description);
+
+    // Either every file has a size or none has
+    EXPECT_EQ(std::vector<long long>({-1, 42}),
+              Sizes(created_description.description.link_dependencies_for_executable_sizes));
+}
+
+TEST(testProjectDescriptionDelta, RemoveEntries) {
+    ProjectDescriptionRAII given_base;
+    MakeBaseDescription(&given_base.description);
+    ProjectDescriptionDeltaRAII given_delta(PROJECT_DESCRIPTION_DELTA_REMOVE_ENTRIES, 1);
+    DynamicStringArrayAppend(&given_delta.delta.files, "/project/liba.so");
+    DynamicStringArrayAppend(&given_delta.delta.files, "/project/unknown.so");
+
+    ProjectDescriptionRAII created_description;
+    ProjectDescriptionApplyDelta(&given_base.description, &given_delta.delta, &created_description.description);
+
+    const ProjectDescription& created = created_description.description;
+    EXPECT_EQ(std::vector<std::string>({"/project/libb.so", "/project/libc.so"}),
+              Strings(created.link_dependencies_for_executable));
+    EXPECT_EQ(std::vector<std::string>({"02", "03"}), Strings(created.link_dependencies_for_executable_hashes));
+    EXPECT_EQ(std::vector<long long>({101, 102}), Sizes(created.link_dependencies_for_executable_sizes));
+}
+
+TEST(testProjectDescriptionDelta, SetExecutable) {
+    ProjectDescriptionRAII given_base;
+    MakeBaseDescription(&given_base.description);
+    ProjectDescriptionDeltaRAII given_delta(PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE, 1);
+    ProjectDescriptionDeltaSetExecutable(&given_delta.delta, "/project/other", "bb", 512);
+    DynamicStringArrayAppend(&given_delta.delta.executable_arguments, "--port");
+    DynamicStringArrayAppend(&given_delta.delta.executable_arguments, "1234");
+
+    ProjectDescriptionRAII created_description;
+    ProjectDescriptionApplyDelta(&given_base.description, &given_delta.delta, &created_description.description);
+
+    const ProjectDescription& created = created_description.description;
+    EXPECT_EQ(std::string("/project/other"), created.executable_name);
+    EXPECT_EQ(std::string("bb"), created.executable_hash);
+    EXPECT_EQ(512, created.executable_size);
+    EXPECT_EQ(std::vector<std::string>({"--port", "1234"}), Strings(created.executable_arguments));
+    EXPECT_TRUE(DynamicStringArrayEqual(&given_base.description.link_dependencies_for_executable,
+                                        &created.link_dependencies_for_executable));
+}
+
+TEST(testProjectDescriptionDelta, DumpAndLoadBinary) {
+    ProjectDescriptionDeltaRAII given_upsert(PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES, 300);
+    DynamicStringArrayAppend(&given_upsert.delta.files, "/project/liba.so");
+    DynamicStringArrayAppend(&given_upsert.delta.hashes, "0a0b");
+    DynamicFileSizeArrayAppend(&given_upsert.delta.sizes, -1);
+    ProjectDescriptionDeltaRAII given_remove(PROJECT_DESCRIPTION_DELTA_REMOVE_ENTRIES, 301);
+    DynamicStringArrayAppend(&given_remove.delta.files, "/project/libb.so");
+    ProjectDescriptionDeltaRAII given_executable(PROJECT_DESCRIPTION_DELTA_SET_EXECUTABLE, 302);
+    ProjectDescriptionDeltaSetExecutable(&given_executable.delta, "/project/app", "", 7);
+    DynamicStringArrayAppend(&given_executable.delta.executable_arguments, "-v");
+
+    for (const ProjectDescriptionDelta* given_delta :
+         {&given_upsert.delta, &given_remove.delta, &given_executable.delta}) {
+        uint8_t* created_binary;
+        size_t created_binary_size;
+        ASSERT_TRUE(ProjectDescriptionDeltaDumpToBinary(given_delta, &created_binary, &created_binary_size));
+        ProjectDescriptionDelta created_delta;
+        ASSERT_TRUE(ProjectDescriptionDeltaLoadFromBinary(given_delta->type, created_binary, created_binary_size,
+                                                          &created_delta));
+
+        EXPECT_EQ(given_delta->generation, created_delta.generation);
+        EXPECT_TRUE(DynamicStringArrayEqual(&given_delta->files, &created_delta.files));
+        EXPECT_TRUE(DynamicStringArrayEqual(&given_delta->hashes, &created_delta.hashes));
+        EXPECT_TRUE(DynamicFileSizeArrayEqual(&given_delta->sizes, &created_delta.sizes));
+        EXPECT_TRUE(DynamicStringArrayEqual(&given_delta->executable_arguments, &created_delta.executable_arguments));
+        EXPECT_EQ(given_delta->executable_size, created_delta.executable_size);
+        if (given_delta->executable_name)
+            EXPECT_EQ(std::string(given_delta->executable_name), created_delta.executable_name);
+
+        // A truncated delta is never taken for a complete one
+        for (size_t size = 0; size < created_binary_size; ++size) {
+            ProjectDescriptionDelta truncated_delta;
+            EXPECT_FALSE(ProjectDescriptionDeltaLoadFromBinary(given_delta->type, created_binary, size,
+                                                               &truncated_delta))
+                << size;
+        }
+        ProjectDescriptionDeltaDeinit(&created_delta);
+        free(created_binary);
+    }
+}
+
+TEST(testProjectDescriptionDelta, DumpToBinary_UpsertWithoutHash) {
+    ProjectDescriptionDeltaRAII given_delta(PROJECT_DESCRIPTION_DELTA_UPSERT_ENTRIES, 1);
+    DynamicStringArrayAppend(&given_delta.delta.files, "/project/liba.so");
+
+    uint8_t* created_binary;
+    size_t created_binary_size;
+    EXPECT_FALSE(ProjectDescriptionDeltaDumpToBinary(&given_delta.delta, &created_binary, &created_binary_size));
+}
@@ -0,0 +1,208 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+extern "C" {
+#include "../DynamicStringArray.h"
+#include "../ProjectDescription.h"
+#include "../ProjectFileWatcher.h"
+}
+
+namespace {
+struct TemporaryDirectory {
+    TemporaryDirectory() {
+        char name_template[] = "/tmp/testProjectFileWatcherXXXXXX";
+        name = mkdtemp(name_template);
+    }
+    ~TemporaryDirectory() {
+        remove((name + "/app").c_str());
+        remove((name + "/lib.so").c_str());
+        remove((name + "/unrelated").c_str());
+        remove((name + "/lib.so.1").c_str());
+        rmdir(name.c_str());
+    }
+
+    std::string name;
+};
+
+struct ReadEvents {
+    ReadEvents(ProjectFileWatcher* watcher) {
+        DynamicStringArrayInit(&finished_files);
+        DynamicStringArrayInit(&active_files);
+        DynamicStringArrayInit(&removed_files);
+        complete = ProjectFileWatcherReadEvents(watcher, &finished_files, &active_files, &removed_files);
+    }
+    ~ReadEvents() {
+        DynamicStringArrayDeinit(&finished_files);
+        DynamicStringArrayDeinit(&active_files);
+        DynamicStringArrayDeinit(&removed_files);
+    }
+
+    DynamicStringArray finished_files, active_files, removed_files;
+    int complete;
+};
+} // namespace
+
+TEST(testProjectFileWatcher, ReportsOnlyProjectFiles) {
+    TemporaryDirectory given_directory;
+    const std::string given_executable = given_directory.name + "/app";
+    const std::string given_dependency = given_directory.name + "/lib.so";
+
+    ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, given_executable.c_str(), "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, given_dependency.c_str());
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "efgh");
+
+    ProjectFileWatcher created_watcher;
+    ProjectFileWatcherInit(&created_watcher);
+    ASSERT_LE(0, created_watcher.fd);
+    ProjectFileWatcherWatch(&created_watcher, &given_description);
+    EXPECT_TRUE(ProjectFileWatcherIsComplete(&created_watcher));
+
+    std::ofstream(given_dependency) << "first";
+    std::ofstream(given_dependency) << "second";
+    std::ofstream(given_directory.name + "/unrelated") << "data";
+    {
+        ReadEvents created_events(&created_watcher);
+        EXPECT_TRUE(created_events.complete);
+        ASSERT_EQ(1u, created_events.finished_files.size);
+        EXPECT_EQ(given_dependency, created_events.finished_files.data[0]);
+        EXPECT_EQ(0u, created_events.active_files.size);
+        EXPECT_EQ(0u, created_events.removed_files.size);
+    }
+
+    remove(given_dependency.c_str());
+    {
+        ReadEvents created_events(&created_watcher);
+        EXPECT_EQ(0u, created_events.finished_files.size);
+        ASSERT_EQ(1u, created_events.removed_files.size);
+        EXPECT_EQ(given_dependency, created_events.removed_files.data[0]);
+    }
+
+    ProjectFileWatcherDeinit(&created_watcher);
+    ProjectDescriptionDeinit(&given_description);
+}
+
+TEST(testProjectFileWatcher, WriteInProgressIsActive) {
+    TemporaryDirectory given_directory;
+    const std::string given_executable = given_directory.name + "/app";
+
+    ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, given_executable.c_str(), "abcd");
+    // Exists already, creating it would start its quiet window
+    std::ofstream(given_executable) << "old";
+
+    ProjectFileWatcher created_watcher;
+    ProjectFileWatcherInit(&created_watcher);
+    ProjectFileWatcherWatch(&created_watcher, &given_description);
+
+    std::ofstream given_writer(given_executable);
+    given_writer << "partial" << std::flush;
+    {
+        ReadEvents created_events(&created_watcher);
+        EXPECT_EQ(0u, created_events.finished_files.size);
+        ASSERT_EQ(1u, created_events.active_files.size);
+        EXPECT_EQ(given_executable, created_events.active_files.data[0]);
+    }
+
+    given_writer.close();
+    {
+        ReadEvents created_events(&created_watcher);
+        ASSERT_EQ(1u, created_events.finished_files.size);
+        EXPECT_EQ(0u, created_events.active_files.size);
+    }
+
+    ProjectFileWatcherDeinit(&created_watcher);
+    ProjectDescriptionDeinit(&given_description);
+}
+
+TEST(testProjectFileWatcher, MissingDirectoryIsIncomplete) {
+    ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, "/tmp/testProjectFileWatcherDoesNotExist/app", "abcd");
+
+    ProjectFileWatcher created_watcher;
+    ProjectFileWatcherInit(&created_watcher);
+    ProjectFileWatcherWatch(&created_watcher, &given_description);
+    EXPECT_FALSE(ProjectFileWatcherIsComplete(&created_watcher));
+
+    ProjectFileWatcherDeinit(&created_watcher);
+    ProjectDescriptionDeinit(&given_description);
+}
+
+TEST(testProjectFileWatcher, WatchingAgainKeepsSharedDirectory) {
+    TemporaryDirectory given_directory;
+    const std::string given_executable = given_directory.name + "/app";
+    const std::string given_dependency = given_directory.name + "/lib.so";
+
+    ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, given_executable.c_str(), "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, given_dependency.c_str());
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "efgh");
+    ProjectDescription given_smaller_description;
+    ProjectDescriptionInit(&given_smaller_description, given_dependency.c_str(), "efgh");
+    DynamicStringArrayAppend(&given_smaller_description.link_dependencies_for_executable,
+                             "/tmp/testProjectFileWatcherDoesNotExist/lib.so");
+    DynamicStringArrayAppend(&given_smaller_description.link_dependencies_for_executable_hashes, "ijkl");
+
+    ProjectFileWatcher created_watcher;
+    ProjectFileWatcherInit(&created_watcher);
+    ProjectFileWatcherWatch(&created_watcher, &given_description);
+    ProjectFileWatcherWatch(&created_watcher, &given_smaller_description);
+    EXPECT_FALSE(ProjectFileWatcherIsComplete(&created_watcher));
+
+    // The directory is still watched, only for the file that is left
+    std::ofstream(given_executable) << "data";
+    std::ofstream(given_dependency) << "data";
+    {
+        ReadEvents created_events(&created_watcher);
+        EXPECT_TRUE(created_events.complete);
+        ASSERT_EQ(1u, created_events.finished_files.size);
+        EXPECT_EQ(given_dependency, created_events.finished_files.data[0]);
+    }
+
+    ProjectFileWatcherWatch(&created_watcher, &given_description);
+    EXPECT_TRUE(ProjectFileWatcherIsComplete(&created_watcher));
+    std::ofstream(given_executable) << "more data";
+    {
+        ReadEvents created_events(&created_watcher);
+        ASSERT_EQ(1u, created_events.finished_files.size);
+        EXPECT_EQ(given_executable, created_events.finished_files.data[0]);
+    }
+
+    ProjectFileWatcherDeinit(&created_watcher);
+    ProjectDescriptionDeinit(&given_smaller_description);
+    ProjectDescriptionDeinit(&given_description);
+}
+
+TEST(testProjectFileWatcher, CreatedLinkIsFinished) {
+    TemporaryDirectory given_directory;
+    const std::string given_executable = given_directory.name + "/app";
+    const std::string given_dependency = given_directory.name + "/lib.so";
+    const std::string given_target = given_directory.name + "/lib.so.1";
+    std::ofstream(given_target) << "library";
+
+    ProjectDescription given_description;
+    ProjectDescriptionInit(&given_description, given_executable.c_str(), "abcd");
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable, given_dependency.c_str());
+    DynamicStringArrayAppend(&given_description.link_dependencies_for_executable_hashes, "efgh");
+
+    ProjectFileWatcher created_watcher;
+    ProjectFileWatcherInit(&created_watcher);
+    ProjectFileWatcherWatch(&created_watcher, &given_description);
+
+    // Only IN_CREATE is emitted for a link
+    ASSERT_EQ(0, symlink(given_target.c_str(), given_dependency.c_str()));
+    ASSERT_EQ(0, link(given_target.c_str(), given_executable.c_str()));
+    {
+        ReadEvents created_events(&created_watcher);
+        EXPECT_EQ(2u, created_events.finished_files.size);
+        EXPECT_EQ(0u, created_events.active_files.size);
+    }
+
+    ProjectFileWatcherDeinit(&created_watcher);
+    ProjectDescriptionDeinit(&given_description);
+}
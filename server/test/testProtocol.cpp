@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <vector>
+
 extern "C" {
 #include "../../protocol/Protocol.h"
 #include "../ProjectDescription.h"
@@ -31,7 +33,9 @@ TEST(testProtocol, MakeAndDecodeProjectDescriptionPacket) {
 
     EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION, packet[0]);
     EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION, packet[1]);
-    EXPECT_EQ(std::string(given_description_json) + '\0', std::string((char*)&packet[2], given_json_size));
+    EXPECT_EQ(given_json_size, packet[4] | packet[5] << 8 | packet[6] << 16 | packet[7] << 24);
+    EXPECT_EQ(std::string(given_description_json) + '\0',
+              std::string((char*)&packet[PACKET_HEADER_SIZE], given_json_size));
 
     free(given_description_json);
 
@@ -67,7 +71,7 @@ TEST(testProtocol, MakeAndDecodeSubscriptionResponsePacket) {
     size_t created_header_offset;
     EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_REQUEST,
               DecodePacket(created_packet, created_packet_size, &created_header_offset));
-    EXPECT_EQ(2u, created_header_offset);
+    EXPECT_EQ(PACKET_HEADER_SIZE, created_header_offset);
 
     free(created_packet);
 }
@@ -86,4 +90,142 @@ TEST(testProtocol, FindNullTerminator) {
     given_packet[0] = '\0';
     ASSERT_TRUE(FindNullTerminator(given_packet, 128, &position));
     EXPECT_EQ(0, position);
-}
\ No newline at end of file
+}
+
+TEST(testProtocol, DecodeFrameOnlyWhenComplete) {
+    uint8_t* given_packet;
+    size_t given_packet_size;
+    MakeProjectDescriptionPacket("{}", &given_packet, &given_packet_size);
+    ASSERT_EQ(PACKET_HEADER_SIZE + 3, given_packet_size);
+
+    PacketFrame created_frame;
+    for (size_t size = 0; size < given_packet_size; ++size)
+        EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE,
+                  DecodePacketFrame(given_packet, size, &created_frame))
+            << size;
+
+    // Whatever comes after the packet is not part of it, not even when it starts with a '\0'
+    std::vector<uint8_t> given_stream(given_packet, given_packet + given_packet_size);
+    given_stream.push_back('\0');
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION,
+              DecodePacketFrame(given_stream.data(), given_stream.size(), &created_frame));
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION, created_frame.version);
+    EXPECT_EQ(PACKET_HEADER_SIZE, created_frame.payload_offset);
+    EXPECT_EQ(3u, created_frame.payload_size);
+    EXPECT_EQ(given_packet_size, created_frame.packet_size);
+    free(given_packet);
+}
+
+TEST(testProtocol, DecodeVersion1Frames) {
+    const uint8_t given_stream[] = {DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1,
+                                    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_REQUEST,
+                                    DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1,
+                                    DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION,
+                                    '{',
+                                    '}',
+                                    '\0'};
+
+    PacketFrame created_frame;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_REQUEST,
+              DecodePacketFrame(given_stream, sizeof(given_stream), &created_frame));
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1, created_frame.version);
+    EXPECT_EQ(PACKET_HEADER_SIZE_V1, created_frame.packet_size);
+
+    const uint8_t* given_description = given_stream + PACKET_HEADER_SIZE_V1;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE,
+              DecodePacketFrame(given_description, 4, &created_frame));
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION,
+              DecodePacketFrame(given_description, 5, &created_frame));
+    EXPECT_EQ(PACKET_HEADER_SIZE_V1, created_frame.payload_offset);
+    EXPECT_EQ(3u, created_frame.payload_size);
+    EXPECT_EQ(5u, created_frame.packet_size);
+}
+
+TEST(testProtocol, DecodeNonsense) {
+    uint8_t given_packet[PACKET_HEADER_SIZE] = {0x7f, DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_REQUEST};
+    PacketFrame created_frame;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN,
+              DecodePacketFrame(given_packet, sizeof(given_packet), &created_frame));
+
+    given_packet[0] = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION;
+    given_packet[1] = DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN,
+              DecodePacketFrame(given_packet, sizeof(given_packet), &created_frame));
+
+    // A payload that large is not waited for
+    given_packet[1] = DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION;
+    given_packet[7] = 0xff;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN,
+              DecodePacketFrame(given_packet, sizeof(given_packet), &created_frame));
+}
+
+TEST(testProtocol, SubscriptionResponseHeaderOfEachVersion) {
+    uint8_t* created_header;
+    size_t created_header_size;
+    MakeSubscriptionResponsePacketHeader(DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION, 300, &created_header,
+                                         &created_header_size);
+    ASSERT_EQ(PACKET_HEADER_SIZE, created_header_size);
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE, created_header[1]);
+    EXPECT_EQ(300, created_header[4] | created_header[5] << 8);
+    free(created_header);
+
+    MakeSubscriptionResponsePacketHeader(DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1, 300, &created_header,
+                                         &created_header_size);
+    ASSERT_EQ(PACKET_HEADER_SIZE_V1, created_header_size);
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1, created_header[0]);
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_SUBSCRIBE_RESPONSE, created_header[1]);
+    free(created_header);
+}
+
+TEST(testProtocol, DeltaPacketsOnlyExistInVersion2) {
+    const uint8_t given_delta[] = {1, 2, 3};
+    uint8_t* created_packet;
+    size_t created_packet_size;
+    MakeProjectDescriptionDeltaPacket(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_REMOVE_PROJECT_ENTRIES, given_delta,
+                                      sizeof(given_delta), &created_packet, &created_packet_size);
+    ASSERT_EQ(PACKET_HEADER_SIZE + sizeof(given_delta), created_packet_size);
+
+    PacketFrame created_frame;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_REMOVE_PROJECT_ENTRIES,
+              DecodePacketFrame(created_packet, created_packet_size, &created_frame));
+    EXPECT_EQ(sizeof(given_delta), created_frame.payload_size);
+    EXPECT_EQ(0, memcmp(given_delta, created_packet + created_frame.payload_offset, sizeof(given_delta)));
+
+    created_packet[0] = DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_UNKNOWN,
+              DecodePacketFrame(created_packet, created_packet_size, &created_frame));
+    free(created_packet);
+
+    MakeProjectResyncRequestPacket(&created_packet, &created_packet_size);
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_RESYNC_REQUEST,
+              DecodePacketFrame(created_packet, created_packet_size, &created_frame));
+    EXPECT_EQ(PACKET_HEADER_SIZE, created_frame.packet_size);
+    free(created_packet);
+}
+
+TEST(testProtocol, DecodeHeaderBeforeThePayloadArrived) {
+    uint8_t* given_packet;
+    size_t given_packet_size;
+    MakeProjectDescriptionPacket("{}", &given_packet, &given_packet_size);
+
+    PacketFrame created_frame;
+    for (size_t size = 0; size < PACKET_HEADER_SIZE; ++size)
+        EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_INCOMPLETE,
+                  DecodePacketHeader(given_packet, size, &created_frame))
+            << size;
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION,
+              DecodePacketHeader(given_packet, PACKET_HEADER_SIZE, &created_frame));
+    EXPECT_EQ(3u, created_frame.payload_size);
+    EXPECT_EQ(given_packet_size, created_frame.packet_size);
+    free(given_packet);
+
+    const uint8_t given_version_1[] = {DEBUGGER_BOOTSTRAP_PROTOCOL_VERSION_1,
+                                       DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION, '{', '}', '\0'};
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION,
+              DecodePacketHeader(given_version_1, 4, &created_frame));
+    EXPECT_EQ(PACKET_HEADER_SIZE_V1, created_frame.payload_offset);
+    EXPECT_EQ(PACKET_PAYLOAD_SIZE_UNKNOWN, created_frame.payload_size);
+    EXPECT_EQ(DEBUGGER_BOOTSTRAP_PROTOCOL_PACKET_TYPE_PROJECT_DESCRIPTION,
+              DecodePacketHeader(given_version_1, sizeof(given_version_1), &created_frame));
+    EXPECT_EQ(3u, created_frame.payload_size);
+}